@@ -0,0 +1,214 @@
+// Copyright (c) 2011, Massimo Sartori and Monica Reggiani
+// All rights reserved.
+
+// Redistribution and use in source and binary forms, with or without 
+// modification, are permitted provided that the following conditions are met:
+// - Redistributions of source code must retain the above copyright notice, 
+//   this list of conditions and the following disclaimer.
+// - Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+
+
+
+/* Checks the C interface on a synthetic 3 DOF model: fit from row-major and
+ * column-major samples, evaluation on the nodes, strided batches, derivatives
+ * against finite differences, rebuilding a model from its coefficients and
+ * the rejection of invalid grids and of poses out of bounds or not a number. */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+
+#include "SplineC.h"
+
+#define DIM 3
+#define NO_MUSCLES 3
+#define NO_FRAMES 200
+
+static int noFailures = 0;
+
+static void check(const int condition, const char* what) {
+  if (!condition) {
+    printf("FAILED: %s\n", what);
+    ++noFailures;
+  }
+}
+
+static double muscle(const int k, const double* x) {
+  return (k+1) * sin(x[0]) * cos(0.5*x[1]) + 0.1*k*x[2]*x[2] + 0.2*x[0]*x[2];
+}
+
+int main() {
+  const double a[DIM] = { -1.0, 0.0, -0.5 };
+  const double b[DIM] = { 1.0, 2.0, 1.5 };
+  const int n[DIM] = { 8, 6, 7 };
+  double h[DIM];
+  int noNodes = 1, i, j, k, f, node, noCoefficients;
+  double *yRowMajor, *yColumnMajor, *xRowMajor, *xColumnMajor;
+  double *values, *valuesColumnMajor, *derivatives, *c, *otherC;
+  double x[DIM], xPlus[DIM], xMinus[DIM], maxError;
+  SplineSetHandle splines, splinesColumnMajor, rebuilt;
+
+  for (i = 0; i < DIM; ++i) {
+    h[i] = (b[i] - a[i]) / n[i];
+    noNodes *= n[i] + 1;
+  }
+
+  /* samples on the nodes, first DOF running fastest */
+  yRowMajor = (double*) malloc(noNodes * NO_MUSCLES * sizeof(double));
+  yColumnMajor = (double*) malloc(noNodes * NO_MUSCLES * sizeof(double));
+  for (node = 0; node < noNodes; ++node) {
+    int rest = node;
+    for (i = 0; i < DIM; ++i) {
+      x[i] = a[i] + (rest % (n[i]+1)) * h[i];
+      rest /= n[i]+1;
+    }
+    for (k = 0; k < NO_MUSCLES; ++k) {
+      yRowMajor[node*NO_MUSCLES + k] = muscle(k, x);
+      yColumnMajor[node + k*noNodes] = muscle(k, x);
+    }
+  }
+
+  splines = splineSetFit(DIM, a, b, n, NO_MUSCLES, yRowMajor, NO_MUSCLES, 1);
+  splinesColumnMajor = splineSetFit(DIM, a, b, n, NO_MUSCLES, yColumnMajor, 1, noNodes);
+  check(splines != NULL && splinesColumnMajor != NULL, "fit");
+  check(splineSetFit(1, a, b, n, NO_MUSCLES, yRowMajor, NO_MUSCLES, 1) == NULL, "unsupported dimension rejected");
+  {
+    const int oneInterval[DIM] = { 1, 6, 7 };
+    check(splineSetFit(DIM, a, b, oneInterval, NO_MUSCLES, yRowMajor, NO_MUSCLES, 1) == NULL, "single interval rejected");
+    check(splineSetFit(DIM, b, a, n, NO_MUSCLES, yRowMajor, NO_MUSCLES, 1) == NULL, "empty range rejected");
+  }
+  {
+    /* 65536^2 * 5 coefficients wrap to 0 in an int; neither y nor c is read */
+    const int huge[DIM] = { 65533, 65533, 2 };
+    check(splineSetFit(DIM, a, b, huge, NO_MUSCLES, yRowMajor, NO_MUSCLES, 1) == NULL, "too many coefficients rejected");
+    check(splineSetCreate(DIM, a, b, huge, NO_MUSCLES, yRowMajor, NO_MUSCLES, 1) == NULL,
+          "too many coefficients rejected by create");
+  }
+  check(splineSetGetDimension(splines) == DIM, "dimension");
+  check(splineSetGetNumberOfMuscles(splines) == NO_MUSCLES, "number of muscles");
+  noCoefficients = splineSetGetNumberOfCoefficients(splines);
+  check(noCoefficients == (n[0]+3)*(n[1]+3)*(n[2]+3), "number of coefficients");
+
+  /* both storage orders give the same model */
+  c = (double*) malloc(noCoefficients * NO_MUSCLES * sizeof(double));
+  otherC = (double*) malloc(noCoefficients * sizeof(double));
+  maxError = 0;
+  for (k = 0; k < NO_MUSCLES; ++k) {
+    splineSetGetCoefficients(splines, k, c + k, NO_MUSCLES);
+    splineSetGetCoefficients(splinesColumnMajor, k, otherC, 1);
+    for (j = 0; j < noCoefficients; ++j)
+      maxError = fmax(maxError, fabs(c[j*NO_MUSCLES + k] - otherC[j]));
+  }
+  check(maxError == 0, "row-major and column-major fit");
+
+  /* the spline interpolates the samples: nodes as a batch, values written column-major */
+  xRowMajor = (double*) malloc(noNodes * DIM * sizeof(double));
+  values = (double*) malloc(noNodes * NO_MUSCLES * sizeof(double));
+  for (node = 0; node < noNodes; ++node) {
+    int rest = node;
+    for (i = 0; i < DIM; ++i) {
+      xRowMajor[node*DIM + i] = a[i] + (rest % (n[i]+1)) * h[i];
+      rest /= n[i]+1;
+    }
+  }
+  check(splineSetEvaluate(splines, noNodes, xRowMajor, DIM, 1, values, 1, noNodes) == SPLINE_C_OK, "evaluate nodes");
+  maxError = 0;
+  for (node = 0; node < noNodes; ++node)
+    for (k = 0; k < NO_MUSCLES; ++k)
+      maxError = fmax(maxError, fabs(values[node + k*noNodes] - yColumnMajor[node + k*noNodes]));
+  check(maxError < 1e-10, "interpolation on the nodes");
+  free(xRowMajor);
+  free(values);
+
+  /* random frames, stored row-major and column-major */
+  srand(1);
+  xRowMajor = (double*) malloc(NO_FRAMES * DIM * sizeof(double));
+  xColumnMajor = (double*) malloc(NO_FRAMES * DIM * sizeof(double));
+  for (f = 0; f < NO_FRAMES; ++f)
+    for (i = 0; i < DIM; ++i) {
+      double value = a[i] + (b[i] - a[i]) * rand() / RAND_MAX;
+      xRowMajor[f*DIM + i] = value;
+      xColumnMajor[f + i*NO_FRAMES] = value;
+    }
+  values = (double*) malloc(NO_FRAMES * NO_MUSCLES * sizeof(double));
+  valuesColumnMajor = (double*) malloc(NO_FRAMES * NO_MUSCLES * sizeof(double));
+  check(splineSetEvaluate(splines, NO_FRAMES, xRowMajor, DIM, 1, values, NO_MUSCLES, 1) == SPLINE_C_OK, "evaluate row-major");
+  check(splineSetEvaluate(splines, NO_FRAMES, xColumnMajor, 1, NO_FRAMES, valuesColumnMajor, 1, NO_FRAMES) == SPLINE_C_OK, "evaluate column-major");
+  maxError = 0;
+  for (f = 0; f < NO_FRAMES; ++f)
+    for (k = 0; k < NO_MUSCLES; ++k) {
+      for (i = 0; i < DIM; ++i)
+        x[i] = xRowMajor[f*DIM + i];
+      maxError = fmax(maxError, fabs(values[f*NO_MUSCLES + k] - valuesColumnMajor[f + k*NO_FRAMES]));
+      check(fabs(values[f*NO_MUSCLES + k] - muscle(k, x)) < 1e-2, "approximation between the nodes");
+    }
+  check(maxError == 0, "row-major and column-major evaluation");
+
+  /* derivatives against central differences */
+  derivatives = (double*) malloc(NO_FRAMES * NO_MUSCLES * DIM * sizeof(double));
+  check(splineSetEvaluateFirstDerivatives(splines, NO_FRAMES, xRowMajor, DIM, 1,
+                                          derivatives, NO_MUSCLES*DIM, DIM, 1) == SPLINE_C_OK, "evaluate derivatives");
+  maxError = 0;
+  for (f = 0; f < 20; ++f)
+    for (i = 0; i < DIM; ++i) {
+      const double delta = 1e-6;
+      double plus[NO_MUSCLES], minus[NO_MUSCLES];
+      for (j = 0; j < DIM; ++j)
+        xPlus[j] = xMinus[j] = xRowMajor[f*DIM + j];
+      if (xPlus[i] + delta > b[i] || xMinus[i] - delta < a[i])
+        continue;
+      xPlus[i] += delta;
+      xMinus[i] -= delta;
+      splineSetEvaluate(splines, 1, xPlus, 0, 1, plus, 0, 1);
+      splineSetEvaluate(splines, 1, xMinus, 0, 1, minus, 0, 1);
+      for (k = 0; k < NO_MUSCLES; ++k)
+        maxError = fmax(maxError, fabs(derivatives[f*NO_MUSCLES*DIM + k*DIM + i] - (plus[k] - minus[k]) / (2*delta)));
+    }
+  check(maxError < 1e-6, "derivatives");
+
+  /* a model rebuilt from its coefficients */
+  rebuilt = splineSetCreate(DIM, a, b, n, NO_MUSCLES, c, NO_MUSCLES, 1);
+  check(rebuilt != NULL, "create from coefficients");
+  check(splineSetEvaluate(rebuilt, NO_FRAMES, xColumnMajor, 1, NO_FRAMES, valuesColumnMajor, 1, NO_FRAMES) == SPLINE_C_OK, "evaluate rebuilt");
+  maxError = 0;
+  for (f = 0; f < NO_FRAMES; ++f)
+    for (k = 0; k < NO_MUSCLES; ++k)
+      maxError = fmax(maxError, fabs(values[f*NO_MUSCLES + k] - valuesColumnMajor[f + k*NO_FRAMES]));
+  check(maxError == 0, "rebuilt model");
+
+  /* errors are reported, not fatal */
+  x[0] = b[0] + 1; x[1] = a[1]; x[2] = a[2];
+  check(splineSetEvaluate(splines, 1, x, 0, 1, values, 0, 1) == SPLINE_C_OUT_OF_BOUNDS, "out of bounds");
+  check(splineSetEvaluate(NULL, 1, x, 0, 1, values, 0, 1) == SPLINE_C_INVALID_ARGUMENT, "null handle");
+  x[0] = NAN;
+  check(splineSetEvaluate(splines, 1, x, 0, 1, values, 0, 1) == SPLINE_C_OUT_OF_BOUNDS, "not a number");
+  check(splineSetEvaluateFirstDerivatives(splines, 1, x, 0, 1, derivatives, 0, DIM, 1) == SPLINE_C_OUT_OF_BOUNDS,
+        "not a number in derivatives");
+
+  splineSetDestroy(splines);
+  splineSetDestroy(splinesColumnMajor);
+  splineSetDestroy(rebuilt);
+  free(yRowMajor); free(yColumnMajor); free(xRowMajor); free(xColumnMajor);
+  free(values); free(valuesColumnMajor); free(derivatives); free(c); free(otherC);
+
+  if (noFailures > 0) {
+    printf("%d checks failed\n", noFailures);
+    return EXIT_FAILURE;
+  }
+  printf("All checks passed\n");
+  return EXIT_SUCCESS;
+}
@@ -37,6 +37,7 @@ using std::ofstream;
 
 #include "SplineData.h"
 #include "Spline.cpp"
+#include "SplineStreamingFitter.cpp"
 
 //#define LOG
 
@@ -72,28 +73,10 @@ SplineData::SplineData(const string& inputDataFilename)
   readInputData();  
   inputDataFile_.close();
 
-#ifdef LOG
-  cout << "Read the following interpolation data:\n";
-  displayInputData(); 
-#endif
-
-  // create the noMuscles_ splines
-  for (int i = 0; i < noMuscles_; ++i) {
-     Spline<N_DOF> newSpline(a_,b_,n_);
-     splines_.push_back(newSpline);
-  
-  }
-
 #ifdef LOG
   cout << "Created " << splines_.size() << " splines.\n";
 #endif     
 
-  // now compute coefficients for each muscle
-  for (int i = 0; i < noMuscles_; ++i) {
-    vector<double> currentMuscle(y_[i]);
-    splines_[i].computeCoefficients(currentMuscle, currentMuscle.begin());
-  }
-
 }
 
 
@@ -120,20 +103,32 @@ void SplineData::readInputData() {
 
   noMuscles_ = muscleNames_.size();
   
-  // 2. then their values for all the possible combination of DOFs values
-  // 2a. create the matrix to store them
+#ifdef LOG
+  cout << "Read the following interpolation data:\n";
+  displayInputData(); 
+#endif
+  
+  // 2. then their values for all the possible combination of DOFs values,
+  // row by row: the streaming fitter fits each slab of rows while the next
+  // ones are read, and keeps only the resulting splines
   noInputData_ = 1;
   for (int i = 0; i < N_DOF; ++i) 
     noInputData_ *= ( n_[i]+1 );
-  for (int i = 0; i < noMuscles_; ++i)
-    y_.push_back(vector<double>(noInputData_));
-    
-  // 2b. read the data 
-  for (int j=0; j < noInputData_; ++j) 
-    for (int i=0; i < noMuscles_; ++i) {
-      inputDataFile_ >> y_[i][j];
-    }   
-    
+  SplineStreamingFitter<N_DOF> fitter(a_, b_, n_, noMuscles_);
+  vector<double> values(noMuscles_);
+  for (int j=0; j < noInputData_; ++j) {
+    for (int i=0; i < noMuscles_; ++i)
+      inputDataFile_ >> values[i];
+    if (!inputDataFile_) {
+      cout << "ERROR: the input data end at node " << j << " of " << noInputData_ << endl;
+      exit(EXIT_FAILURE);
+    }
+    fitter.addNode(values);
+#ifdef LOG
+    displayNode(j, values);
+#endif
+  }
+  fitter.getSplines(splines_);
 }
 
 
@@ -158,25 +153,21 @@ void SplineData::displayInputData() {
      cout << muscleNames_[i] << "\t";
   }
   cout << endl;
- 
-    
+}
+
+
+void SplineData::displayNode(int soFar, const vector<double>& values) {
   vector<int> index(N_DOF);
-  double tot, mul;
-  for (int soFar = 0; soFar < noInputData_; ++soFar) {
-    tot = 0; mul = noInputData_;
-    for (int i = N_DOF-1; i >0; --i) {
-      mul = mul / ( n_[i] + 1 );
-      index[i] = ( soFar - tot )/ mul;
-      tot += index[i] * mul;
-    } 
-    index[0] = soFar % ( n_[0] + 1 );
-    for (int i = N_DOF-1; i >= 0; --i) {
-       cout << a_[i] + index[i] * (b_[i]-a_[i])/n_[i] << "\t";
-    }
-    for (int j = 0; j < noMuscles_; ++j) 
-           cout << y_[j][soFar] << "\t";
-    cout << endl;
+  for (int i = 0; i < N_DOF; ++i) {
+    index[i] = soFar % ( n_[i] + 1 );
+    soFar /= n_[i] + 1;
+  }
+  for (int i = N_DOF-1; i >= 0; --i) {
+     cout << a_[i] + index[i] * (b_[i]-a_[i])/n_[i] << "\t";
   }
+  for (int j = 0; j < noMuscles_; ++j) 
+         cout << values[j] << "\t";
+  cout << endl;
 }
 
 
@@ -25,6 +25,7 @@
 #define SplineData_h
 
 #include "Spline.h"
+#include "SplineStreamingFitter.h"
 
 #include <vector>
 using std::vector;
@@ -48,6 +49,7 @@ public:
 private:
   void readInputData();
   void displayInputData();
+  void displayNode(int soFar, const vector<double>& values);
   void openEvalFile(ifstream& evalDataFile);
   void openOutputFile(ofstream& outputDataFile); 
   ifstream inputDataFile_;
@@ -60,7 +62,6 @@ private:
   vector<string> muscleNames_; 
   int noMuscles_;
   int noInputData_; 
-  vector< vector< double> > y_;
     
   // Splines
   vector< Spline<N_DOF> > splines_;
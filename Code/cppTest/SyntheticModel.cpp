@@ -0,0 +1,105 @@
+// Copyright (c) 2011, Massimo Sartori and Monica Reggiani
+// All rights reserved.
+
+// Redistribution and use in source and binary forms, with or without 
+// modification, are permitted provided that the following conditions are met:
+// - Redistributions of source code must retain the above copyright notice, 
+//   this list of conditions and the following disclaimer.
+// - Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+
+
+
+#define _USE_MATH_DEFINES
+#include <math.h>
+#include <sstream>
+#include <random>
+
+#include "SyntheticModel.h"
+
+SyntheticModel::SyntheticModel(const int noDofs, const int noMuscles, const unsigned int seed)
+:noDofs_(noDofs), noMuscles_(noMuscles), lowerBound_(noDofs), upperBound_(noDofs), restLength_(noMuscles),
+ amplitude_(noMuscles*noDofs), frequency_(noMuscles*noDofs), phase_(noMuscles*noDofs),
+ couplingAmplitude_(noMuscles), coupling_(noMuscles*noDofs) {
+  std::mt19937 generator(seed);
+  std::uniform_real_distribution<double> uniform(0., 1.);
+  
+  for (int i = 0; i < noDofs_; ++i) {
+    std::stringstream name;
+    name << "Dof" << i;
+    dofNames_.push_back(name.str());
+    // joint ranges between 60 and 150 degrees
+    lowerBound_[i] = -10. - 50. * uniform(generator);
+    upperBound_[i] = lowerBound_[i] + 60. + 90. * uniform(generator);
+  }
+  
+  // lengths about 0.2-0.5 m, moment arms of a few cm, as in the real data
+  for (int m = 0; m < noMuscles_; ++m) {
+    std::stringstream name;
+    name << "muscle" << m;
+    muscleNames_.push_back(name.str());
+    restLength_[m] = 0.2 + 0.3 * uniform(generator);
+    couplingAmplitude_[m] = 0.01 * uniform(generator);
+    for (int i = 0; i < noDofs_; ++i) {
+      int k = m * noDofs_ + i;
+      amplitude_[k] = 0.01 + 0.04 * uniform(generator);
+      frequency_[k] = 0.5 + 1.5 * uniform(generator);
+      phase_[k] = 2. * M_PI * uniform(generator);
+      coupling_[k] = 0.5 * uniform(generator);
+    }
+  }
+}
+
+
+double SyntheticModel::getLmt(const int muscle, const std::vector<double>& q) const {
+  const int first = muscle * noDofs_;
+  double lmt = restLength_[muscle];
+  double coupledAngle = 0.;
+  for (int i = 0; i < noDofs_; ++i) {
+    lmt += amplitude_[first+i] * sin(frequency_[first+i] * q[i] + phase_[first+i]);
+    coupledAngle += coupling_[first+i] * q[i];
+  }
+  return lmt + couplingAmplitude_[muscle] * sin(coupledAngle);
+}
+
+
+double SyntheticModel::getMomentArm(const int muscle, const int dof, const std::vector<double>& q) const {
+  const int first = muscle * noDofs_;
+  double coupledAngle = 0.;
+  for (int i = 0; i < noDofs_; ++i)
+    coupledAngle += coupling_[first+i] * q[i];
+  const int k = first + dof;
+  return -( amplitude_[k] * frequency_[k] * cos(frequency_[k] * q[dof] + phase_[k])
+          + couplingAmplitude_[muscle] * coupling_[k] * cos(coupledAngle) );
+}
+
+
+void SyntheticModel::getNodeValues(const int muscle, const std::vector<double>& a, const std::vector<double>& b,
+                                   const std::vector<int>& n, std::vector<double>& y) const {
+  long noNodes = 1;
+  for (int i = 0; i < noDofs_; ++i)
+    noNodes *= n[i] + 1;
+  y.resize(noNodes);
+  std::vector<double> q(noDofs_);
+  for (long k = 0; k < noNodes; ++k) {
+    long rest = k;
+    for (int i = 0; i < noDofs_; ++i) {
+      q[i] = a[i] + (rest % (n[i]+1)) * (b[i] - a[i]) / n[i];
+      rest /= n[i] + 1;
+    }
+    y[k] = getLmt(muscle, q);
+  }
+}
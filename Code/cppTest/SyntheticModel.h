@@ -0,0 +1,73 @@
+// Copyright (c) 2011, Massimo Sartori and Monica Reggiani
+// All rights reserved.
+
+// Redistribution and use in source and binary forms, with or without 
+// modification, are permitted provided that the following conditions are met:
+// - Redistributions of source code must retain the above copyright notice, 
+//   this list of conditions and the following disclaimer.
+// - Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+
+
+
+#ifndef SyntheticModel_h
+#define SyntheticModel_h
+
+#include <vector>
+#include <string>
+
+// Analytic muscle-tendon lengths to test the splines on models of any size.
+// The length of each muscle is a smooth function of the angles (radians)
+//   lmt(q) = l0 + sum_i A_i sin(w_i q_i + p_i) + B sin(sum_i k_i q_i)
+// where the last term couples the DOFs, as for a biarticular muscle.
+// The moment arms are ma_i = -dlmt/dq_i, as in the data directories.
+// All the parameters are drawn from the seed, so a model is reproducible.
+class SyntheticModel {
+  public:
+    SyntheticModel(const int noDofs, const int noMuscles, const unsigned int seed = 1);
+    int getNumberOfDofs() const { return noDofs_; }
+    int getNumberOfMuscles() const { return noMuscles_; }
+    const std::string& getDofName(const int dof) const { return dofNames_[dof]; }
+    const std::string& getMuscleName(const int muscle) const { return muscleNames_[muscle]; }
+    // range of each DOF, in degrees
+    double getLowerBound(const int dof) const { return lowerBound_[dof]; }
+    double getUpperBound(const int dof) const { return upperBound_[dof]; }
+    double getLmt(const int muscle, const std::vector<double>& q) const;
+    double getMomentArm(const int muscle, const int dof, const std::vector<double>& q) const;
+    // lmt of the muscle on the nodes of the grid of n[i] intervals on
+    // [a[i], b[i]] (radians), the first DOF running fastest, as the
+    // constructors of Spline and SplineSet take them
+    void getNodeValues(const int muscle, const std::vector<double>& a, const std::vector<double>& b,
+                       const std::vector<int>& n, std::vector<double>& y) const;
+    
+  private:
+    int noDofs_;
+    int noMuscles_;
+    std::vector<std::string> dofNames_;
+    std::vector<std::string> muscleNames_;
+    std::vector<double> lowerBound_;
+    std::vector<double> upperBound_;
+    std::vector<double> restLength_;
+    // amplitude_[muscle * noDofs_ + dof], and so on
+    std::vector<double> amplitude_;
+    std::vector<double> frequency_;
+    std::vector<double> phase_;
+    std::vector<double> couplingAmplitude_;
+    std::vector<double> coupling_;
+};
+
+
+#endif
@@ -0,0 +1,142 @@
+// Copyright (c) 2011, Massimo Sartori and Monica Reggiani
+// All rights reserved.
+
+// Redistribution and use in source and binary forms, with or without 
+// modification, are permitted provided that the following conditions are met:
+// - Redistributions of source code must retain the above copyright notice, 
+//   this list of conditions and the following disclaimer.
+// - Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+
+
+
+#include <iostream>
+using std::cout;
+using std::endl;
+#include <iomanip>
+#include <vector>
+using std::vector;
+#include <string>
+using std::string;
+#include <algorithm>
+#include <random>
+#include <chrono>
+#include <stdlib.h>
+#include <math.h>
+
+#include "SplineBatchEvaluator.h"
+#include "Spline.cpp"
+#include "SplineSet.cpp"
+#include "SplineBatchEvaluator.cpp"
+#include "SyntheticModel.h"
+
+// Time per pose of SplineBatchEvaluator without binning, with bins of one
+// cell and with bins of 4x4x4x4 cells (a tile), on three batches:
+// a NodesData-like grid of poses in its order, the same grid shuffled, as
+// in multi-trial batches, and random poses. The binned values must be the
+// same as the unbinned ones, pose by pose.
+
+const int DIM = 4;
+
+
+double measure(SplineBatchEvaluator<DIM>& evaluator, const vector<double>& x, const int noRepetitions,
+               vector<double>& values) {
+  evaluator.evaluate(x, values);
+  std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+  for (int r = 0; r < noRepetitions; ++r)
+    evaluator.evaluate(x, values);
+  std::chrono::duration<double> seconds = std::chrono::steady_clock::now() - start;
+  return seconds.count() / noRepetitions / (x.size() / DIM) * 1e9;
+}
+
+
+void shuffle(vector<double>& x) {
+  const int noPoses = x.size() / DIM;
+  std::mt19937 generator(1);
+  for (int p = noPoses-1; p > 0; --p) {
+    int q = std::uniform_int_distribution<int>(0, p)(generator);
+    for (int i = 0; i < DIM; ++i)
+      std::swap(x[p*DIM + i], x[q*DIM + i]);
+  }
+}
+
+
+int main(int argc, const char* argv[]) {
+  int n = (argc > 1) ? atoi(argv[1]) : 40;
+  int noSamples = (argc > 2) ? atoi(argv[2]) : 20;
+  int noMuscles = (argc > 3) ? atoi(argv[3]) : 4;
+  int noThreads = (argc > 4) ? atoi(argv[4]) : 1;
+  const int noRepetitions = 3;
+
+  vector<double> a(DIM, 0.), b(DIM, 1.);
+  vector<int> nodes(DIM, n);
+  SyntheticModel model(DIM, noMuscles);
+  vector<string> muscleNames;
+  vector< vector<double> > y(noMuscles);
+  for (int m = 0; m < noMuscles; ++m) {
+    muscleNames.push_back(model.getMuscleName(m));
+    model.getNodeValues(m, a, b, nodes, y[m]);
+  }
+  SplineSet<DIM> splineSet(a, b, nodes, muscleNames, y);
+  
+  // the poses of angles.in, the first DOF running fastest
+  int noPoses = 1;
+  for (int i = 0; i < DIM; ++i)
+    noPoses *= noSamples;
+  vector<double> grid(noPoses * DIM);
+  for (int p = 0; p < noPoses; ++p) {
+    int rest = p;
+    for (int i = 0; i < DIM; ++i) {
+      grid[p*DIM + i] = static_cast<double>(rest % noSamples) / (noSamples-1);
+      rest /= noSamples;
+    }
+  }
+  vector<double> shuffled(grid);
+  shuffle(shuffled);
+  vector<double> random(noPoses * DIM);
+  std::mt19937 generator(2);
+  for (unsigned int k = 0; k < random.size(); ++k)
+    random[k] = std::uniform_real_distribution<double>(0., 1.)(generator);
+  
+  cout << noMuscles << " splines with n = " << n << ": " 
+       << noMuscles * pow(n+3., DIM) * sizeof(double) / 1e6 << " MB of coefficients, " 
+       << noPoses << " poses per batch, " << noThreads << " threads\n";
+  cout << std::setw(12) << "batch" << std::setw(14) << "no bins" << std::setw(14) << "cell bins" 
+       << std::setw(14) << "tile bins" << "   (ns per pose)" << endl;
+  
+  const char* batchNames[] = { "grid", "shuffled", "random" };
+  const vector<double>* batches[] = { &grid, &shuffled, &random };
+  SplineBatchEvaluator<DIM> evaluator(splineSet, false, noThreads);
+  bool sameValues = true;
+  for (int k = 0; k < 3; ++k) {
+    cout << std::setw(12) << batchNames[k];
+    const int cellsPerBin[] = { 0, 1, 4 };
+    vector<double> unbinnedValues, values;
+    for (int c = 0; c < 3; ++c) {
+      evaluator.setBinning(cellsPerBin[c]);
+      cout << std::setw(14) << std::setprecision(4)
+           << measure(evaluator, *batches[k], noRepetitions, (c == 0) ? unbinnedValues : values);
+      // each pose is evaluated alone: the scatter-back must give the same bits
+      if (c > 0 && values != unbinnedValues) {
+        cout << endl << "ERROR: the values with " << cellsPerBin[c] << " cells per bin differ from the unbinned ones";
+        sameValues = false;
+      }
+    }
+    cout << endl;
+  }
+  
+  exit(sameValues ? EXIT_SUCCESS : EXIT_FAILURE);
+}
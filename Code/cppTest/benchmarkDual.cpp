@@ -0,0 +1,173 @@
+// Copyright (c) 2011, Massimo Sartori and Monica Reggiani
+// All rights reserved.
+
+// Redistribution and use in source and binary forms, with or without 
+// modification, are permitted provided that the following conditions are met:
+// - Redistributions of source code must retain the above copyright notice, 
+//   this list of conditions and the following disclaimer.
+// - Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+
+
+
+#include <iostream>
+using std::cout;
+using std::endl;
+#include <iomanip>
+#include <vector>
+using std::vector;
+#include <random>
+#include <chrono>
+#include <stdlib.h>
+#include <math.h>
+
+#include "Spline.h"
+#include "Spline.cpp"
+
+// Cost of the lmt of a muscle and of its gradient with respect to the
+// angles, as a direct-collocation solver needs it: central finite
+// differences, SplineDual propagated through the basis, and SplineDual with
+// the analytic derivatives of the basis; the plain value is the reference.
+
+const int DIM = 4;
+typedef SplineDual<DIM> Dual;
+
+
+template <typename Evaluation>
+double measure(const vector< vector<double> >& poses, Evaluation evaluation, double& checksum) {
+  std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+  for (unsigned int p = 0; p < poses.size(); ++p)
+    checksum += evaluation(poses[p]);
+  std::chrono::duration<double> seconds = std::chrono::steady_clock::now() - start;
+  return seconds.count() / poses.size() * 1e9;
+}
+
+
+struct ValueOnly {
+  const Spline<DIM>& spline;
+  double operator()(const vector<double>& x) const { return spline.getValue(x); }
+};
+
+struct FiniteDifferences {
+  const Spline<DIM>& spline;
+  double step;
+  double operator()(const vector<double>& x) const {
+    vector<double> shifted(x);
+    double sum = spline.getValue(x);
+    for (int i = 0; i < DIM; ++i) {
+      shifted[i] = x[i] + step;
+      double forward = spline.getValue(shifted);
+      shifted[i] = x[i] - step;
+      sum += (forward - spline.getValue(shifted)) / (2 * step);
+      shifted[i] = x[i];
+    }
+    return sum;
+  }
+};
+
+struct GenericDual {
+  const Spline<DIM>& spline;
+  double operator()(const vector<double>& x) const {
+    vector<Dual> dualX;
+    for (int i = 0; i < DIM; ++i)
+      dualX.push_back(Dual(x[i], i));
+    Dual value = spline.template getValue<Dual>(dualX);
+    double sum = value.getValue();
+    for (int i = 0; i < DIM; ++i)
+      sum += value.getDerivative(i);
+    return sum;
+  }
+};
+
+struct AnalyticDual {
+  const Spline<DIM>& spline;
+  double operator()(const vector<double>& x) const {
+    vector<Dual> dualX;
+    for (int i = 0; i < DIM; ++i)
+      dualX.push_back(Dual(x[i], i));
+    Dual value = spline.getValue(dualX);
+    double sum = value.getValue();
+    for (int i = 0; i < DIM; ++i)
+      sum += value.getDerivative(i);
+    return sum;
+  }
+};
+
+
+int main(int argc, const char* argv[]) {
+  int n = (argc > 1) ? atoi(argv[1]) : 20;
+  int noPoses = (argc > 2) ? atoi(argv[2]) : 100000;
+  
+  vector<double> a(DIM, 0.), b(DIM, 1.);
+  vector<int> nodes(DIM, n);
+  int noY = 1;
+  for (int i = 0; i < DIM; ++i)
+    noY *= (n+1);
+  vector<double> y(noY);
+  for (int k = 0; k < noY; ++k) {
+    int rest = k;
+    for (int i = 0; i < DIM; ++i) {
+      y[k] += sin( (i+2) * static_cast<double>(rest % (n+1)) / n );
+      rest /= (n+1);
+    }
+  }
+  Spline<DIM> spline(a, b, nodes);
+  spline.computeCoefficients(y, y.begin());
+  
+  // the steps of the finite differences stay inside the grid
+  const double step = 1e-6;
+  std::mt19937 generator(1);
+  vector< vector<double> > poses(noPoses, vector<double>(DIM));
+  for (int p = 0; p < noPoses; ++p)
+    for (int i = 0; i < DIM; ++i)
+      poses[p][i] = std::uniform_real_distribution<double>(step, 1.-step)(generator);
+  
+  double maxError = 0, maxFiniteDifferenceError = 0;
+  for (int p = 0; p < std::min(noPoses, 10000); ++p) {
+    vector<Dual> dualX;
+    for (int i = 0; i < DIM; ++i)
+      dualX.push_back(Dual(poses[p][i], i));
+    Dual analytic = spline.getValue(dualX);
+    Dual generic = spline.template getValue<Dual>(dualX);
+    vector<double> shifted(poses[p]);
+    for (int i = 0; i < DIM; ++i) {
+      maxError = std::max(maxError, fabs(analytic.getDerivative(i) - spline.getFirstDerivative(poses[p], i)));
+      maxError = std::max(maxError, fabs(generic.getDerivative(i) - analytic.getDerivative(i)));
+      shifted[i] = poses[p][i] + step;
+      double forward = spline.getValue(shifted);
+      shifted[i] = poses[p][i] - step;
+      double finiteDifference = (forward - spline.getValue(shifted)) / (2 * step);
+      shifted[i] = poses[p][i];
+      maxFiniteDifferenceError = std::max(maxFiniteDifferenceError, fabs(finiteDifference - analytic.getDerivative(i)));
+    }
+  }
+  
+  double checksum = 0;
+  ValueOnly valueOnly = { spline };
+  FiniteDifferences finiteDifferences = { spline, step };
+  GenericDual genericDual = { spline };
+  AnalyticDual analyticDual = { spline };
+  cout << "Spline<" << DIM << "> with n = " << n << ", " << noPoses << " random poses\n";
+  cout << std::setw(24) << "value only" << std::setw(12) << std::setprecision(4) << measure(poses, valueOnly, checksum) << " ns\n";
+  cout << std::setw(24) << "finite differences" << std::setw(12) << measure(poses, finiteDifferences, checksum) << " ns\n";
+  cout << std::setw(24) << "generic SplineDual" << std::setw(12) << measure(poses, genericDual, checksum) << " ns\n";
+  cout << std::setw(24) << "analytic SplineDual" << std::setw(12) << measure(poses, analyticDual, checksum) << " ns\n";
+  cout << "Max difference of the gradients from getFirstDerivative: " << maxError 
+       << ", of the finite differences: " << maxFiniteDifferenceError << endl;
+  cout << "(checksum " << checksum << ")\n";
+  
+  exit(EXIT_SUCCESS);
+}
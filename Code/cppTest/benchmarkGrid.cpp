@@ -0,0 +1,106 @@
+// Copyright (c) 2011, Massimo Sartori and Monica Reggiani
+// All rights reserved.
+
+// Redistribution and use in source and binary forms, with or without 
+// modification, are permitted provided that the following conditions are met:
+// - Redistributions of source code must retain the above copyright notice, 
+//   this list of conditions and the following disclaimer.
+// - Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+
+
+
+#include <iostream>
+using std::cout;
+using std::endl;
+#include <iomanip>
+#include <vector>
+using std::vector;
+#include <string>
+using std::string;
+#include <stdlib.h>
+#include <math.h>
+#include <time.h>
+
+#include "Spline.h"
+#include "Spline.cpp"
+#include "SyntheticModel.h"
+
+// Compare the evaluation of a Spline<dim> on a tensor grid of samples,
+// point by point with getValue and getFirstDerivative, and with
+// getValuesOnGrid and getFirstDerivativesOnGrid.
+
+const int DIM = 4;
+
+
+int main(int argc, const char* argv[]) {
+  int n = (argc > 1) ? atoi(argv[1]) : 20;
+  int noSamples = (argc > 2) ? atoi(argv[2]) : 30;
+
+  vector<double> a(DIM, 0.), b(DIM, 1.);
+  vector<int> nodes(DIM, n);
+  Spline<DIM> spline(a, b, nodes);
+  
+  SyntheticModel model(DIM, 1);
+  vector<double> y;
+  model.getNodeValues(0, a, b, nodes, y);
+  spline.computeCoefficients(y, y.begin());
+  
+  // samples of each axis, with a different count to catch any mixing of axes
+  vector< vector<double> > samples(DIM);
+  long noPoints = 1;
+  for (int i = 0; i < DIM; ++i) {
+    int noSamplesOfAxis = noSamples + i;
+    for (int p = 0; p < noSamplesOfAxis; ++p)
+      samples[i].push_back(static_cast<double>(p) / (noSamplesOfAxis-1));
+    noPoints *= noSamplesOfAxis;
+  }
+  cout << "Spline<" << DIM << "> with n = " << n << " on a grid of " << noPoints << " points\n";
+  cout << std::setw(16) << "quantity" << std::setw(16) << "point ns/pt" << std::setw(16) << "grid ns/pt"
+       << std::setw(12) << "speedup" << std::setw(14) << "difference" << endl;
+  
+  vector<double> x(DIM), gridValues;
+  for (int d = -1; d < DIM; ++d) {
+    clock_t start = clock();
+    if (d < 0)
+      spline.getValuesOnGrid(samples, gridValues);
+    else
+      spline.getFirstDerivativesOnGrid(samples, d, gridValues);
+    double gridSeconds = static_cast<double>(clock() - start) / CLOCKS_PER_SEC;
+    
+    // the first axis runs fastest in the grid
+    start = clock();
+    double difference = 0.;
+    vector<int> j(DIM, 0);
+    for (long k = 0; k < noPoints; ++k) {
+      for (int i = 0; i < DIM; ++i)
+        x[i] = samples[i][j[i]];
+      double value = (d < 0) ? spline.getValue(x) : spline.getFirstDerivative(x, d);
+      difference = std::max(difference, fabs(value - gridValues[k]));
+      for (int i = 0; (i < DIM) && (++j[i] == static_cast<int>(samples[i].size())); ++i)
+        j[i] = 0;
+    }
+    double pointSeconds = static_cast<double>(clock() - start) / CLOCKS_PER_SEC;
+    
+    cout << std::setw(16) << ( (d < 0) ? string("value") : "derivative " + std::to_string(d) )
+         << std::setw(16) << std::setprecision(4) << pointSeconds / noPoints * 1e9
+         << std::setw(16) << gridSeconds / noPoints * 1e9
+         << std::setw(12) << pointSeconds / gridSeconds
+         << std::setw(14) << difference << endl;
+  }
+  
+  exit(EXIT_SUCCESS);
+}
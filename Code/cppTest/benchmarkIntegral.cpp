@@ -0,0 +1,123 @@
+// Copyright (c) 2011, Massimo Sartori and Monica Reggiani
+// All rights reserved.
+
+// Redistribution and use in source and binary forms, with or without 
+// modification, are permitted provided that the following conditions are met:
+// - Redistributions of source code must retain the above copyright notice, 
+//   this list of conditions and the following disclaimer.
+// - Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+
+
+
+#include <iostream>
+using std::cout;
+using std::endl;
+#include <iomanip>
+#include <vector>
+using std::vector;
+#include <chrono>
+#include <stdlib.h>
+#include <math.h>
+
+#include "Spline.h"
+#include "Spline.cpp"
+
+// The integral of a spline over a box of its 4 DOFs, and along a path,
+// exact against the midpoint rule with more and more samples per DOF.
+
+const int DIM = 4;
+
+
+double getSeconds(const std::chrono::steady_clock::time_point& start) {
+  std::chrono::duration<double> seconds = std::chrono::steady_clock::now() - start;
+  return seconds.count();
+}
+
+
+int main(int argc, const char* argv[]) {
+  int n = (argc > 1) ? atoi(argv[1]) : 20;
+  int maxSamples = (argc > 2) ? atoi(argv[2]) : 32;
+  
+  vector<double> a(DIM, 0.), b(DIM, 1.);
+  vector<int> nodes(DIM, n);
+  int noY = 1;
+  for (int i = 0; i < DIM; ++i)
+    noY *= (n+1);
+  vector<double> y(noY);
+  for (int k = 0; k < noY; ++k) {
+    int rest = k;
+    for (int i = 0; i < DIM; ++i) {
+      y[k] += sin( (i+2) * static_cast<double>(rest % (n+1)) / n );
+      rest /= (n+1);
+    }
+  }
+  Spline<DIM> spline(a, b, nodes);
+  spline.computeCoefficients(y, y.begin());
+  
+  vector<double> lower(DIM), upper(DIM);
+  double volume = 1;
+  for (int i = 0; i < DIM; ++i) {
+    lower[i] = 0.1 * (i+1);
+    upper[i] = 0.95 - 0.05 * i;
+    volume *= upper[i] - lower[i];
+  }
+  
+  std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+  const double exact = spline.getIntegral(lower, upper);
+  double exactTime = getSeconds(start);
+  cout << "Box integral: " << std::setprecision(12) << exact << " in " << std::setprecision(4) << exactTime * 1e6 << " us\n";
+  cout << std::setw(10) << "samples" << std::setw(14) << "error" << std::setw(14) << "time (us)" << endl;
+  vector<double> x(DIM);
+  for (int m = 4; m <= maxSamples; m *= 2) {
+    start = std::chrono::steady_clock::now();
+    long noPoints = 1;
+    for (int i = 0; i < DIM; ++i)
+      noPoints *= m;
+    double sum = 0;
+    for (long p = 0; p < noPoints; ++p) {
+      long rest = p;
+      for (int i = 0; i < DIM; ++i) {
+        x[i] = lower[i] + (rest % m + 0.5) * (upper[i] - lower[i]) / m;
+        rest /= m;
+      }
+      sum += spline.getValue(x);
+    }
+    sum *= volume / noPoints;
+    double time = getSeconds(start);
+    cout << std::setw(10) << m << std::setw(14) << fabs(sum - exact) << std::setw(14) << time * 1e6 << endl;
+  }
+  
+  // a closed loop: the work of all the DOFs adds up to zero
+  vector< vector<double> > path;
+  for (int p = 0; p <= 8; ++p) {
+    double angle = 2 * acos(-1.) * p / 8;
+    for (int i = 0; i < DIM; ++i)
+      x[i] = 0.5 + 0.3 * cos(angle + i);
+    path.push_back(x);
+  }
+  start = std::chrono::steady_clock::now();
+  double lineIntegral = spline.getLineIntegral(path);
+  double work = 0;
+  for (int i = 0; i < DIM; ++i)
+    work += spline.getLineIntegralOfFirstDerivative(path, i);
+  double lineTime = getSeconds(start);
+  cout << "Line integral on a closed path of 8 segments: " << std::setprecision(12) << lineIntegral 
+       << ", sum of the works of the DOFs " << std::setprecision(4) << work 
+       << " (in " << lineTime * 1e6 << " us)\n";
+  
+  exit(EXIT_SUCCESS);
+}
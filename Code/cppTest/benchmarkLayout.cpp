@@ -0,0 +1,161 @@
+// Copyright (c) 2011, Massimo Sartori and Monica Reggiani
+// All rights reserved.
+
+// Redistribution and use in source and binary forms, with or without 
+// modification, are permitted provided that the following conditions are met:
+// - Redistributions of source code must retain the above copyright notice, 
+//   this list of conditions and the following disclaimer.
+// - Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+
+
+#include <iostream>
+using std::cout;
+using std::endl;
+#include <iomanip>
+#include <vector>
+using std::vector;
+#include <string>
+using std::string;
+#include <stdlib.h>
+#include <math.h>
+#include <time.h>
+
+#include "Spline.h"
+#include "Spline.cpp"
+#include "SyntheticModel.h"
+
+// Compare the coefficient layouts of Spline<dim> on random poses and on a
+// smooth trajectory. Besides the evaluation time, the coefficients touched
+// by each evaluation are run through a simulated L1 (32KB) and L2 (1MB)
+// LRU cache with 64 byte lines, to count the misses of each layout.
+
+const int DIM = 4;
+const int LINE_SIZE = 64;
+
+class SimulatedCache {
+public:
+  SimulatedCache(int size, int ways)
+  :ways_(ways), noSets_(size / LINE_SIZE / ways), tags_(noSets_ * ways, -1), lastUse_(noSets_ * ways, 0), 
+   time_(0), misses_(0) {}
+  void access(long line) {
+    int set = line % noSets_;
+    ++time_;
+    int victim = set * ways_;
+    for (int w = set * ways_; w < (set+1) * ways_; ++w) {
+      if (tags_[w] == line) {
+        lastUse_[w] = time_;
+        return;
+      }
+      if (lastUse_[w] < lastUse_[victim])
+        victim = w;
+    }
+    ++misses_;
+    tags_[victim] = line;
+    lastUse_[victim] = time_;
+  }
+  long getMisses() const { return misses_; }
+private:
+  int ways_;
+  int noSets_;
+  vector<long> tags_;
+  vector<long> lastUse_;
+  long time_;
+  long misses_;
+};
+
+
+void randomPoses(int noPoints, vector< vector<double> >& x) {
+  srand(1);
+  x.assign(noPoints, vector<double>(DIM));
+  for (int p = 0; p < noPoints; ++p)
+    for (int i = 0; i < DIM; ++i)
+      x[p][i] = rand() / static_cast<double>(RAND_MAX);
+}
+
+
+// a cyclic movement, as in gait: each DOF oscillates with its own phase
+void trajectory(int noPoints, vector< vector<double> >& x) {
+  x.assign(noPoints, vector<double>(DIM));
+  for (int p = 0; p < noPoints; ++p)
+    for (int i = 0; i < DIM; ++i)
+      x[p][i] = 0.5 + 0.45 * sin( 2 * M_PI * p / 1000. * (1 + 0.1*i) + i );
+}
+
+
+void benchmark(const string& workload, Spline<DIM>& spline, const vector< vector<double> >& x) {
+  const char* layoutNames[] = { "row-major", "tiled", "Morton" };
+  SplineCoefficientLayout layouts[] = { ROW_MAJOR_LAYOUT, TILED_LAYOUT, MORTON_LAYOUT };
+  
+  for (int l = 0; l < 3; ++l) {
+    spline.setLayout(layouts[l]);
+    
+    clock_t start = clock();
+    double sum = 0;
+    for (unsigned int p = 0; p < x.size(); ++p) {
+      sum += spline.getValue(x[p]);
+      for (int k = 0; k < DIM; ++k)
+        sum += spline.getFirstDerivative(x[p], k);
+    }
+    double seconds = static_cast<double>(clock() - start) / CLOCKS_PER_SEC;
+
+    SimulatedCache l1(32 * 1024, 8), l2(1024 * 1024, 16);
+    vector<int> indexes;
+    for (unsigned int p = 0; p < x.size(); ++p) {
+      spline.getStencilIndexes(x[p], indexes);
+      for (unsigned int k = 0; k < indexes.size(); ++k) {
+        long line = indexes[k] * static_cast<long>(sizeof(double)) / LINE_SIZE;
+        l1.access(line);
+        l2.access(line);
+      }
+    }
+    
+    cout << std::setw(12) << workload << std::setw(12) << layoutNames[l] 
+         << std::setw(12) << std::setprecision(4) << seconds / x.size() * 1e9
+         << std::setw(12) << static_cast<double>(l1.getMisses()) / x.size()
+         << std::setw(12) << static_cast<double>(l2.getMisses()) / x.size() 
+         << std::setw(12) << spline.getMemory() / 1e6
+         << "   (" << sum << ")" << endl;
+  }
+}
+
+
+int main(int argc, const char* argv[]) {
+  int n = (argc > 1) ? atoi(argv[1]) : 40;
+  int noPoints = (argc > 2) ? atoi(argv[2]) : 100000;
+
+  vector<double> a(DIM, 0.), b(DIM, 1.);
+  vector<int> nodes(DIM, n);
+  Spline<DIM> spline(a, b, nodes);
+  
+  SyntheticModel model(DIM, 1);
+  vector<double> y;
+  model.getNodeValues(0, a, b, nodes, y);
+  spline.computeCoefficients(y, y.begin());
+
+  cout << "Spline<" << DIM << "> with n = " << n << ": " << spline.getCoefficients().size() * sizeof(double) / 1e6 
+       << " MB of coefficients in row-major order, " << noPoints << " points\n";
+  cout << std::setw(12) << "workload" << std::setw(12) << "layout" << std::setw(12) << "ns/point" 
+       << std::setw(12) << "L1 miss/pt" << std::setw(12) << "L2 miss/pt" << std::setw(12) << "MB" << endl;
+  
+  vector< vector<double> > x;
+  randomPoses(noPoints, x);
+  benchmark("random", spline, x);
+  trajectory(noPoints, x);
+  benchmark("trajectory", spline, x);
+  
+  exit(EXIT_SUCCESS);
+}
@@ -0,0 +1,111 @@
+// Copyright (c) 2011, Massimo Sartori and Monica Reggiani
+// All rights reserved.
+
+// Redistribution and use in source and binary forms, with or without 
+// modification, are permitted provided that the following conditions are met:
+// - Redistributions of source code must retain the above copyright notice, 
+//   this list of conditions and the following disclaimer.
+// - Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+
+
+
+#include <iostream>
+using std::cout;
+using std::endl;
+#include <iomanip>
+#include <vector>
+using std::vector;
+#include <string>
+using std::string;
+#include <chrono>
+#include <stdlib.h>
+#include <math.h>
+
+#include "SplineBatchEvaluator.h"
+#include "Spline.cpp"
+#include "SplineSet.cpp"
+#include "SplineBatchEvaluator.cpp"
+#include "SyntheticModel.h"
+
+// Throughput of SplineBatchEvaluator on random poses, shared and NUMA-aware,
+// from one thread to all the CPUs. The splines are synthetic, one per muscle,
+// large enough not to fit in the caches.
+
+const int DIM = 4;
+
+
+double measure(SplineBatchEvaluator<DIM>& evaluator, const vector<double>& x, const int noRepetitions) {
+  vector<double> values;
+  evaluator.evaluate(x, values);
+  std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+  for (int r = 0; r < noRepetitions; ++r)
+    evaluator.evaluate(x, values);
+  std::chrono::duration<double> seconds = std::chrono::steady_clock::now() - start;
+  return noRepetitions * (x.size() / DIM) / seconds.count();
+}
+
+
+int main(int argc, const char* argv[]) {
+  int n = (argc > 1) ? atoi(argv[1]) : 30;
+  int noMuscles = (argc > 2) ? atoi(argv[2]) : 8;
+  int noPoses = (argc > 3) ? atoi(argv[3]) : 20000;
+  const int noRepetitions = 5;
+
+  vector<double> a(DIM, 0.), b(DIM, 1.);
+  vector<int> nodes(DIM, n);
+  SyntheticModel model(DIM, noMuscles);
+  vector<string> muscleNames;
+  vector< vector<double> > y(noMuscles);
+  for (int m = 0; m < noMuscles; ++m) {
+    muscleNames.push_back(model.getMuscleName(m));
+    model.getNodeValues(m, a, b, nodes, y[m]);
+  }
+  SplineSet<DIM> splineSet(a, b, nodes, muscleNames, y);
+  
+  srand(1);
+  vector<double> x(noPoses * DIM);
+  for (unsigned int k = 0; k < x.size(); ++k)
+    x[k] = rand() / static_cast<double>(RAND_MAX);
+  
+  SplineNumaTopology topology;
+  int noCpus = topology.getNumberOfCpus();
+  cout << noMuscles << " splines with n = " << n << ": " 
+       << noMuscles * pow(n+3., DIM) * sizeof(double) / 1e6 << " MB of coefficients, " 
+       << noPoses << " poses per batch\n";
+  cout << topology.getNumberOfNodes() << " NUMA nodes, " << noCpus << " cpus\n";
+  cout << std::setw(8) << "threads" << std::setw(10) << "mode" << std::setw(14) << "poses/s" 
+       << std::setw(10) << "speedup" << std::setw(10) << "local %" << endl;
+  
+  double singleThread[2] = { 0., 0. };
+  for (int noThreads = 1; ; noThreads = std::min(2*noThreads, noCpus)) {
+    for (int numaAware = 0; numaAware < 2; ++numaAware) {
+      SplineBatchEvaluator<DIM> evaluator(splineSet, numaAware == 1, noThreads);
+      double posesPerSecond = measure(evaluator, x, noRepetitions);
+      if (noThreads == 1)
+        singleThread[numaAware] = posesPerSecond;
+      double accesses = evaluator.getLocalAccesses() + evaluator.getRemoteAccesses();
+      cout << std::setw(8) << noThreads << std::setw(10) << (numaAware ? "numa" : "shared")
+           << std::setw(14) << std::setprecision(4) << posesPerSecond
+           << std::setw(10) << posesPerSecond / singleThread[numaAware]
+           << std::setw(10) << 100. * evaluator.getLocalAccesses() / accesses << endl;
+    }
+    if (noThreads == noCpus)
+      break;
+  }
+  
+  exit(EXIT_SUCCESS);
+}
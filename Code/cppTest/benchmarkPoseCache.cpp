@@ -0,0 +1,237 @@
+// Copyright (c) 2011, Massimo Sartori and Monica Reggiani
+// All rights reserved.
+
+// Redistribution and use in source and binary forms, with or without 
+// modification, are permitted provided that the following conditions are met:
+// - Redistributions of source code must retain the above copyright notice, 
+//   this list of conditions and the following disclaimer.
+// - Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+
+
+
+#include <iostream>
+using std::cout;
+using std::endl;
+#include <iomanip>
+#include <vector>
+using std::vector;
+#include <string>
+using std::string;
+#include <sstream>
+#include <algorithm>
+#include <random>
+#include <chrono>
+#include <thread>
+#include <stdlib.h>
+#include <math.h>
+
+#include "Spline.h"
+#include "SplineSet.h"
+#include "SplinePoseCache.h"
+#include "Spline.cpp"
+#include "SplineSet.cpp"
+#include "SplinePoseCache.cpp"
+#include "SyntheticModel.h"
+
+// The poses of an optimization sweep: noDistinct poses visited noVisits
+// times each, in random order, by noThreads threads sharing the cache.
+// Each visit asks for the lmt and the derivatives of all the muscles,
+// directly from the SplineSet or through a SplinePoseCache; the jittered
+// sweep moves every visit by less than half a quantum, so that only a
+// quantized cache finds it again. A last run checks the cache under
+// contention: several threads with evictions must get back exactly the
+// values of the SplineSet, and the cache must not exceed its capacity.
+
+const int DIM = 4;
+
+
+void evaluateDirectly(const SplineSet<DIM>& splineSet, const vector< vector<double> >& poses, 
+                      const int firstPose, const int noThreads, double& checksum) {
+  vector<double> values, derivatives;
+  for (unsigned int p = firstPose; p < poses.size(); p += noThreads) {
+    splineSet.getValues(poses[p], values);
+    checksum += values[0];
+    for (int k = 0; k < DIM; ++k) {
+      splineSet.getFirstDerivatives(poses[p], k, derivatives);
+      checksum += derivatives[0];
+    }
+  }
+}
+
+
+void evaluateThroughCache(SplinePoseCache<DIM>& cache, const vector< vector<double> >& poses, 
+                          const int firstPose, const int noThreads, double& checksum) {
+  vector<double> values, derivatives;
+  for (unsigned int p = firstPose; p < poses.size(); p += noThreads) {
+    cache.getValuesAndFirstDerivatives(poses[p], values, derivatives);
+    checksum += values[0] + derivatives[0];
+  }
+}
+
+
+// the poses in the order of the thread, each compared with its references
+void checkThroughCache(SplinePoseCache<DIM>& cache, const vector< vector<double> >& poses,
+                       const vector< vector<double> >& referenceValues, const vector< vector<double> >& referenceDerivatives,
+                       const int thread, long& noMismatches) {
+  vector<int> order(poses.size());
+  for (unsigned int p = 0; p < order.size(); ++p)
+    order[p] = p;
+  std::mt19937 generator(thread + 1);
+  std::shuffle(order.begin(), order.end(), generator);
+  vector<double> values, derivatives;
+  for (int visit = 0; visit < 4; ++visit)
+    for (unsigned int p = 0; p < order.size(); ++p) {
+      cache.getValuesAndFirstDerivatives(poses[order[p]], values, derivatives);
+      if (values != referenceValues[order[p]] || derivatives != referenceDerivatives[order[p]])
+        ++noMismatches;
+    }
+}
+
+
+// ns per visit
+double measure(const SplineSet<DIM>& splineSet, SplinePoseCache<DIM>* cache, 
+               const vector< vector<double> >& poses, const int noThreads) {
+  vector<double> checksums(noThreads, 0.);
+  std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+  vector<std::thread> threads;
+  for (int t = 0; t < noThreads; ++t) {
+    if (cache)
+      threads.push_back(std::thread(evaluateThroughCache, std::ref(*cache), std::cref(poses), t, noThreads, std::ref(checksums[t])));
+    else
+      threads.push_back(std::thread(evaluateDirectly, std::cref(splineSet), std::cref(poses), t, noThreads, std::ref(checksums[t])));
+  }
+  for (int t = 0; t < noThreads; ++t)
+    threads[t].join();
+  std::chrono::duration<double> seconds = std::chrono::steady_clock::now() - start;
+  return seconds.count() / poses.size() * 1e9;
+}
+
+
+int main(int argc, const char* argv[]) {
+  int noMuscles = (argc > 1) ? atoi(argv[1]) : 20;
+  int noDistinct = (argc > 2) ? atoi(argv[2]) : 10000;
+  int noVisits = (argc > 3) ? atoi(argv[3]) : 20;
+  int noThreads = (argc > 4) ? atoi(argv[4]) : 1;
+  const int n = 20;
+  const double quantum = 1e-3;
+  
+  vector<double> a(DIM, 0.), b(DIM, 1.);
+  vector<int> nodes(DIM, n);
+  SyntheticModel model(DIM, noMuscles);
+  vector<string> muscleNames;
+  vector< vector<double> > y(noMuscles);
+  for (int m = 0; m < noMuscles; ++m) {
+    muscleNames.push_back(model.getMuscleName(m));
+    model.getNodeValues(m, a, b, nodes, y[m]);
+  }
+  SplineSet<DIM> splineSet(a, b, nodes, muscleNames, y);
+  
+  // the distinct poses lie on the quantum grid, so that the jittered
+  // visits round back to them
+  std::mt19937 generator(1);
+  vector< vector<double> > distinct(noDistinct, vector<double>(DIM));
+  for (int p = 0; p < noDistinct; ++p)
+    for (int i = 0; i < DIM; ++i)
+      distinct[p][i] = std::uniform_int_distribution<int>(0, static_cast<int>(1. / quantum))(generator) * quantum;
+  vector< vector<double> > sweep, jittered;
+  for (int v = 0; v < noVisits; ++v)
+    sweep.insert(sweep.end(), distinct.begin(), distinct.end());
+  std::shuffle(sweep.begin(), sweep.end(), generator);
+  jittered = sweep;
+  for (unsigned int p = 0; p < jittered.size(); ++p)
+    for (int i = 0; i < DIM; ++i)
+      jittered[p][i] = std::min(1., std::max(0., jittered[p][i] + std::uniform_real_distribution<double>(-0.4, 0.4)(generator) * quantum));
+  
+  cout << noMuscles << " muscles, " << noDistinct << " distinct poses visited " << noVisits << " times, " 
+       << noThreads << " threads\n";
+  cout << std::setw(28) << "" << std::setw(14) << "ns per visit" << std::setw(12) << "hit rate" << endl;
+  cout << std::setw(28) << "no cache" << std::setw(14) << std::setprecision(4) 
+       << measure(splineSet, 0, sweep, noThreads) << endl;
+  
+  // capacities of all the poses and of a quarter of them
+  const int capacities[] = { noDistinct, noDistinct / 4 };
+  const SplineCacheEviction evictions[] = { LRU_EVICTION, FIFO_EVICTION };
+  const char* evictionNames[] = { "LRU", "FIFO" };
+  for (int c = 0; c < 2; ++c)
+    for (int e = 0; e < 2; ++e) {
+      SplinePoseCache<DIM> cache(splineSet, std::max(1, capacities[c]), 0., evictions[e]);
+      std::stringstream label;
+      label << "exact, " << evictionNames[e] << ", " << capacities[c] << " poses";
+      cout << std::setw(28) << label.str() << std::setw(14) << measure(splineSet, &cache, sweep, noThreads)
+           << std::setw(12) << cache.getHitRate() << endl;
+    }
+  
+  SplinePoseCache<DIM> exactCache(splineSet, noDistinct);
+  cout << std::setw(28) << "jittered, exact" << std::setw(14) << measure(splineSet, &exactCache, jittered, noThreads)
+       << std::setw(12) << exactCache.getHitRate() << endl;
+  SplinePoseCache<DIM> quantizedCache(splineSet, noDistinct, quantum);
+  cout << std::setw(28) << "jittered, quantized" << std::setw(14) << measure(splineSet, &quantizedCache, jittered, noThreads)
+       << std::setw(12) << quantizedCache.getHitRate() << endl;
+  
+  // what quantization costs in accuracy
+  double maxValueError = 0., maxDerivativeError = 0.;
+  vector<double> values, derivatives, exactValues, exactDerivatives;
+  for (unsigned int p = 0; p < std::min(jittered.size(), static_cast<size_t>(10000)); ++p) {
+    quantizedCache.getValuesAndFirstDerivatives(jittered[p], values, derivatives);
+    splineSet.getValues(jittered[p], exactValues);
+    for (int i = 0; i < noMuscles; ++i)
+      maxValueError = std::max(maxValueError, fabs(values[i] - exactValues[i]));
+    for (int k = 0; k < DIM; ++k) {
+      splineSet.getFirstDerivatives(jittered[p], k, exactDerivatives);
+      for (int i = 0; i < noMuscles; ++i)
+        maxDerivativeError = std::max(maxDerivativeError, fabs(derivatives[k*noMuscles + i] - exactDerivatives[i]));
+    }
+  }
+  cout << "Quantum " << quantum << ": max error " << maxValueError << " on the values, " 
+       << maxDerivativeError << " on the derivatives\n";
+  
+  // a capacity that is not a multiple of the number of shards, with
+  // evictions, and at least 4 threads
+  const int noCheckThreads = std::max(4, noThreads);
+  const int noChecked = std::min(noDistinct, 2000);
+  const int checkCapacity = noChecked / 3 + 1;
+  vector< vector<double> > checked(distinct.begin(), distinct.begin() + noChecked);
+  vector< vector<double> > referenceValues(noChecked), referenceDerivatives(noChecked);
+  for (int p = 0; p < noChecked; ++p) {
+    splineSet.getValues(checked[p], referenceValues[p]);
+    for (int k = 0; k < DIM; ++k) {
+      splineSet.getFirstDerivatives(checked[p], k, derivatives);
+      referenceDerivatives[p].insert(referenceDerivatives[p].end(), derivatives.begin(), derivatives.end());
+    }
+  }
+  SplinePoseCache<DIM> sharedCache(splineSet, checkCapacity);
+  vector<long> noMismatches(noCheckThreads, 0);
+  vector<std::thread> threads;
+  for (int t = 0; t < noCheckThreads; ++t)
+    threads.push_back(std::thread(checkThroughCache, std::ref(sharedCache), std::cref(checked), std::cref(referenceValues),
+                                  std::cref(referenceDerivatives), t, std::ref(noMismatches[t])));
+  long totalMismatches = 0;
+  for (int t = 0; t < noCheckThreads; ++t) {
+    threads[t].join();
+    totalMismatches += noMismatches[t];
+  }
+  const long noLookUps = 4L * noChecked * noCheckThreads;
+  bool passed = (totalMismatches == 0) && (sharedCache.getSize() <= checkCapacity)
+                && (sharedCache.getNumberOfHits() + sharedCache.getNumberOfMisses() == noLookUps);
+  cout << noCheckThreads << " threads on a cache of " << checkCapacity << " poses: " << totalMismatches
+       << " mismatches, " << sharedCache.getSize() << " poses kept, " << sharedCache.getNumberOfEvictions()
+       << " evictions, hit rate " << sharedCache.getHitRate() << endl;
+  if (!passed)
+    cout << "ERROR: the cache differs from the SplineSet under contention\n";
+  
+  exit(passed ? EXIT_SUCCESS : EXIT_FAILURE);
+}
@@ -0,0 +1,141 @@
+// Copyright (c) 2011, Massimo Sartori and Monica Reggiani
+// All rights reserved.
+
+// Redistribution and use in source and binary forms, with or without 
+// modification, are permitted provided that the following conditions are met:
+// - Redistributions of source code must retain the above copyright notice, 
+//   this list of conditions and the following disclaimer.
+// - Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+
+
+
+#include <iostream>
+using std::cout;
+using std::endl;
+#include <iomanip>
+#include <string>
+using std::string;
+#include <vector>
+using std::vector;
+#include <chrono>
+#include <random>
+#define _USE_MATH_DEFINES
+#include <math.h>
+#include <stdlib.h>
+
+#include "SplineSet.h"
+#include "Spline.cpp"
+#include "SplineSet.cpp"
+#include "SyntheticModel.h"
+
+// Sweeps the number of DOFs, of intervals on each DOF and of muscles of a
+// SyntheticModel, and reports for each model the memory of the coefficients,
+// the fit time, the evaluation throughput on random poses and the largest
+// error of lmt there. The models that need more than maxMemory (values on
+// the nodes and coefficients) are skipped.
+
+const int INTERVALS[] = { 5, 10, 20, 40 };
+const int MUSCLES[] = { 1, 10, 50 };
+
+inline double radians (double d) {
+return d * M_PI / 180;
+}
+
+
+template <int dim>
+void sweep(const double maxMemory, const int noPoses) {
+  const int noMusclesOfModel = MUSCLES[sizeof(MUSCLES)/sizeof(int) - 1];
+  SyntheticModel model(dim, noMusclesOfModel);
+  vector<double> a(dim), b(dim);
+  for (int i = 0; i < dim; ++i) {
+    a[i] = radians(model.getLowerBound(i));
+    b[i] = radians(model.getUpperBound(i));
+  }
+  
+  std::mt19937 generator(dim);
+  std::uniform_real_distribution<double> uniform(0., 1.);
+  vector< vector<double> > poses(noPoses, vector<double>(dim));
+  for (int p = 0; p < noPoses; ++p)
+    for (int i = 0; i < dim; ++i)
+      poses[p][i] = a[i] + (b[i] - a[i]) * uniform(generator);
+  
+  for (unsigned int s = 0; s < sizeof(INTERVALS)/sizeof(int); ++s) {
+    vector<int> n(dim, INTERVALS[s]);
+    double noNodes = pow(INTERVALS[s] + 1., dim);
+    double noCoefficients = pow(INTERVALS[s] + 3., dim);
+    
+    for (unsigned int t = 0; t < sizeof(MUSCLES)/sizeof(int); ++t) {
+      const int noMuscles = MUSCLES[t];
+      double memory = noCoefficients * noMuscles * sizeof(double);
+      if ( (noNodes + noCoefficients) * noMuscles * sizeof(double) > maxMemory )
+        continue;
+      
+      vector<string> muscleNames;
+      vector< vector<double> > y(noMuscles);
+      for (int m = 0; m < noMuscles; ++m) {
+        muscleNames.push_back(model.getMuscleName(m));
+        model.getNodeValues(m, a, b, n, y[m]);
+      }
+      
+      std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+      SplineSet<dim> splineSet(a, b, n, muscleNames, y);
+      std::chrono::duration<double> fitTime = std::chrono::steady_clock::now() - start;
+      y.clear();
+      
+      vector<double> values;
+      double sum = 0.;
+      start = std::chrono::steady_clock::now();
+      for (int p = 0; p < noPoses; ++p) {
+        splineSet.getValues(poses[p], values);
+        sum += values[0];
+      }
+      std::chrono::duration<double> evaluationTime = std::chrono::steady_clock::now() - start;
+      
+      double error = 0.;
+      for (int p = 0; p < noPoses; ++p) {
+        splineSet.getValues(poses[p], values);
+        for (int m = 0; m < noMuscles; ++m)
+          error = std::max(error, fabs(values[m] - model.getLmt(m, poses[p])));
+      }
+      
+      cout << std::setw(5) << dim << std::setw(6) << INTERVALS[s] << std::setw(9) << noMuscles
+           << std::setw(12) << std::setprecision(4) << memory / 1e6
+           << std::setw(12) << fitTime.count()
+           << std::setw(12) << evaluationTime.count() / noPoses / noMuscles * 1e9
+           << std::setw(12) << noPoses / evaluationTime.count()
+           << std::setw(12) << error
+           << "   (" << sum << ")" << endl;
+    }
+  }
+}
+
+
+int main(int argc, const char* argv[]) {
+  double maxMemory = ( (argc > 1) ? atof(argv[1]) : 1000. ) * 1e6;
+  int noPoses = (argc > 2) ? atoi(argv[2]) : 10000;
+  
+  cout << "Models up to " << maxMemory / 1e6 << " MB, " << noPoses << " random poses\n";
+  cout << std::setw(5) << "dofs" << std::setw(6) << "n" << std::setw(9) << "muscles"
+       << std::setw(12) << "coeffs MB" << std::setw(12) << "fit s" << std::setw(12) << "ns/muscle"
+       << std::setw(12) << "poses/s" << std::setw(12) << "lmt error" << endl;
+  sweep<2>(maxMemory, noPoses);
+  sweep<3>(maxMemory, noPoses);
+  sweep<4>(maxMemory, noPoses);
+  sweep<5>(maxMemory, noPoses);
+  sweep<6>(maxMemory, noPoses);
+  exit(EXIT_SUCCESS);
+}
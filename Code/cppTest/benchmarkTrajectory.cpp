@@ -0,0 +1,160 @@
+// Copyright (c) 2011, Massimo Sartori and Monica Reggiani
+// All rights reserved.
+
+// Redistribution and use in source and binary forms, with or without 
+// modification, are permitted provided that the following conditions are met:
+// - Redistributions of source code must retain the above copyright notice, 
+//   this list of conditions and the following disclaimer.
+// - Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+
+
+
+#include <iostream>
+using std::cout;
+using std::endl;
+#include <iomanip>
+#include <vector>
+using std::vector;
+#include <string>
+using std::string;
+#include <sstream>
+#include <algorithm>
+#include <chrono>
+#include <stdlib.h>
+#include <math.h>
+
+#include "SplineSet.h"
+#include "Spline.cpp"
+#include "SplineSet.cpp"
+
+// Lengths, moment arms and lengthening velocities of all the muscles on a
+// gait-like trial of 4 DOFs, in chunks of frames as a driver would stream
+// them: with getValues, dim getFirstDerivatives and the dot product with the
+// angular velocities, with getValueAndGradient per muscle, and with
+// SplineSet::getTrajectory.
+
+const int DIM = 4;
+const double PI = 3.14159265358979;
+
+
+double getSeconds(const std::chrono::steady_clock::time_point& start) {
+  std::chrono::duration<double> seconds = std::chrono::steady_clock::now() - start;
+  return seconds.count();
+}
+
+
+int main(int argc, const char* argv[]) {
+  int n = (argc > 1) ? atoi(argv[1]) : 20;
+  long noFrames = (argc > 2) ? atol(argv[2]) : 1000000;
+  int noMuscles = (argc > 3) ? atoi(argv[3]) : 10;
+  const long framesPerChunk = 10000;
+  
+  vector<double> a(DIM, -1.), b(DIM, 1.);
+  vector<int> nodes(DIM, n);
+  int noY = 1;
+  for (int i = 0; i < DIM; ++i)
+    noY *= (n+1);
+  vector<string> muscleNames;
+  vector< vector<double> > y(noMuscles, vector<double>(noY));
+  for (int m = 0; m < noMuscles; ++m) {
+    std::stringstream name;
+    name << "muscle" << m;
+    muscleNames.push_back(name.str());
+    for (int k = 0; k < noY; ++k) {
+      double value = 0.3;
+      int rest = k;
+      for (int i = 0; i < DIM; ++i) {
+        value += 0.02 * (i+1) * sin( (m+1) * (-1. + 2. * (rest % (n+1)) / n) + i );
+        rest /= (n+1);
+      }
+      y[m][k] = value;
+    }
+  }
+  SplineSet<DIM> splineSet(a, b, nodes, muscleNames, y);
+  
+  // gait cycles of one second sampled at 1 kHz, each DOF with its own phase
+  vector<double> angles(framesPerChunk * DIM), angularVelocities(framesPerChunk * DIM);
+  vector<double> lengths(framesPerChunk * noMuscles), momentArms(framesPerChunk * noMuscles * DIM);
+  vector<double> velocities(framesPerChunk * noMuscles);
+  vector<double> referenceLengths(lengths.size()), referenceMomentArms(momentArms.size()), referenceVelocities(velocities.size());
+  vector<double> x(DIM), values, derivatives, gradient(DIM);
+  double separateTime = 0, gradientTime = 0, trajectoryTime = 0;
+  double maxDifference = 0;
+  
+  for (long first = 0; first < noFrames; first += framesPerChunk) {
+    const long noChunkFrames = std::min(framesPerChunk, noFrames - first);
+    for (long f = 0; f < noChunkFrames; ++f)
+      for (int i = 0; i < DIM; ++i) {
+        const double phase = 2 * PI * (first + f) / 1000. + i;
+        angles[f*DIM + i] = 0.9 * sin(phase);
+        angularVelocities[f*DIM + i] = 0.9 * 2 * PI * cos(phase);
+      }
+    
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    for (long f = 0; f < noChunkFrames; ++f) {
+      x.assign(&angles[f*DIM], &angles[f*DIM] + DIM);
+      splineSet.getValues(x, values);
+      for (int m = 0; m < noMuscles; ++m) {
+        referenceLengths[f*noMuscles + m] = values[m];
+        referenceVelocities[f*noMuscles + m] = 0;
+      }
+      for (int i = 0; i < DIM; ++i) {
+        splineSet.getFirstDerivatives(x, i, derivatives);
+        for (int m = 0; m < noMuscles; ++m) {
+          referenceMomentArms[(f*noMuscles + m)*DIM + i] = -derivatives[m];
+          referenceVelocities[f*noMuscles + m] += derivatives[m] * angularVelocities[f*DIM + i];
+        }
+      }
+    }
+    separateTime += getSeconds(start);
+    
+    start = std::chrono::steady_clock::now();
+    for (long f = 0; f < noChunkFrames; ++f) {
+      x.assign(&angles[f*DIM], &angles[f*DIM] + DIM);
+      for (int m = 0; m < noMuscles; ++m) {
+        splineSet.getSpline(m).getValueAndGradient(x, lengths[f*noMuscles + m], gradient);
+        double velocity = 0;
+        for (int i = 0; i < DIM; ++i) {
+          momentArms[(f*noMuscles + m)*DIM + i] = -gradient[i];
+          velocity += gradient[i] * angularVelocities[f*DIM + i];
+        }
+        velocities[f*noMuscles + m] = velocity;
+      }
+    }
+    gradientTime += getSeconds(start);
+    
+    start = std::chrono::steady_clock::now();
+    splineSet.getTrajectory(&angles[0], &angularVelocities[0], noChunkFrames, &lengths[0], &momentArms[0], &velocities[0]);
+    trajectoryTime += getSeconds(start);
+    
+    for (long k = 0; k < noChunkFrames * noMuscles; ++k) {
+      maxDifference = std::max(maxDifference, fabs(lengths[k] - referenceLengths[k]));
+      maxDifference = std::max(maxDifference, fabs(velocities[k] - referenceVelocities[k]));
+      for (int i = 0; i < DIM; ++i)
+        maxDifference = std::max(maxDifference, fabs(momentArms[k*DIM + i] - referenceMomentArms[k*DIM + i]));
+    }
+  }
+  
+  cout << noMuscles << " muscles, n = " << n << ", " << noFrames << " frames\n";
+  cout << std::setw(24) << "" << std::setw(14) << "s per trial" << std::setw(14) << "ns per frame" << endl;
+  cout << std::setw(24) << "separate calls" << std::setw(14) << separateTime << std::setw(14) << separateTime / noFrames * 1e9 << endl;
+  cout << std::setw(24) << "getValueAndGradient" << std::setw(14) << gradientTime << std::setw(14) << gradientTime / noFrames * 1e9 << endl;
+  cout << std::setw(24) << "getTrajectory" << std::setw(14) << trajectoryTime << std::setw(14) << trajectoryTime / noFrames * 1e9 << endl;
+  cout << "Max difference from the separate calls: " << maxDifference << endl;
+  
+  exit(EXIT_SUCCESS);
+}
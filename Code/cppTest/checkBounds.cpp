@@ -0,0 +1,160 @@
+// Copyright (c) 2011, Massimo Sartori and Monica Reggiani
+// All rights reserved.
+
+// Redistribution and use in source and binary forms, with or without 
+// modification, are permitted provided that the following conditions are met:
+// - Redistributions of source code must retain the above copyright notice, 
+//   this list of conditions and the following disclaimer.
+// - Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+
+
+
+#include <iostream>
+using std::cout;
+using std::endl;
+#include <iomanip>
+#include <vector>
+using std::vector;
+#include <algorithm>
+#include <random>
+#include <chrono>
+#include <stdlib.h>
+#include <math.h>
+
+#include "SplineBounds.h"
+#include "Spline.cpp"
+#include "SplineBounds.cpp"
+
+// Bounds of a spline of 4 DOFs, and of its first derivative along the first
+// DOF, over random boxes: the conservative bounds of SplineBounds and the
+// tight ones against the extrema found by sampling each box, in width and
+// time. A sampled value out of the bounds is an error.
+
+const int DIM = 4;
+
+
+double getSeconds(const std::chrono::steady_clock::time_point& start) {
+  std::chrono::duration<double> seconds = std::chrono::steady_clock::now() - start;
+  return seconds.count();
+}
+
+
+int main(int argc, const char* argv[]) {
+  int n = (argc > 1) ? atoi(argv[1]) : 20;
+  int noBoxes = (argc > 2) ? atoi(argv[2]) : 100;
+  int noSamples = (argc > 3) ? atoi(argv[3]) : 12;
+  const double tolerance = (argc > 4) ? atof(argv[4]) : 1e-3;
+  
+  vector<double> a(DIM, 0.), b(DIM, 1.);
+  vector<int> nodes(DIM, n);
+  int noY = 1;
+  for (int i = 0; i < DIM; ++i)
+    noY *= (n+1);
+  vector<double> y(noY);
+  double u[DIM];
+  for (int k = 0; k < noY; ++k) {
+    int rest = k;
+    for (int i = 0; i < DIM; ++i) {
+      u[i] = static_cast<double>(rest % (n+1)) / n;
+      y[k] += sin( (i+2) * u[i] );
+      rest /= (n+1);
+    }
+    // coupled DOFs, so that the extrema are not shared by whole slabs of cells
+    y[k] += sin(3 * u[0] + 2 * u[1]) * cos(2 * u[2] - 3 * u[3]);
+  }
+  Spline<DIM> spline(a, b, nodes);
+  spline.computeCoefficients(y, y.begin());
+  
+  std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+  SplineBounds<DIM> bounds(spline);
+  cout << "SplineBounds built in " << getSeconds(start) << " s, " << bounds.getMemory() / 1e6 << " MB\n";
+  
+  std::mt19937 generator(1);
+  vector<double> lower(DIM), upper(DIM), x(DIM);
+  int noErrors = 0;
+  for (int dimDerivative = -1; dimDerivative <= 0; ++dimDerivative) {
+    double boundsTime = 0, tightTime = 0, samplingTime = 0;
+    double boundsWidth = 0, tightWidth = 0, sampledWidth = 0;
+    for (int box = 0; box < noBoxes; ++box) {
+      const double size = std::uniform_real_distribution<double>(0.01, 1.)(generator);
+      for (int i = 0; i < DIM; ++i) {
+        lower[i] = std::uniform_real_distribution<double>(0., 1. - size)(generator);
+        upper[i] = lower[i] + size;
+      }
+      double minimum, maximum, tightMinimum, tightMaximum;
+      start = std::chrono::steady_clock::now();
+      if (dimDerivative < 0)
+        bounds.getBounds(lower, upper, minimum, maximum);
+      else
+        bounds.getFirstDerivativeBounds(lower, upper, dimDerivative, minimum, maximum);
+      boundsTime += getSeconds(start);
+      start = std::chrono::steady_clock::now();
+      if (dimDerivative < 0)
+        bounds.getTightBounds(lower, upper, tolerance, tightMinimum, tightMaximum);
+      else
+        bounds.getTightFirstDerivativeBounds(lower, upper, dimDerivative, tolerance, tightMinimum, tightMaximum);
+      tightTime += getSeconds(start);
+      
+      start = std::chrono::steady_clock::now();
+      double sampledMinimum = 1e300, sampledMaximum = -1e300;
+      int noPoints = 1;
+      for (int i = 0; i < DIM; ++i)
+        noPoints *= noSamples;
+      for (int p = 0; p < noPoints; ++p) {
+        int rest = p;
+        for (int i = 0; i < DIM; ++i) {
+          x[i] = lower[i] + (upper[i] - lower[i]) * (rest % noSamples) / (noSamples-1);
+          rest /= noSamples;
+        }
+        const double value = (dimDerivative < 0) ? spline.getValue(x) : spline.getFirstDerivative(x, dimDerivative);
+        sampledMinimum = std::min(sampledMinimum, value);
+        sampledMaximum = std::max(sampledMaximum, value);
+      }
+      samplingTime += getSeconds(start);
+      
+      const double roundOff = 1e-9 * (1 + fabs(sampledMaximum) + fabs(sampledMinimum));
+      if ( (sampledMinimum < minimum - roundOff) || (sampledMaximum > maximum + roundOff) 
+           || (sampledMinimum < tightMinimum - roundOff) || (sampledMaximum > tightMaximum + roundOff) )
+        ++noErrors;
+      boundsWidth += maximum - minimum;
+      tightWidth += tightMaximum - tightMinimum;
+      sampledWidth += sampledMaximum - sampledMinimum;
+    }
+    cout << ( (dimDerivative < 0) ? "value" : "first derivative along DOF 0" ) << ", mean over " << noBoxes << " boxes:\n";
+    cout << std::setw(12) << "" << std::setw(14) << "width" << std::setw(14) << "us per box" << endl;
+    cout << std::setw(12) << "bounds" << std::setw(14) << boundsWidth / noBoxes << std::setw(14) << boundsTime / noBoxes * 1e6 << endl;
+    cout << std::setw(12) << "tight" << std::setw(14) << tightWidth / noBoxes << std::setw(14) << tightTime / noBoxes * 1e6 << endl;
+    cout << std::setw(12) << "sampled" << std::setw(14) << sampledWidth / noBoxes << std::setw(14) << samplingTime / noBoxes * 1e6 << endl;
+  }
+  cout << noErrors << " boxes with sampled values out of the bounds\n";
+  
+  // a tolerance far below the round-off must end too, on a box whose
+  // extrema are inside, around a corner and on the whole grid
+  const double boxLower[] = { 0.3, 0.49, 0. }, boxUpper[] = { 0.7, 0.51, 1. };
+  for (int k = 0; k < 3; ++k) {
+    lower.assign(DIM, boxLower[k]);
+    upper.assign(DIM, boxUpper[k]);
+    double tightMinimum, tightMaximum;
+    start = std::chrono::steady_clock::now();
+    bounds.getTightBounds(lower, upper, 1e-300, tightMinimum, tightMaximum);
+    bounds.getTightFirstDerivativeBounds(lower, upper, 0, 1e-300, tightMinimum, tightMaximum);
+    cout << "Tolerance 1e-300 on [" << boxLower[k] << ", " << boxUpper[k] << "]^" << DIM << ": " 
+         << getSeconds(start) * 1e6 << " us\n";
+  }
+  
+  exit(noErrors ? EXIT_FAILURE : EXIT_SUCCESS);
+}
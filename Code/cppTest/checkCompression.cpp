@@ -0,0 +1,207 @@
+// Copyright (c) 2011, Massimo Sartori and Monica Reggiani
+// All rights reserved.
+
+// Redistribution and use in source and binary forms, with or without 
+// modification, are permitted provided that the following conditions are met:
+// - Redistributions of source code must retain the above copyright notice, 
+//   this list of conditions and the following disclaimer.
+// - Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+
+
+
+#include <iostream>
+using std::cout;
+using std::endl;
+#include <fstream>
+using std::ifstream;
+#include <sstream>
+using std::stringstream;
+#include <string>
+using std::string;
+#include <vector>
+using std::vector;
+#include <algorithm>
+#define _USE_MATH_DEFINES
+#include <math.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "Spline.h"
+#include "Spline.cpp"
+#include "SplineCompressed.h"
+#include "SplineCompressed.cpp"
+
+const int N_DOF = 4;
+
+inline double radians (double d) {
+return d * M_PI / 180;
+}
+
+
+// skips the number of rows and the muscle names of an .in file of the data directory
+void openTable(const string& filename, ifstream& file, const int noRows) {
+  file.open(filename.c_str());
+  if (!file.is_open()) {
+    cout << "ERROR: " << filename << " could not be open\n";
+    exit(EXIT_FAILURE);
+  }
+  int numRows;
+  file >> numRows;
+  if (numRows != noRows) {
+    cout << "ERROR: " << filename << " has " << numRows << " rows instead of " << noRows << endl;
+    exit(EXIT_FAILURE);
+  }
+  string line;
+  getline(file, line, '\n'); getline(file, line, '\n');
+}
+
+
+struct Errors {
+  double ofSpline, ofCompressed, compression, bound;
+  Errors() : ofSpline(0.), ofCompressed(0.), compression(0.), bound(0.) { }
+  void add(const double reference, const double spline, const double compressed, const double maxError) {
+    ofSpline = std::max(ofSpline, fabs(spline - reference));
+    ofCompressed = std::max(ofCompressed, fabs(compressed - reference));
+    compression = std::max(compression, fabs(compressed - spline));
+    bound = std::max(bound, maxError);
+  }
+};
+
+
+int main(int argc, const char* argv[])
+{
+  if ( argc < 2 || argc > 3 ) {
+    cout << "Usage: checkCompression dataDirectory [bits]\n";
+    cout << " dataDirectory: directory with data, read README.*\n";
+    cout << " bits: 16 (default) or 8 bits per coefficient\n";
+    exit(EXIT_FAILURE);
+  }
+  SplineQuantization quantization = QUANTIZATION_16_BITS;
+  if ( (argc == 3) && (atoi(argv[2]) == 8) )
+    quantization = QUANTIZATION_8_BITS;
+  else if ( (argc == 3) && (atoi(argv[2]) != 16) ) {
+    cout << "ERROR: " << argv[2] << " bits are not supported\n";
+    exit(EXIT_FAILURE);
+  }
+  
+  string dataDirectory = argv[1];
+  string inputDataFilename = dataDirectory + "InputData/lmt.in";
+  ifstream inputDataFile(inputDataFilename.c_str());
+  if (!inputDataFile.is_open()) {
+    cout << "ERROR: " << inputDataFilename << " could not be open\n";
+    exit(EXIT_FAILURE);
+  }
+  vector<string> dofName(N_DOF);
+  vector<double> a(N_DOF), b(N_DOF);
+  vector<int> n(N_DOF);
+  for (int i = 0; i < N_DOF; ++i) {
+    inputDataFile >> dofName[i] >> a[i] >> b[i] >> n[i];
+    a[i] = radians(a[i]);
+    b[i] = radians(b[i]);
+  }
+  string line, nextMuscleName;
+  getline(inputDataFile, line, '\n'); getline(inputDataFile, line, '\n');
+  stringstream myStream(line);
+  vector<string> muscleNames;
+  while (myStream >> nextMuscleName)
+    muscleNames.push_back(nextMuscleName);
+  const int noMuscles = muscleNames.size();
+  int noInputData = 1;
+  for (int i = 0; i < N_DOF; ++i)
+    noInputData *= n[i] + 1;
+  vector< vector<double> > y(noMuscles, vector<double>(noInputData));
+  for (int j = 0; j < noInputData; ++j)
+    for (int i = 0; i < noMuscles; ++i)
+      inputDataFile >> y[i][j];
+  inputDataFile.close();
+  
+  vector< Spline<N_DOF> > splines;
+  vector< SplineCompressed<N_DOF> > compressedSplines;
+  SplineFitter<N_DOF> fitter(a, b, n);
+  size_t memory = 0, compressedMemory = 0;
+  for (int i = 0; i < noMuscles; ++i) {
+    fitter.computeCoefficients(y[i], y[i].begin());
+    splines.push_back(Spline<N_DOF>(fitter));
+    compressedSplines.push_back(SplineCompressed<N_DOF>(splines.back(), quantization));
+    memory += fitter.getCoefficients().size() * sizeof(double);
+    compressedMemory += compressedSplines.back().getMemory();
+  }
+  
+  // the references on the nodes
+  string evalDataDir = dataDirectory + "NodesData/";
+  ifstream anglesFile((evalDataDir + "angles.in").c_str());
+  if (!anglesFile.is_open()) {
+    cout << "ERROR: " << evalDataDir << "angles.in could not be open\n";
+    exit(EXIT_FAILURE);
+  }
+  int noEvalData;
+  anglesFile >> noEvalData;
+  vector< vector<double> > angles(noEvalData, vector<double>(N_DOF));
+  for (int k = 0; k < noEvalData; ++k)
+    for (int i = N_DOF-1; i >= 0; --i) {
+      anglesFile >> angles[k][i];
+      angles[k][i] = radians(angles[k][i]);
+    }
+  anglesFile.close();
+  
+  bool withinBounds = true;
+  cout << "Compression with " << (quantization == QUANTIZATION_16_BITS ? 16 : 8) << " bits per coefficient\n";
+  cout << "Memory: " << compressedMemory << " bytes instead of " << memory << endl;
+  cout << "Maximum errors on NodesData\n";
+  cout << "value\tspline\tcompressed\tcompression\tguaranteed\n";
+  for (int d = -1; d < N_DOF; ++d) {
+    // lmt first, then the moment arms ma = -dlmt/dq
+    string name = (d < 0) ? string("lmt") : "ma" + dofName[d];
+    ifstream referenceFile;
+    openTable(evalDataDir + name + ".in", referenceFile, noEvalData);
+    Errors errors;
+    double reference;
+    for (int k = 0; k < noEvalData; ++k)
+      for (int i = 0; i < noMuscles; ++i) {
+        referenceFile >> reference;
+        if (d < 0)
+          errors.add(reference, splines[i].getValue(angles[k]), compressedSplines[i].getValue(angles[k]),
+                     compressedSplines[i].getMaxValueError());
+        else
+          errors.add(reference, -splines[i].getFirstDerivative(angles[k], d),
+                     -compressedSplines[i].getFirstDerivative(angles[k], d),
+                     compressedSplines[i].getMaxFirstDerivativeError(d));
+      }
+    referenceFile.close();
+    cout << name << "\t" << errors.ofSpline << "\t" << errors.ofCompressed << "\t"
+         << errors.compression << "\t" << errors.bound << endl;
+    withinBounds = withinBounds && (errors.compression <= errors.bound);
+  }
+  
+  double sum = 0.;
+  clock_t start = clock();
+  for (int k = 0; k < noEvalData; ++k)
+    for (int i = 0; i < noMuscles; ++i)
+      sum += splines[i].getValue(angles[k]);
+  double splineTime = static_cast<double>(clock() - start) / CLOCKS_PER_SEC;
+  start = clock();
+  for (int k = 0; k < noEvalData; ++k)
+    for (int i = 0; i < noMuscles; ++i)
+      sum -= compressedSplines[i].getValue(angles[k]);
+  double compressedTime = static_cast<double>(clock() - start) / CLOCKS_PER_SEC;
+  cout << "Evaluation time: " << compressedTime / (noEvalData * noMuscles) * 1e9 << " ns per muscle and pose instead of "
+       << splineTime / (noEvalData * noMuscles) * 1e9 << " (checksum " << sum << ")\n";
+  
+  if (!withinBounds)
+    cout << "ERROR: the compression error exceeds its guaranteed bound\n";
+  exit(withinBounds ? EXIT_SUCCESS : EXIT_FAILURE);
+}
@@ -0,0 +1,145 @@
+// Copyright (c) 2011, Massimo Sartori and Monica Reggiani
+// All rights reserved.
+
+// Redistribution and use in source and binary forms, with or without 
+// modification, are permitted provided that the following conditions are met:
+// - Redistributions of source code must retain the above copyright notice, 
+//   this list of conditions and the following disclaimer.
+// - Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+
+
+#include <iostream>
+using std::cout;
+using std::endl;
+#include <vector>
+using std::vector;
+#include <algorithm>
+#include <random>
+#include <stdlib.h>
+#include <math.h>
+
+#include "Spline.h"
+#include "Spline.cpp"
+
+// getSplineWithFixedDofs against the full spline: 1, 2 and 3 DOFs of a
+// spline of 4 DOFs are locked at random values, and the reduced spline is
+// compared with the full one, in value and first derivatives, at random
+// poses of the remaining DOFs. 3 locked DOFs give a Spline<1>.
+
+const int DIM = 4;
+const double TOLERANCE = 1e-12;
+
+
+template <int order>
+double getValueOf(const Spline<1, order>& spline, const vector<double>& x) {
+  return spline.getValue(x[0]);
+}
+
+template <int order>
+double getFirstDerivativeOf(const Spline<1, order>& spline, const vector<double>& x, const int) {
+  return spline.getFirstDerivative(x[0]);
+}
+
+template <int dim, int order>
+double getValueOf(const Spline<dim, order>& spline, const vector<double>& x) {
+  return spline.getValue(x);
+}
+
+template <int dim, int order>
+double getFirstDerivativeOf(const Spline<dim, order>& spline, const vector<double>& x, const int dimDerivative) {
+  return spline.getFirstDerivative(x, dimDerivative);
+}
+
+
+template <int remainingDim, int order>
+double checkFixedDofs(const Spline<DIM, order>& spline, const vector<int>& fixedDofs, const int noPoses,
+                      const vector<double>& a, const vector<double>& b, std::mt19937& generator) {
+  vector<double> fixedValues(fixedDofs.size());
+  for (unsigned int k = 0; k < fixedDofs.size(); ++k)
+    fixedValues[k] = std::uniform_real_distribution<double>(a[fixedDofs[k]], b[fixedDofs[k]])(generator);
+  Spline<remainingDim, order> reduced = spline.template getSplineWithFixedDofs<remainingDim>(fixedDofs, fixedValues);
+  
+  vector<int> remainingDofs;
+  for (int i = 0; i < DIM; ++i)
+    if (std::find(fixedDofs.begin(), fixedDofs.end(), i) == fixedDofs.end())
+      remainingDofs.push_back(i);
+  
+  vector<double> x(DIM), reducedX(remainingDim);
+  for (unsigned int k = 0; k < fixedDofs.size(); ++k)
+    x[fixedDofs[k]] = fixedValues[k];
+  double maxDifference = 0;
+  for (int p = 0; p < noPoses; ++p) {
+    for (int i = 0; i < remainingDim; ++i) {
+      reducedX[i] = std::uniform_real_distribution<double>(a[remainingDofs[i]], b[remainingDofs[i]])(generator);
+      x[remainingDofs[i]] = reducedX[i];
+    }
+    maxDifference = std::max(maxDifference, fabs(getValueOf(reduced, reducedX) - spline.getValue(x)));
+    for (int i = 0; i < remainingDim; ++i)
+      maxDifference = std::max(maxDifference, fabs(getFirstDerivativeOf(reduced, reducedX, i)
+                                                   - spline.getFirstDerivative(x, remainingDofs[i])));
+  }
+  return maxDifference;
+}
+
+
+template <int order>
+bool checkOrder(const int noPoses, std::mt19937& generator) {
+  const char* layoutNames[] = { "row-major", "tiled", "Morton" };
+  const SplineCoefficientLayout layouts[] = { ROW_MAJOR_LAYOUT, TILED_LAYOUT, MORTON_LAYOUT };
+  const int nodes[DIM] = { 6, 8, 5, 7 };
+  vector<double> a(DIM), b(DIM);
+  vector<int> n(nodes, nodes + DIM);
+  int noY = 1;
+  for (int i = 0; i < DIM; ++i) {
+    a[i] = -0.5 * (i+1);
+    b[i] = 0.7 * (i+1);
+    noY *= n[i] + 1;
+  }
+  vector<double> y(noY);
+  for (int k = 0; k < noY; ++k)
+    y[k] = std::uniform_real_distribution<double>(-1., 1.)(generator);
+  
+  bool failed = false;
+  for (int l = 0; l < 3; ++l) {
+    Spline<DIM, order> spline(a, b, n);
+    spline.computeCoefficients(y, y.begin());
+    spline.setLayout(layouts[l]);
+    // the locked DOFs are not in increasing order on purpose
+    double differences[] = { checkFixedDofs<3>(spline, vector<int>(1, 2), noPoses, a, b, generator),
+                             checkFixedDofs<2>(spline, vector<int>({ 3, 0 }), noPoses, a, b, generator),
+                             checkFixedDofs<1>(spline, vector<int>({ 1, 3, 0 }), noPoses, a, b, generator) };
+    for (int k = 0; k < 3; ++k) {
+      cout << "Order " << order << ", " << layoutNames[l] << ", " << k+1 << " fixed DOFs: max difference "
+           << differences[k] << endl;
+      failed = failed || !(differences[k] <= TOLERANCE);
+    }
+  }
+  return !failed;
+}
+
+
+int main(int argc, const char* argv[]) {
+  int noPoses = (argc > 1) ? atoi(argv[1]) : 1000;
+  std::mt19937 generator(1);
+  
+  bool passed = checkOrder<3>(noPoses, generator);
+  passed = checkOrder<4>(noPoses, generator) && passed;
+  passed = checkOrder<5>(noPoses, generator) && passed;
+  cout << (passed ? "All checks passed\n" : "The reduced spline differs from the full one\n");
+  
+  exit(passed ? EXIT_SUCCESS : EXIT_FAILURE);
+}
@@ -0,0 +1,126 @@
+// Copyright (c) 2011, Massimo Sartori and Monica Reggiani
+// All rights reserved.
+
+// Redistribution and use in source and binary forms, with or without 
+// modification, are permitted provided that the following conditions are met:
+// - Redistributions of source code must retain the above copyright notice, 
+//   this list of conditions and the following disclaimer.
+// - Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+
+
+
+#include <iostream>
+using std::cout;
+using std::endl;
+#include <vector>
+using std::vector;
+#include <algorithm>
+#include <random>
+#include <stdlib.h>
+#include <math.h>
+
+#include "Spline.h"
+#include "SplineLeastSquaresFitter.h"
+#include "Spline.cpp"
+#include "SplineLeastSquaresFitter.cpp"
+
+// SplineLeastSquaresFitter on scattered samples of a known spline of 2 DOFs
+// on the same grid: with samples all over the grid and a small
+// regularization it must find the spline again; without regularization and
+// with samples in a corner only, it must stay finite and fit the samples.
+
+const int DIM = 2;
+
+
+double getFunction(const vector<double>& x) {
+  return sin(2 * x[0] + x[1]) + x[0] * x[1];
+}
+
+
+int main(int argc, const char* argv[]) {
+  int n = (argc > 1) ? atoi(argv[1]) : 10;
+  int noSamples = (argc > 2) ? atoi(argv[2]) : 2000;
+  
+  vector<double> a(DIM, -1.), b(DIM, 1.);
+  vector<int> nodes(DIM, n);
+  int noY = 1;
+  for (int i = 0; i < DIM; ++i)
+    noY *= (n+1);
+  vector<double> y(noY), x(DIM);
+  for (int k = 0; k < noY; ++k) {
+    int rest = k;
+    for (int i = 0; i < DIM; ++i) {
+      x[i] = a[i] + (rest % (n+1)) * (b[i] - a[i]) / n;
+      rest /= (n+1);
+    }
+    y[k] = getFunction(x);
+  }
+  Spline<DIM> known(a, b, nodes);
+  known.computeCoefficients(y, y.begin());
+  
+  std::mt19937 generator(1);
+  vector< vector<double> > samples(noSamples, vector<double>(DIM));
+  SplineLeastSquaresFitter<DIM> fitter(a, b, nodes);
+  for (int s = 0; s < noSamples; ++s) {
+    for (int i = 0; i < DIM; ++i)
+      samples[s][i] = std::uniform_real_distribution<double>(a[i], b[i])(generator);
+    fitter.addSample(samples[s], known.getValue(samples[s]));
+  }
+  fitter.setRegularization(1e-12);
+  fitter.setTolerance(1e-12);
+  fitter.setMaxIterations(10000);
+  Spline<DIM> fitted(a, b, nodes);
+  fitter.computeCoefficients(fitted);
+  
+  double maxDifference = 0;
+  for (int p = 0; p < 10000; ++p) {
+    for (int i = 0; i < DIM; ++i)
+      x[i] = std::uniform_real_distribution<double>(a[i], b[i])(generator);
+    maxDifference = std::max(maxDifference, fabs(fitted.getValue(x) - known.getValue(x)));
+  }
+  cout << noSamples << " samples all over the grid, lambda 1e-12: " << fitter.getNumberOfIterations() 
+       << " iterations, max difference from the known spline " << maxDifference << endl;
+  bool failed = !(maxDifference <= 1e-6);
+  
+  // samples in the corner [a, a + (b-a)/4] only, no regularization
+  SplineLeastSquaresFitter<DIM> cornerFitter(a, b, nodes);
+  for (int s = 0; s < noSamples; ++s) {
+    for (int i = 0; i < DIM; ++i)
+      samples[s][i] = std::uniform_real_distribution<double>(a[i], a[i] + (b[i] - a[i]) / 4)(generator);
+    cornerFitter.addSample(samples[s], known.getValue(samples[s]));
+  }
+  cornerFitter.setRegularization(0);
+  cornerFitter.setTolerance(1e-12);
+  cornerFitter.setMaxIterations(10000);
+  Spline<DIM> cornerFitted(a, b, nodes);
+  cornerFitter.computeCoefficients(cornerFitted);
+  
+  double maxSampleError = 0;
+  for (int s = 0; s < noSamples; ++s)
+    maxSampleError = std::max(maxSampleError, fabs(cornerFitted.getValue(samples[s]) - known.getValue(samples[s])));
+  vector<double> c = cornerFitted.getCoefficients();
+  bool finite = true;
+  for (unsigned int k = 0; k < c.size(); ++k)
+    finite = finite && (c[k] == c[k]) && (fabs(c[k]) < 1e300);
+  cout << noSamples << " samples in a corner, lambda 0: " << cornerFitter.getNumberOfIterations() 
+       << " iterations, " << (finite ? "finite" : "non-finite") << " coefficients, max error on the samples " 
+       << maxSampleError << endl;
+  failed = failed || !finite || !(maxSampleError <= 1e-6);
+  
+  cout << (failed ? "Some checks failed\n" : "All checks passed\n");
+  exit(failed ? EXIT_FAILURE : EXIT_SUCCESS);
+}
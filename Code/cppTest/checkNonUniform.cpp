@@ -0,0 +1,171 @@
+// Copyright (c) 2011, Massimo Sartori and Monica Reggiani
+// All rights reserved.
+
+// Redistribution and use in source and binary forms, with or without 
+// modification, are permitted provided that the following conditions are met:
+// - Redistributions of source code must retain the above copyright notice, 
+//   this list of conditions and the following disclaimer.
+// - Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+
+
+
+#include <iostream>
+using std::cout;
+using std::endl;
+#include <vector>
+using std::vector;
+#include <algorithm>
+#include <random>
+#include <stdlib.h>
+#include <math.h>
+
+#include "Spline.h"
+#include "NonUniformSpline.h"
+#include "Spline.cpp"
+#include "NonUniformSpline.cpp"
+
+// NonUniformSpline against Spline<dim> on uniform nodes, in value and first
+// derivatives at random poses, and its interpolation of the data on
+// non-uniform nodes, with the derivatives against central differences, also
+// with clustered nodes.
+
+const int DIM = 3;
+const double TOLERANCE = 1e-10;
+
+
+double getFunction(const vector<double>& x) {
+  return sin(2 * x[0] + x[1]) * cos(x[2]) + x[0] * x[1] * x[2];
+}
+
+
+// values of getFunction on all the combinations of the nodes, first DOF fastest
+vector<double> sample(const vector< vector<double> >& nodes) {
+  int noY = 1;
+  for (int i = 0; i < DIM; ++i)
+    noY *= nodes[i].size();
+  vector<double> y(noY), x(DIM);
+  for (int k = 0; k < noY; ++k) {
+    int rest = k;
+    for (int i = 0; i < DIM; ++i) {
+      x[i] = nodes[i][rest % nodes[i].size()];
+      rest /= nodes[i].size();
+    }
+    y[k] = getFunction(x);
+  }
+  return y;
+}
+
+
+int main(int argc, const char* argv[]) {
+  int n = (argc > 1) ? atoi(argv[1]) : 10;
+  int noPoses = (argc > 2) ? atoi(argv[2]) : 1000;
+  std::mt19937 generator(1);
+  bool failed = false;
+  
+  // uniform nodes
+  vector<double> a(DIM, -1.), b(DIM, 1.5);
+  vector<int> intervals(DIM, n);
+  vector< vector<double> > nodes(DIM, vector<double>(n+1));
+  for (int i = 0; i < DIM; ++i)
+    for (int k = 0; k <= n; ++k)
+      nodes[i][k] = (k == n) ? b[i] : a[i] + k * (b[i] - a[i]) / n;
+  vector<double> y = sample(nodes);
+  Spline<DIM> spline(a, b, intervals);
+  spline.computeCoefficients(y, y.begin());
+  NonUniformSpline<DIM> nonUniform(nodes);
+  nonUniform.computeCoefficients(y, y.begin());
+  
+  vector<double> x(DIM);
+  double maxValueDifference = 0, maxDerivativeDifference = 0;
+  for (int p = 0; p < noPoses; ++p) {
+    for (int i = 0; i < DIM; ++i)
+      x[i] = std::uniform_real_distribution<double>(a[i], b[i])(generator);
+    maxValueDifference = std::max(maxValueDifference, fabs(nonUniform.getValue(x) - spline.getValue(x)));
+    for (int i = 0; i < DIM; ++i)
+      maxDerivativeDifference = std::max(maxDerivativeDifference, 
+                                         fabs(nonUniform.getFirstDerivative(x, i) - spline.getFirstDerivative(x, i)));
+  }
+  cout << "Uniform nodes, max difference from Spline<" << DIM << ">: " << maxValueDifference << " in value, "
+       << maxDerivativeDifference << " in first derivatives\n";
+  failed = failed || !(maxValueDifference <= TOLERANCE) || !(maxDerivativeDifference <= TOLERANCE);
+  
+  // non-uniform nodes: random spacings between 0.2 and 1 of the largest
+  for (int i = 0; i < DIM; ++i) {
+    nodes[i][0] = a[i];
+    for (int k = 1; k <= n; ++k)
+      nodes[i][k] = nodes[i][k-1] + std::uniform_real_distribution<double>(0.2, 1.)(generator);
+    for (int k = 1; k <= n; ++k)
+      nodes[i][k] = a[i] + (nodes[i][k] - a[i]) * (b[i] - a[i]) / (nodes[i][n] - a[i]);
+    nodes[i][n] = b[i];
+  }
+  y = sample(nodes);
+  NonUniformSpline<DIM> interpolant(nodes);
+  interpolant.computeCoefficients(y, y.begin());
+  
+  double maxNodeError = 0;
+  for (unsigned int k = 0; k < y.size(); ++k) {
+    int rest = k;
+    for (int i = 0; i < DIM; ++i) {
+      x[i] = nodes[i][rest % (n+1)];
+      rest /= (n+1);
+    }
+    maxNodeError = std::max(maxNodeError, fabs(interpolant.getValue(x) - y[k]));
+  }
+  cout << "Non-uniform nodes, max error on the nodes: " << maxNodeError << endl;
+  failed = failed || !(maxNodeError <= TOLERANCE);
+  
+  const double step = 1e-6;
+  double maxDifferenceFromCentral = 0;
+  for (int p = 0; p < noPoses; ++p) {
+    for (int i = 0; i < DIM; ++i)
+      x[i] = std::uniform_real_distribution<double>(a[i] + step, b[i] - step)(generator);
+    for (int i = 0; i < DIM; ++i) {
+      vector<double> forward(x), backward(x);
+      forward[i] += step;
+      backward[i] -= step;
+      const double central = (interpolant.getValue(forward) - interpolant.getValue(backward)) / (2 * step);
+      maxDifferenceFromCentral = std::max(maxDifferenceFromCentral, fabs(interpolant.getFirstDerivative(x, i) - central));
+    }
+  }
+  cout << "Non-uniform nodes, max difference of the first derivatives from central differences: " 
+       << maxDifferenceFromCentral << endl;
+  failed = failed || !(maxDifferenceFromCentral <= 1e-6);
+  
+  // clustered nodes: a few nodes 1e-9 apart on each axis, that would ask
+  // for billions of buckets of the smallest interval; the values on the
+  // nodes must still be found in their intervals
+  for (int i = 0; i < DIM; ++i)
+    for (int k = 2; k <= 4 && k < n; ++k)
+      nodes[i][k] = nodes[i][1] + (k-1) * 1e-9;
+  y = sample(nodes);
+  NonUniformSpline<DIM> clustered(nodes);
+  clustered.computeCoefficients(y, y.begin());
+  double maxClusteredError = 0;
+  for (unsigned int k = 0; k < y.size(); ++k) {
+    int rest = k;
+    for (int i = 0; i < DIM; ++i) {
+      x[i] = nodes[i][rest % (n+1)];
+      rest /= (n+1);
+    }
+    maxClusteredError = std::max(maxClusteredError, fabs(clustered.getValue(x) - y[k]));
+  }
+  cout << "Clustered nodes, max error on the nodes: " << maxClusteredError << endl;
+  failed = failed || !(maxClusteredError <= 1e-6);
+  
+  cout << (failed ? "Some checks failed\n" : "All checks passed\n");
+  exit(failed ? EXIT_FAILURE : EXIT_SUCCESS);
+}
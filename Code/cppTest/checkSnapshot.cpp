@@ -0,0 +1,201 @@
+// Copyright (c) 2011, Massimo Sartori and Monica Reggiani
+// All rights reserved.
+
+// Redistribution and use in source and binary forms, with or without 
+// modification, are permitted provided that the following conditions are met:
+// - Redistributions of source code must retain the above copyright notice, 
+//   this list of conditions and the following disclaimer.
+// - Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+
+#include <iostream>
+using std::cout;
+using std::endl;
+#include <vector>
+using std::vector;
+#include <string>
+using std::string;
+#include <atomic>
+#include <thread>
+#include <random>
+#include <chrono>
+#include <stdlib.h>
+#include <math.h>
+
+#include "SplineSet.h"
+#include "SnapshotHolder.h"
+#include "Spline.cpp"
+#include "SplineSet.cpp"
+#include "SnapshotHolder.cpp"
+#include "SyntheticModel.h"
+
+// The hot reload of SnapshotHolder under concurrent readers: reader threads
+// evaluate all the muscles through the holder while a writer publishes new
+// SplineSets, the lengths of generation g shifted by g * SHIFT. Every read
+// must find the same shift on all the muscles, that of the generation it
+// acquired (a complete snapshot), and a generation must be deleted only
+// when no reader holds it, and then once.
+
+const int DIM = 4;
+const int MAX_GENERATIONS = 10000;
+const double SHIFT = 1e-2;
+const double TOLERANCE = 1e-9;
+
+// the readers holding each generation, and whether it was deleted
+std::atomic<int> holding[MAX_GENERATIONS];
+std::atomic<int> deleted[MAX_GENERATIONS];
+std::atomic<int> deletedWhileHeld(0);
+
+
+class Snapshot : public SplineSet<DIM> {
+  private:
+    int generation_;
+    
+  public:
+    Snapshot(const vector<double>& a, const vector<double>& b, const vector<int>& n,
+             const vector<string>& muscleNames, const vector< vector<double> >& y, const int generation)
+    :SplineSet<DIM>(a, b, n, muscleNames, y), generation_(generation) { }
+    ~Snapshot() {
+      if (holding[generation_].load() != 0)
+        ++deletedWhileHeld;
+      ++deleted[generation_];
+    }
+    int getGeneration() const { return generation_; }
+};
+
+
+Snapshot* build(const SyntheticModel& model, const vector<double>& a, const vector<double>& b,
+                const vector<int>& n, const int generation) {
+  vector<string> muscleNames;
+  vector< vector<double> > y(model.getNumberOfMuscles());
+  for (int m = 0; m < model.getNumberOfMuscles(); ++m) {
+    muscleNames.push_back(model.getMuscleName(m));
+    model.getNodeValues(m, a, b, n, y[m]);
+    for (unsigned int k = 0; k < y[m].size(); ++k)
+      y[m][k] += generation * SHIFT;
+  }
+  return new Snapshot(a, b, n, muscleNames, y, generation);
+}
+
+
+struct ReaderResult {
+  long noReads;
+  long noIncomplete;
+  long noFreed;
+  long noBackwards;
+  int lastGeneration;
+};
+
+
+void read(SnapshotHolder<Snapshot>& holder, const Snapshot& reference, const vector<double>& a,
+          const vector<double>& b, const int seed, const std::atomic<bool>& stop, ReaderResult& result) {
+  std::mt19937 generator(seed);
+  std::uniform_real_distribution<double> uniform(0., 1.);
+  SnapshotHolder<Snapshot>::Reader reader(holder);
+  vector<double> x(DIM), values, referenceValues;
+  result.noReads = result.noIncomplete = result.noFreed = result.noBackwards = 0;
+  result.lastGeneration = 0;
+  while (!stop.load()) {
+    for (int i = 0; i < DIM; ++i)
+      x[i] = a[i] + (b[i] - a[i]) * uniform(generator);
+    reference.getValues(x, referenceValues);
+    
+    const Snapshot* snapshot = reader.acquire();
+    const int generation = snapshot->getGeneration();
+    ++holding[generation];
+    if (deleted[generation].load() != 0)
+      ++result.noFreed;
+    snapshot->getValues(x, values);
+    for (unsigned int m = 0; m < values.size(); ++m)
+      if (fabs(values[m] - referenceValues[m] - generation * SHIFT) > TOLERANCE) {
+        ++result.noIncomplete;
+        break;
+      }
+    if (generation < result.lastGeneration)
+      ++result.noBackwards;
+    result.lastGeneration = generation;
+    --holding[generation];
+    reader.release();
+    ++result.noReads;
+  }
+}
+
+
+int main(int argc, const char* argv[]) {
+  int noReaders = (argc > 1) ? atoi(argv[1]) : 4;
+  int noGenerations = (argc > 2) ? atoi(argv[2]) : 200;
+  int n = (argc > 3) ? atoi(argv[3]) : 6;
+  const int noMuscles = 8;
+  if (noGenerations < 2 || noGenerations >= MAX_GENERATIONS) {
+    cout << "The number of generations must be between 2 and " << MAX_GENERATIONS - 1 << endl;
+    exit(EXIT_FAILURE);
+  }
+  for (int g = 0; g < MAX_GENERATIONS; ++g) {
+    holding[g].store(0);
+    deleted[g].store(0);
+  }
+  
+  SyntheticModel model(DIM, noMuscles);
+  vector<double> a(DIM, 0.), b(DIM, 1.);
+  vector<int> nodes(DIM, n);
+  Snapshot* reference = build(model, a, b, nodes, 0);
+  
+  bool failed = false;
+  int noRetiredAtEnd;
+  vector<ReaderResult> results(noReaders);
+  std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+  {
+    SnapshotHolder<Snapshot> holder(build(model, a, b, nodes, 1), noReaders);
+    std::atomic<bool> stop(false);
+    vector<std::thread> readers;
+    for (int r = 0; r < noReaders; ++r)
+      readers.push_back(std::thread(read, std::ref(holder), std::cref(*reference), std::cref(a), std::cref(b),
+                                    r + 1, std::cref(stop), std::ref(results[r])));
+    // the writer, building each generation while the readers use the last one
+    for (int g = 2; g < noGenerations; ++g)
+      holder.publish(build(model, a, b, nodes, g));
+    stop.store(true);
+    for (int r = 0; r < noReaders; ++r)
+      readers[r].join();
+    
+    // without readers, a publish frees all the retired snapshots
+    holder.publish(build(model, a, b, nodes, noGenerations));
+    noRetiredAtEnd = holder.getNumberOfRetired();
+    for (int g = 1; g < noGenerations; ++g)
+      failed = failed || (deleted[g].load() != 1);
+  }
+  std::chrono::duration<double> seconds = std::chrono::steady_clock::now() - start;
+  delete reference;
+  
+  long noReads = 0, noIncomplete = 0, noFreed = 0, noBackwards = 0;
+  for (int r = 0; r < noReaders; ++r) {
+    noReads += results[r].noReads;
+    noIncomplete += results[r].noIncomplete;
+    noFreed += results[r].noFreed;
+    noBackwards += results[r].noBackwards;
+  }
+  cout << noReaders << " readers, " << noGenerations << " generations of " << noMuscles << " splines with n = " << n
+       << " in " << seconds.count() << " s: " << noReads << " reads\n";
+  cout << "Incomplete snapshots: " << noIncomplete << ", deleted snapshots read: " << noFreed
+       << ", generations going backwards: " << noBackwards << endl;
+  cout << "Snapshots deleted while held: " << deletedWhileHeld.load() << ", retired after the last publish: "
+       << noRetiredAtEnd << endl;
+  failed = failed || (noIncomplete > 0) || (noFreed > 0) || (noBackwards > 0) || (deletedWhileHeld.load() > 0)
+           || (noRetiredAtEnd != 0) || (deleted[noGenerations].load() != 1);
+  
+  cout << (failed ? "Some checks failed\n" : "All checks passed\n");
+  exit(failed ? EXIT_FAILURE : EXIT_SUCCESS);
+}
@@ -0,0 +1,101 @@
+// Copyright (c) 2011, Massimo Sartori and Monica Reggiani
+// All rights reserved.
+
+// Redistribution and use in source and binary forms, with or without 
+// modification, are permitted provided that the following conditions are met:
+// - Redistributions of source code must retain the above copyright notice, 
+//   this list of conditions and the following disclaimer.
+// - Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+
+
+
+#include <iostream>
+using std::cout;
+using std::endl;
+#include <iomanip>
+#include <vector>
+using std::vector;
+#include <algorithm>
+#include <random>
+#include <stdlib.h>
+#include <math.h>
+
+#include "SparseGridSpline.h"
+#include "Spline.cpp"
+#include "SparseGridSpline.cpp"
+
+// SparseGridSpline fitted on an analytic function of 3 DOFs at increasing
+// levels: it must interpolate the values on its own nodes (all of them
+// inside [a, b], so that they can be evaluated), and its error on random
+// poses is reported against the number of nodes.
+
+const int DIM = 3;
+const double TOLERANCE = 1e-10;
+
+
+double getFunction(const vector<double>& x) {
+  return exp(0.5 * x[0]) * sin(x[1] + 2 * x[2]);
+}
+
+
+int main(int argc, const char* argv[]) {
+  int maxLevel = (argc > 1) ? atoi(argv[1]) : 4;
+  int noPoses = (argc > 2) ? atoi(argv[2]) : 10000;
+  
+  // b not a multiple of the node spacing, so that a + k*h can round past it
+  vector<double> a(DIM, -1.), b(DIM, 1.2);
+  std::mt19937 generator(1);
+  vector< vector<double> > poses(noPoses, vector<double>(DIM));
+  for (int p = 0; p < noPoses; ++p)
+    for (int i = 0; i < DIM; ++i)
+      poses[p][i] = std::uniform_real_distribution<double>(a[i], b[i])(generator);
+  
+  bool failed = false;
+  cout << std::setw(8) << "level" << std::setw(10) << "nodes" << std::setw(14) << "coefficients" 
+       << std::setw(16) << "error on nodes" << std::setw(16) << "error on poses" << endl;
+  for (int level = 0; level <= maxLevel; ++level) {
+    SparseGridSpline<DIM> spline(a, b, level);
+    vector<double> y(spline.getNumberOfNodes()), x;
+    bool inside = true;
+    for (int k = 0; k < spline.getNumberOfNodes(); ++k) {
+      spline.getNode(k, x);
+      for (int i = 0; i < DIM; ++i)
+        inside = inside && (x[i] >= a[i]) && (x[i] <= b[i]);
+      y[k] = getFunction(x);
+    }
+    if (!inside) {
+      cout << "Level " << level << " has nodes out of [a, b]\n";
+      exit(EXIT_FAILURE);
+    }
+    spline.computeCoefficients(y, y.begin());
+    
+    double nodeError = 0;
+    for (int k = 0; k < spline.getNumberOfNodes(); ++k) {
+      spline.getNode(k, x);
+      nodeError = std::max(nodeError, fabs(spline.getValue(x) - y[k]));
+    }
+    double poseError = 0;
+    for (int p = 0; p < noPoses; ++p)
+      poseError = std::max(poseError, fabs(spline.getValue(poses[p]) - getFunction(poses[p])));
+    cout << std::setw(8) << level << std::setw(10) << spline.getNumberOfNodes() << std::setw(14) 
+         << spline.getNumberOfCoefficients() << std::setw(16) << nodeError << std::setw(16) << poseError << endl;
+    failed = failed || !(nodeError <= TOLERANCE);
+  }
+  cout << (failed ? "The sparse grid does not interpolate its nodes\n" : "All checks passed\n");
+  
+  exit(failed ? EXIT_FAILURE : EXIT_SUCCESS);
+}
@@ -0,0 +1,169 @@
+// Copyright (c) 2011, Massimo Sartori and Monica Reggiani
+// All rights reserved.
+
+// Redistribution and use in source and binary forms, with or without 
+// modification, are permitted provided that the following conditions are met:
+// - Redistributions of source code must retain the above copyright notice, 
+//   this list of conditions and the following disclaimer.
+// - Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+
+
+
+#include <iostream>
+using std::cout;
+using std::endl;
+#include <vector>
+using std::vector;
+#include <algorithm>
+#include <random>
+#include <chrono>
+#include <stdlib.h>
+#include <math.h>
+
+#include "Spline.h"
+#include "Spline.cpp"
+
+// updateCoefficients against a full refit: a few random nodes of a spline
+// of 1 and of 3 DOFs are changed, the coefficients updated and compared
+// with the ones of the new values fitted from scratch. Then the cost of an
+// update per changed node against a refit, with tolerances that skip the
+// small terms, whose error must stay about the tolerance.
+
+const int DIM = 3;
+const double TOLERANCE = 1e-12;
+
+
+template <int order>
+double checkOneDof(const int n, const int noChanges, std::mt19937& generator) {
+  vector<double> y(n+1);
+  for (int k = 0; k <= n; ++k)
+    y[k] = sin(3. * k / n);
+  Spline<1, order> updated(0., 1., n);
+  updated.computeCoefficients(y, y.begin());
+  
+  vector<int> changedNodes(noChanges);
+  vector<double> deltaY(noChanges);
+  for (int k = 0; k < noChanges; ++k) {
+    // distinct nodes: updateCoefficients adds one response per entry
+    do
+      changedNodes[k] = std::uniform_int_distribution<int>(0, n)(generator);
+    while (std::find(changedNodes.begin(), changedNodes.begin() + k, changedNodes[k]) != changedNodes.begin() + k);
+    deltaY[k] = std::uniform_real_distribution<double>(-1., 1.)(generator);
+    y[changedNodes[k]] += deltaY[k];
+  }
+  updated.updateCoefficients(changedNodes, deltaY);
+  Spline<1, order> refitted(0., 1., n);
+  refitted.computeCoefficients(y, y.begin());
+  
+  double maxDifference = 0;
+  for (int p = 0; p <= 10 * n; ++p) {
+    const double x = static_cast<double>(p) / (10 * n);
+    maxDifference = std::max(maxDifference, fabs(updated.getValue(x) - refitted.getValue(x)));
+  }
+  return maxDifference;
+}
+
+
+// the times of the update and of the refit are returned in seconds
+template <int order>
+double checkDofs(const int n, const int noChanges, const SplineCoefficientLayout layout, std::mt19937& generator,
+                 const double tolerance = 0., double* updateTime = NULL, double* refitTime = NULL) {
+  vector<double> a(DIM, 0.), b(DIM, 1.);
+  vector<int> nodes(DIM, n);
+  int noY = 1;
+  for (int i = 0; i < DIM; ++i)
+    noY *= (n+1);
+  vector<double> y(noY);
+  for (int k = 0; k < noY; ++k) {
+    int rest = k;
+    for (int i = 0; i < DIM; ++i) {
+      y[k] += sin( (i+2) * static_cast<double>(rest % (n+1)) / n );
+      rest /= (n+1);
+    }
+  }
+  Spline<DIM, order> updated(a, b, nodes);
+  updated.computeCoefficients(y, y.begin());
+  updated.setLayout(layout);
+  
+  vector<int> changedNodes(noChanges);
+  vector<double> deltaY(noChanges);
+  for (int k = 0; k < noChanges; ++k) {
+    do
+      changedNodes[k] = std::uniform_int_distribution<int>(0, noY-1)(generator);
+    while (std::find(changedNodes.begin(), changedNodes.begin() + k, changedNodes[k]) != changedNodes.begin() + k);
+    deltaY[k] = std::uniform_real_distribution<double>(-1., 1.)(generator);
+    y[changedNodes[k]] += deltaY[k];
+  }
+  std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+  updated.updateCoefficients(changedNodes, deltaY, tolerance);
+  std::chrono::duration<double> seconds = std::chrono::steady_clock::now() - start;
+  if (updateTime)
+    *updateTime = seconds.count();
+  Spline<DIM, order> refitted(a, b, nodes);
+  start = std::chrono::steady_clock::now();
+  refitted.computeCoefficients(y, y.begin());
+  seconds = std::chrono::steady_clock::now() - start;
+  if (refitTime)
+    *refitTime = seconds.count();
+  
+  vector<double> updatedC = updated.getCoefficients(), refittedC = refitted.getCoefficients();
+  double maxDifference = 0;
+  for (unsigned int j = 0; j < updatedC.size(); ++j)
+    maxDifference = std::max(maxDifference, fabs(updatedC[j] - refittedC[j]));
+  return maxDifference;
+}
+
+
+int main(int argc, const char* argv[]) {
+  int n = (argc > 1) ? atoi(argv[1]) : 12;
+  int noChanges = (argc > 2) ? atoi(argv[2]) : 5;
+  std::mt19937 generator(1);
+  
+  const char* layoutNames[] = { "row-major", "tiled", "Morton" };
+  const SplineCoefficientLayout layouts[] = { ROW_MAJOR_LAYOUT, TILED_LAYOUT, MORTON_LAYOUT };
+  double differences[] = { checkOneDof<3>(n, noChanges, generator), checkOneDof<4>(n, noChanges, generator),
+                           checkOneDof<5>(n, noChanges, generator) };
+  bool failed = false;
+  for (int k = 0; k < 3; ++k) {
+    cout << "1 DOF, order " << k+3 << ": max difference of the values " << differences[k] << endl;
+    failed = failed || !(differences[k] <= TOLERANCE);
+  }
+  for (int l = 0; l < 3; ++l) {
+    double differences[] = { checkDofs<3>(n, noChanges, layouts[l], generator), checkDofs<4>(n, noChanges, layouts[l], generator),
+                             checkDofs<5>(n, noChanges, layouts[l], generator) };
+    for (int k = 0; k < 3; ++k) {
+      cout << DIM << " DOFs, order " << k+3 << ", " << layoutNames[l] << ": max difference of the coefficients " 
+           << differences[k] << endl;
+      failed = failed || !(differences[k] <= TOLERANCE);
+    }
+  }
+  
+  // the responses decay by about 0.27 per node: without tolerance, each
+  // changed node reaches all the coefficients of grids up to n of about 50
+  const double tolerances[] = { 0., 1e-6, 1e-3 };
+  for (int t = 0; t < 3; ++t) {
+    double updateTime, refitTime;
+    double difference = checkDofs<4>(n, noChanges, ROW_MAJOR_LAYOUT, generator, tolerances[t], &updateTime, &refitTime);
+    cout << DIM << " DOFs, tolerance " << tolerances[t] << ": " << updateTime / noChanges * 1e6 << " us per changed node, "
+         << refitTime * 1e6 << " us per refit, max difference of the coefficients " << difference << endl;
+    // |deltaY| <= 1, and the skipped terms of a coefficient add up to a few tolerances
+    failed = failed || !(difference <= TOLERANCE + 10 * tolerances[t] * noChanges);
+  }
+  cout << (failed ? "The update differs from the refit\n" : "All checks passed\n");
+  
+  exit(failed ? EXIT_FAILURE : EXIT_SUCCESS);
+}
@@ -0,0 +1,202 @@
+// Copyright (c) 2011, Massimo Sartori and Monica Reggiani
+// All rights reserved.
+
+// Redistribution and use in source and binary forms, with or without 
+// modification, are permitted provided that the following conditions are met:
+// - Redistributions of source code must retain the above copyright notice, 
+//   this list of conditions and the following disclaimer.
+// - Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+
+
+
+#include <iostream>
+using std::cout;
+using std::endl;
+#include <fstream>
+using std::ifstream;
+using std::ofstream;
+#include <sstream>
+using std::stringstream;
+#include <string>
+using std::string;
+#include <vector>
+using std::vector;
+#include <algorithm>
+#include <chrono>
+#define _USE_MATH_DEFINES
+#include <math.h>
+#include <stdlib.h>
+
+#include "SplineOutOfCore.h"
+#include "Spline.cpp"
+#include "SplineOutOfCore.cpp"
+
+// Fits the splines of lmt.in out of core and evaluates them from the
+// mapped coefficient files on NodesData and BetweenNodesData. The values of
+// each muscle on the nodes are first copied from lmt.in to a binary file,
+// one row of lmt.in at a time, so no table is ever held in memory.
+
+const int N_DOF = 4;
+
+inline double radians (double d) {
+return d * M_PI / 180;
+}
+
+
+// skips the number of rows and the muscle names of an .in file of the data directory
+int openTable(const string& filename, ifstream& file) {
+  file.open(filename.c_str());
+  if (!file.is_open()) {
+    cout << "ERROR: " << filename << " could not be open\n";
+    exit(EXIT_FAILURE);
+  }
+  int noRows;
+  file >> noRows;
+  string line;
+  getline(file, line, '\n'); getline(file, line, '\n');
+  return noRows;
+}
+
+
+void evaluate(const string& evalDataDir, const vector<string>& dofName,
+              const vector< SplineMapped<N_DOF>* >& splines) {
+  ifstream anglesFile;
+  anglesFile.open((evalDataDir + "angles.in").c_str());
+  if (!anglesFile.is_open()) {
+    cout << "ERROR: " << evalDataDir << "angles.in could not be open\n";
+    exit(EXIT_FAILURE);
+  }
+  int noEvalData;
+  anglesFile >> noEvalData;
+  vector< vector<double> > angles(noEvalData, vector<double>(N_DOF));
+  for (int k = 0; k < noEvalData; ++k)
+    for (int i = N_DOF-1; i >= 0; --i) {
+      anglesFile >> angles[k][i];
+      angles[k][i] = radians(angles[k][i]);
+    }
+  
+  cout << evalDataDir << ": " << noEvalData << " poses, maximum error";
+  for (int d = -1; d < N_DOF; ++d) {
+    string name = (d < 0) ? string("lmt") : "ma" + dofName[d];
+    ifstream referenceFile;
+    if (openTable(evalDataDir + name + ".in", referenceFile) != noEvalData) {
+      cout << "\nERROR: " << evalDataDir << name << ".in has not " << noEvalData << " rows\n";
+      exit(EXIT_FAILURE);
+    }
+    double error = 0., reference;
+    for (int k = 0; k < noEvalData; ++k)
+      for (unsigned int m = 0; m < splines.size(); ++m) {
+        referenceFile >> reference;
+        double value = (d < 0) ? splines[m]->getValue(angles[k]) : -splines[m]->getFirstDerivative(angles[k], d);
+        error = std::max(error, fabs(value - reference));
+      }
+    cout << " " << name << " " << error;
+  }
+  cout << endl;
+}
+
+
+int main(int argc, const char* argv[])
+{
+  if (argc != 3) {
+    cout << "Usage: fitOutOfCore dataDirectory workDirectory\n";
+    cout << " dataDirectory: directory with data, read README.*\n";
+    cout << " workDirectory: where the coefficient files (muscle.spl) are written\n";
+    exit(EXIT_FAILURE);
+  }
+  string dataDirectory = argv[1];
+  string workDirectory = argv[2];
+  
+  string inputDataFilename = dataDirectory + "InputData/lmt.in";
+  ifstream inputDataFile(inputDataFilename.c_str());
+  if (!inputDataFile.is_open()) {
+    cout << "ERROR: " << inputDataFilename << " could not be open\n";
+    exit(EXIT_FAILURE);
+  }
+  vector<string> dofName(N_DOF);
+  vector<double> a(N_DOF), b(N_DOF);
+  vector<int> n(N_DOF);
+  for (int i = 0; i < N_DOF; ++i) {
+    inputDataFile >> dofName[i] >> a[i] >> b[i] >> n[i];
+    a[i] = radians(a[i]);
+    b[i] = radians(b[i]);
+  }
+  string line, nextMuscleName;
+  getline(inputDataFile, line, '\n'); getline(inputDataFile, line, '\n');
+  stringstream myStream(line);
+  vector<string> muscleNames;
+  while (myStream >> nextMuscleName)
+    muscleNames.push_back(nextMuscleName);
+  const int noMuscles = muscleNames.size();
+  long noInputData = 1;
+  for (int i = 0; i < N_DOF; ++i)
+    noInputData *= n[i] + 1;
+  
+  std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+  vector<ofstream*> nodesFiles(noMuscles);
+  for (int m = 0; m < noMuscles; ++m) {
+    nodesFiles[m] = new ofstream((workDirectory + muscleNames[m] + ".nodes").c_str(), std::ios::binary);
+    if (!nodesFiles[m]->is_open()) {
+      cout << "ERROR: " << workDirectory << muscleNames[m] << ".nodes could not be open\n";
+      exit(EXIT_FAILURE);
+    }
+  }
+  double value;
+  for (long k = 0; k < noInputData; ++k)
+    for (int m = 0; m < noMuscles; ++m) {
+      inputDataFile >> value;
+      nodesFiles[m]->write(reinterpret_cast<const char*>(&value), sizeof(value));
+    }
+  inputDataFile.close();
+  for (int m = 0; m < noMuscles; ++m)
+    delete nodesFiles[m];
+  std::chrono::duration<double> readTime = std::chrono::steady_clock::now() - start;
+  
+  start = std::chrono::steady_clock::now();
+  SplineOutOfCoreFitter<N_DOF> fitter(a, b, n);
+  for (int m = 0; m < noMuscles; ++m) {
+    string nodesFilename = workDirectory + muscleNames[m] + ".nodes";
+    fitter.fit(nodesFilename, workDirectory + muscleNames[m] + ".spl");
+    remove(nodesFilename.c_str());
+  }
+  std::chrono::duration<double> fitTime = std::chrono::steady_clock::now() - start;
+  cout << "Read " << noInputData << " nodes of " << noMuscles << " muscles in " << readTime.count() 
+       << " s, fitted in " << fitTime.count() << " s\n";
+  
+  vector< SplineMapped<N_DOF>* > splines(noMuscles);
+  for (int m = 0; m < noMuscles; ++m) {
+    splines[m] = new SplineMapped<N_DOF>(workDirectory + muscleNames[m] + ".spl");
+    splines[m]->setTileStatistics(true);
+  }
+  evaluate(dataDirectory + "NodesData/", dofName, splines);
+  evaluate(dataDirectory + "BetweenNodesData/", dofName, splines);
+  
+  long noTiles = 0, noTilesTouched = 0, noTileAccesses = 0, noEvaluations = 0, noPages = 0, noResidentPages = 0;
+  for (int m = 0; m < noMuscles; ++m) {
+    noTiles += splines[m]->getNumberOfTiles();
+    noTilesTouched += splines[m]->getNumberOfTilesTouched();
+    noTileAccesses += splines[m]->getNumberOfTileAccesses();
+    noEvaluations += splines[m]->getNumberOfEvaluations();
+    noPages += splines[m]->getNumberOfPages();
+    noResidentPages += splines[m]->getNumberOfResidentPages();
+    delete splines[m];
+  }
+  cout << "Tiles: " << noTilesTouched << " of " << noTiles << " touched, "
+       << static_cast<double>(noTileAccesses) / noEvaluations << " per evaluation\n";
+  cout << "Pages: " << noResidentPages << " of " << noPages << " in memory\n";
+  exit(EXIT_SUCCESS);
+}
@@ -0,0 +1,210 @@
+// Copyright (c) 2011, Massimo Sartori and Monica Reggiani
+// All rights reserved.
+
+// Redistribution and use in source and binary forms, with or without 
+// modification, are permitted provided that the following conditions are met:
+// - Redistributions of source code must retain the above copyright notice, 
+//   this list of conditions and the following disclaimer.
+// - Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+
+
+
+#include <iostream>
+using std::cout;
+using std::endl;
+#include <fstream>
+using std::ofstream;
+#include <iomanip>
+#include <string>
+using std::string;
+#include <vector>
+using std::vector;
+#include <random>
+#include <algorithm>
+#define _USE_MATH_DEFINES
+#include <math.h>
+#include <stdlib.h>
+#include <sys/stat.h>
+#ifdef _WIN32
+#include <direct.h>
+#endif
+
+#include "SyntheticModel.h"
+
+// Writes a data directory as the ones in Data, from a SyntheticModel:
+// InputData/lmt.in with the lengths on the nodes, and NodesData and
+// BetweenNodesData with the angles (nodes and centres of the cells) and the
+// reference lmt and moment arms. Beyond maxEvalPoints, the evaluation points
+// are drawn at random among the nodes (centres).
+
+const int NUMBER_DIGIT_OUTPUT = 10;
+
+inline double radians (double d) {
+return d * M_PI / 180;
+}
+
+
+void makeDirectory(const string& directory) {
+#ifdef _WIN32
+  _mkdir(directory.c_str());
+#else
+  mkdir(directory.c_str(), 0755);
+#endif
+}
+
+
+void openFile(const string& filename, ofstream& file) {
+  file.open(filename.c_str());
+  if (!file.is_open()) {
+    cout << "ERROR: " << filename << " could not be open\n";
+    exit(EXIT_FAILURE);
+  }
+  file << std::setprecision(NUMBER_DIGIT_OUTPUT);
+}
+
+
+void writeMuscleNames(const SyntheticModel& model, ofstream& file) {
+  for (int m = 0; m < model.getNumberOfMuscles(); ++m)
+    file << model.getMuscleName(m) << ( (m+1 < model.getNumberOfMuscles()) ? "\t" : "\n" );
+}
+
+
+// the angles (degrees) of the point k of the grid with noPoints[i] points on
+// each axis, starting at offset[i] intervals from the lower bound, the first
+// axis running fastest
+void getAngles(const SyntheticModel& model, const vector<int>& n, const vector<int>& noPoints, const double offset,
+               long k, vector<double>& angles) {
+  for (int i = 0; i < model.getNumberOfDofs(); ++i) {
+    double h = (model.getUpperBound(i) - model.getLowerBound(i)) / n[i];
+    angles[i] = model.getLowerBound(i) + (k % noPoints[i] + offset) * h;
+    k /= noPoints[i];
+  }
+}
+
+
+void writeEvalData(const SyntheticModel& model, const vector<int>& n, const double offset, const long maxEvalPoints,
+                   const string& directory) {
+  const int noDofs = model.getNumberOfDofs();
+  vector<int> noPoints(noDofs);
+  long noGridPoints = 1;
+  for (int i = 0; i < noDofs; ++i) {
+    noPoints[i] = (offset == 0.) ? n[i]+1 : n[i];
+    noGridPoints *= noPoints[i];
+  }
+  vector<long> points;
+  if (noGridPoints <= maxEvalPoints)
+    for (long k = 0; k < noGridPoints; ++k)
+      points.push_back(k);
+  else {
+    std::mt19937_64 generator(noGridPoints);
+    std::uniform_int_distribution<long> uniform(0, noGridPoints-1);
+    for (long k = 0; k < maxEvalPoints; ++k)
+      points.push_back(uniform(generator));
+    std::sort(points.begin(), points.end());
+  }
+  
+  makeDirectory(directory);
+  ofstream anglesFile, lmtFile;
+  vector<ofstream*> maFiles(noDofs);
+  openFile(directory + "angles.in", anglesFile);
+  openFile(directory + "lmt.in", lmtFile);
+  anglesFile << points.size() << endl;
+  lmtFile << points.size() << endl;
+  writeMuscleNames(model, lmtFile);
+  for (int i = 0; i < noDofs; ++i) {
+    maFiles[i] = new ofstream;
+    openFile(directory + "ma" + model.getDofName(i) + ".in", *maFiles[i]);
+    *maFiles[i] << points.size() << endl;
+    writeMuscleNames(model, *maFiles[i]);
+  }
+  
+  // the angles are written from the last DOF, as in the Data directory
+  vector<double> angles(noDofs), q(noDofs);
+  for (unsigned int k = 0; k < points.size(); ++k) {
+    getAngles(model, n, noPoints, offset, points[k], angles);
+    for (int i = noDofs-1; i >= 0; --i) {
+      anglesFile << angles[i] << ( (i > 0) ? "\t" : "\n" );
+      q[i] = radians(angles[i]);
+    }
+    for (int m = 0; m < model.getNumberOfMuscles(); ++m) {
+      lmtFile << model.getLmt(m, q) << "\t";
+      for (int i = 0; i < noDofs; ++i)
+        *maFiles[i] << model.getMomentArm(m, i, q) << "\t";
+    }
+    lmtFile << "\n";
+    for (int i = 0; i < noDofs; ++i)
+      *maFiles[i] << "\n";
+  }
+  for (int i = 0; i < noDofs; ++i)
+    delete maFiles[i];
+}
+
+
+int main(int argc, const char* argv[])
+{
+  if ( argc < 5 || argc > 7 ) {
+    cout << "Usage: generateData dataDirectory noDofs noMuscles noIntervals [maxEvalPoints] [seed]\n";
+    cout << " dataDirectory: where InputData, NodesData and BetweenNodesData are written\n";
+    cout << " noIntervals: number of intervals on each DOF\n";
+    cout << " maxEvalPoints: maximum number of points of NodesData and BetweenNodesData (default 10000)\n";
+    cout << " seed: of the parameters of the model (default 1)\n";
+    exit(EXIT_FAILURE);
+  }
+  string dataDirectory = argv[1];
+  const int noDofs = atoi(argv[2]);
+  const int noMuscles = atoi(argv[3]);
+  vector<int> n(noDofs, atoi(argv[4]));
+  const long maxEvalPoints = (argc > 5) ? atol(argv[5]) : 10000;
+  const unsigned int seed = (argc > 6) ? atoi(argv[6]) : 1;
+  if ( (noDofs < 1) || (noMuscles < 1) || (n[0] < 1) ) {
+    cout << "ERROR: we need at least one DOF, one muscle and one interval\n";
+    exit(EXIT_FAILURE);
+  }
+  
+  SyntheticModel model(noDofs, noMuscles, seed);
+  makeDirectory(dataDirectory);
+  makeDirectory(dataDirectory + "InputData/");
+  ofstream inputDataFile;
+  openFile(dataDirectory + "InputData/lmt.in", inputDataFile);
+  for (int i = 0; i < noDofs; ++i)
+    inputDataFile << model.getDofName(i) << " " << model.getLowerBound(i) << " " 
+                  << model.getUpperBound(i) << " " << n[i] << endl;
+  writeMuscleNames(model, inputDataFile);
+  vector<int> noNodes(noDofs);
+  long noInputData = 1;
+  for (int i = 0; i < noDofs; ++i) {
+    noNodes[i] = n[i] + 1;
+    noInputData *= noNodes[i];
+  }
+  vector<double> angles(noDofs);
+  for (long k = 0; k < noInputData; ++k) {
+    getAngles(model, n, noNodes, 0., k, angles);
+    for (int i = 0; i < noDofs; ++i)
+      angles[i] = radians(angles[i]);
+    for (int m = 0; m < noMuscles; ++m)
+      inputDataFile << model.getLmt(m, angles) << "\t";
+    inputDataFile << "\n";
+  }
+  inputDataFile.close();
+  
+  writeEvalData(model, n, 0., maxEvalPoints, dataDirectory + "NodesData/");
+  writeEvalData(model, n, 0.5, maxEvalPoints, dataDirectory + "BetweenNodesData/");
+  
+  cout << "Written " << noInputData << " nodes of " << noMuscles << " muscles on " << noDofs 
+       << " DOFs in " << dataDirectory << endl;
+  exit(EXIT_SUCCESS);
+}
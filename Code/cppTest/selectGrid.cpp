@@ -0,0 +1,166 @@
+// Copyright (c) 2011, Massimo Sartori and Monica Reggiani
+// All rights reserved.
+
+// Redistribution and use in source and binary forms, with or without 
+// modification, are permitted provided that the following conditions are met:
+// - Redistributions of source code must retain the above copyright notice, 
+//   this list of conditions and the following disclaimer.
+// - Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+
+
+
+#include <iostream>
+using std::cout;
+using std::endl;
+#include <fstream>
+using std::ifstream;
+#include <sstream>
+using std::stringstream;
+#include <string>
+using std::string;
+#include <vector>
+using std::vector;
+#include <algorithm>
+#define _USE_MATH_DEFINES
+#include <math.h>
+#include <stdlib.h>
+
+#include "Spline.h"
+#include "Spline.cpp"
+#include "SplineGridSelector.h"
+#include "SplineGridSelector.cpp"
+
+const int N_DOF = 4;
+
+inline double radians (double d) {
+return d * M_PI / 180;
+}
+
+
+int main(int argc, const char* argv[])
+{
+  if ( argc < 3 || argc > 4 ) {
+    cout << "Usage: selectGrid dataDirectory tolerance [maxIntervals]\n";
+    cout << " dataDirectory: directory with data, read README.*\n";
+    cout << " tolerance: maximum error of lmt on the held-out points and on BetweenNodesData\n";
+    cout << " maxIntervals: maximum number of intervals on each DOF (default and at most those of lmt.in)\n";
+    exit(EXIT_FAILURE);
+  }
+  
+  string dataDirectory = argv[1];
+  string inputDataFilename = dataDirectory + "InputData/lmt.in";
+  ifstream inputDataFile(inputDataFilename.c_str());
+  if (!inputDataFile.is_open()) {
+    cout << "ERROR: " << inputDataFilename << " could not be open\n";
+    exit(EXIT_FAILURE);
+  }
+  
+  // the lmt.in table is the reference: see SplineTableSampler
+  vector<string> dofName(N_DOF);
+  vector<double> a(N_DOF), b(N_DOF);
+  vector<int> n(N_DOF);
+  for (int i = 0; i < N_DOF; ++i) {
+    inputDataFile >> dofName[i] >> a[i] >> b[i] >> n[i];
+    a[i] = radians(a[i]);
+    b[i] = radians(b[i]);
+  }
+  string line, nextMuscleName;
+  getline(inputDataFile, line, '\n'); getline(inputDataFile, line, '\n');
+  stringstream myStream(line);
+  vector<string> muscleNames;
+  while (myStream >> nextMuscleName)
+    muscleNames.push_back(nextMuscleName);
+  int noInputData = 1;
+  for (int i = 0; i < N_DOF; ++i)
+    noInputData *= n[i] + 1;
+  vector< vector<double> > y(muscleNames.size(), vector<double>(noInputData));
+  for (int j = 0; j < noInputData; ++j)
+    for (unsigned int i = 0; i < muscleNames.size(); ++i)
+      inputDataFile >> y[i][j];
+  inputDataFile.close();
+  
+  // between its nodes the table only gives back its own spline: it cannot
+  // tell whether a finer grid is needed, nor how far it is from the truth
+  SplineTableSampler<N_DOF> sampler(a, b, n, y);
+  SplineGridSelector<N_DOF> selector(a, b, sampler);
+  const double tolerance = atof(argv[2]);
+  selector.setTolerance(tolerance);
+  vector<int> maxIntervals(n);
+  for (int i = 0; argc == 4 && i < N_DOF; ++i)
+    maxIntervals[i] = std::min(n[i], atoi(argv[3]));
+  selector.setMaxIntervals(maxIntervals);
+  
+  cout << "Selecting the grid for " << muscleNames.size() << " muscles, tolerance " << argv[2] << endl;
+  bool found = selector.selectGrid();
+  if (!found)
+    cout << "The tolerance cannot be met: showing the finest grid\n";
+  
+  // the selected grid against independent values, and the table for comparison
+  string evalDataDir = dataDirectory + "BetweenNodesData/";
+  ifstream anglesFile((evalDataDir + "angles.in").c_str());
+  ifstream lmtFile((evalDataDir + "lmt.in").c_str());
+  if (!anglesFile.is_open() || !lmtFile.is_open()) {
+    cout << "ERROR: " << evalDataDir << "angles.in or lmt.in could not be open\n";
+    exit(EXIT_FAILURE);
+  }
+  int noEvalData, noLmtData;
+  anglesFile >> noEvalData;
+  lmtFile >> noLmtData;
+  getline(lmtFile, line, '\n'); getline(lmtFile, line, '\n');
+  if (noLmtData != noEvalData) {
+    cout << "ERROR: " << evalDataDir << "angles.in and lmt.in have a different number of poses\n";
+    exit(EXIT_FAILURE);
+  }
+  const vector< Spline<N_DOF> >& splines = selector.getSplines();
+  vector<double> angles(N_DOF), tableValues;
+  double validationError = 0., tableError = 0., reference;
+  for (int k = 0; k < noEvalData; ++k) {
+    // angles.in lists the DOFs backwards
+    for (int i = N_DOF-1; i >= 0; --i) {
+      anglesFile >> angles[i];
+      angles[i] = radians(angles[i]);
+    }
+    sampler.getValues(angles, tableValues);
+    for (unsigned int m = 0; m < muscleNames.size(); ++m) {
+      lmtFile >> reference;
+      validationError = std::max(validationError, fabs(splines[m].getValue(angles) - reference));
+      tableError = std::max(tableError, fabs(tableValues[m] - reference));
+    }
+  }
+  if (!anglesFile || !lmtFile) {
+    cout << "ERROR: " << evalDataDir << " could not be read\n";
+    exit(EXIT_FAILURE);
+  }
+  bool validated = (validationError <= tolerance);
+  
+  const vector<int>& selected = selector.getIntervals();
+  long tableMemory = 1;
+  for (int i = 0; i < N_DOF; ++i) {
+    cout << dofName[i] << ": " << selected[i] << " intervals (" << n[i] << " in lmt.in)\n";
+    tableMemory *= n[i] + 3;
+  }
+  tableMemory *= muscleNames.size() * sizeof(double);
+  cout << "Held-out error:  " << selector.getError() << " after " << selector.getNumberOfFits() << " fits\n";
+  cout << "BetweenNodesData error: " << validationError << " (" << tableError << " with the grid of lmt.in)\n";
+  cout << "Memory:          " << selector.getMemory() << " bytes (" << tableMemory << " with the grid of lmt.in)\n";
+  cout << "Fit time:        " << selector.getFitTime() * 1e3 << " ms for all the muscles\n";
+  cout << "Evaluation time: " << selector.getEvaluationTime() * 1e9 << " ns per muscle and pose\n";
+  if (found && !validated)
+    cout << "ERROR: the selected grid exceeds the tolerance on BetweenNodesData"
+         << (tableError > tolerance ? ": lmt.in is too coarse for this tolerance\n" : "\n");
+  exit(found && validated ? EXIT_SUCCESS : EXIT_FAILURE);
+}
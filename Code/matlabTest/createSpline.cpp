@@ -81,7 +81,6 @@ void mexFunction(
   std::vector<double> a;
   std::vector<double> b;
   std::vector<int> n;
-  vector< vector< double> > y;
 
   yArrayPtr=mxGetPr(prhs[0]);  
   aArrayPtr=mxGetPr(prhs[1]);
@@ -98,17 +97,6 @@ void mexFunction(
    b.push_back(bArrayPtr[i]);
   }
  
-  for (int i=0; i<noMuscles; ++i)
-  {
-    std::vector<double> dummyVec;
-    dummyVec.clear();
-    for (int k=0; k<noSamples; ++k)
-    {
-      dummyVec.push_back(yArrayPtr[k+i*noSamples]);
-    }
-    y.push_back(dummyVec);
-  } 
- 
   vector< SplineMatlab<N_DOF> > splines;
   for (int i = 0; i < noMuscles; ++i) 
   {
@@ -120,11 +108,10 @@ void mexFunction(
 //   cout << "Created " << splines_.size() << " splines.\n";
 // #endif     
 
-  // now compute coefficients for each muscle
+  // now compute coefficients for each muscle, in place from its column of y
   for (int i = 0; i < noMuscles; ++i) 
   {
-    vector<double> currentMuscle(y[i]);
-    splines[i].computeCoefficients(currentMuscle, currentMuscle.begin());
+    splines[i].computeCoefficients(yArrayPtr + i*noSamples, 1);
   }
 
 //   plhs[0]=mxCreateDoubleMatrix(splines[0].getCcoefficients().size(), noMuscles, mxREAL);
@@ -24,24 +24,12 @@
 #include <iostream>
 using std::cout;
 using std::endl;
-#include <string>
-using std::string;
-#include <vector>
-using std::vector;
 #include <stdlib.h>
 
-#include "../src/Spline.h"
-#include "../src/Spline.cpp"
+#include "../src/SplineC.h"
 #include "mex.h"
 
 
-template <int dim> class SplineMatlab: public Spline<dim>{
-public:
-  SplineMatlab(const std::vector<double>& a, const std::vector<double>& b, const std::vector<int>& n ):Spline<dim>(a,b, n){};
-  std::vector<double> getCcoefficients(){return this->c_;};
-  void setCcoefficients(std::vector<double> newC){this->c_=newC;};
-  
-};
 void mexFunction(
                  int          nlhs,
                  mxArray      *plhs[],
@@ -51,7 +39,6 @@ void mexFunction(
 {
   
   // Check arguments
- cout << "n inputs " << nrhs << " n outputs" << nlhs <<endl;
   if (nrhs!=2)
   {
     mexErrMsgTxt("Two input arguments required: C, x");
@@ -73,22 +60,28 @@ void mexFunction(
   if (mxGetN(prhs[1])!=N_DOF)
     mexErrMsgIdAndTxt("evalSpline:wrongInputs","Argument x must have %d columns, corresponding to the number of degrees of freedom.", N_DOF);
     
-
-  
   int noMuscles=mxGetNumberOfElements(prhs[0]);
-  vector< SplineMatlab<N_DOF> > splines;
+  
+  plhs[0]=mxCreateDoubleMatrix(noSamples, noMuscles, mxREAL);
+  double *lmtArrayPtr=mxGetPr(plhs[0]);
+  double *maArrayPtr;
+  if (nlhs>1)
+  {
+    mwSize dims[]={noSamples, noMuscles, N_DOF};
+    plhs[1]=mxCreateNumericArray(3, dims, mxDOUBLE_CLASS, mxREAL);
+    maArrayPtr=mxGetPr(plhs[1]);
+  }
+  
+  // x is column-major and its last column is the first DOF of the spline:
+  // start from the last column and go backwards, without copying x
+  const double* anglesPtr=xArrayPtr+(N_DOF-1)*noSamples;
+  
   for (int k=0; k<noMuscles; ++k)
   { 
-    std::vector<double> a;
-    std::vector<double> b;
-    std::vector<int> n;
-//     a.clear();
-//     b.clear();
-//     n.clear();
     mxArray *aArray=mxGetField(prhs[0], k, "a");
     mxArray *bArray=mxGetField(prhs[0], k, "b");
     mxArray *nArray=mxGetField(prhs[0], k, "n");
-    mxArray *cArray=mxGetField(prhs[0], k, "C"); // check number of coefficients?
+    mxArray *cArray=mxGetField(prhs[0], k, "C"); 
     if(!mxIsDouble(aArray) || mxGetNumberOfDimensions(aArray)!=2 || (mxGetDimensions(aArray)[0]!=1 && mxGetDimensions(aArray)[1]!=1))
       mexErrMsgIdAndTxt("evalSpline:wrongInputs","Field a in element %d must be a double vector.", k);
     if(!mxIsDouble(bArray) || mxGetNumberOfDimensions(bArray)!=2 || (mxGetDimensions(bArray)[0]!=1 && mxGetDimensions(bArray)[1]!=1))
@@ -101,73 +94,31 @@ void mexFunction(
     if(mxGetDimensions(aArray)[0]*mxGetDimensions(aArray)[1]!=N_DOF || mxGetDimensions(bArray)[0]*mxGetDimensions(bArray)[1]!=N_DOF || mxGetDimensions(nArray)[0]*mxGetDimensions(nArray)[1]!=N_DOF)
       mexErrMsgIdAndTxt("evalSpline:wrongInputs","a, b and n in element %d must be all of length %d. If you want to use a different number of degrees of freedom, change N_DOF in the mex file and recompile it.", k, N_DOF);
  
-
     aArrayPtr=mxGetPr(aArray);
     bArrayPtr=mxGetPr(bArray);
     cArrayPtr=mxGetPr(cArray);
     nArrayPtr=(int*) mxGetData(nArray);
     
-    n.assign(nArrayPtr, nArrayPtr+N_DOF);
-    a.assign(aArrayPtr, aArrayPtr+N_DOF);
-    b.assign(bArrayPtr, bArrayPtr+N_DOF);
-    //fill structures
-//     for (int i=0; i<N_DOF; ++i)
-//     {
-//       n.push_back(nArrayPtr[i]);
-//       a.push_back(aArrayPtr[i]);
-//       b.push_back(bArrayPtr[i]);
-//     }
-  
-    SplineMatlab<N_DOF> newSpline(a,b,n);
-    splines.push_back(newSpline);
-  
-    std::vector<double> newCoefficients;
-    int noCoefficients=mxGetM(cArray);
-    newCoefficients.clear();
-    for (int j=0; j<noCoefficients; ++j)
-    {
-      newCoefficients.push_back(cArrayPtr[j]);
-    }
-    splines.back().setCcoefficients(newCoefficients);
-  
-  }
- 
-  
-  plhs[0]=mxCreateDoubleMatrix(noSamples, noMuscles, mxREAL);
-  double *lmtArrayPtr=mxGetPr(plhs[0]);
-  double *maArrayPtr;
-  if (nlhs>1)
-  {
-    mwSize dims[]={noSamples, noMuscles, N_DOF};
-    plhs[1]=mxCreateNumericArray(3, dims, mxDOUBLE_CLASS, mxREAL);
-    maArrayPtr=mxGetPr(plhs[1]);
-  }
-  
-  vector<double> angles(N_DOF);
-  
-
-  for (int j = 0; j < noSamples; ++j) 
-  {
-    angles.clear();
-    for (int k=N_DOF-1; k>=0; --k)
-    {
-      angles.push_back(xArrayPtr[j+(k * noSamples)]);
-
-     // cout << "angolo "<< j << " dof " << k << ": "<< radians(xArrayPtr[j+(k * noSamples)])<< "\t";
-    }
-    for (int i = 0; i < noMuscles; ++i) 
-    { 
-      //cout << "pre lmt sample " << j << " musc " << i <<endl;
-      lmtArrayPtr[j+(i*noSamples)]=splines[i].getValue(angles);
-      //cout << "post lmt sample " << j << " musc " << i <<endl;      
-      if(nlhs>1)
-      {
-        for (int k=0; k<N_DOF; ++k)
-          maArrayPtr[j+(i*noSamples)+(k*noMuscles*noSamples)]=splines[i].getFirstDerivative(angles,k);
-          
-      }
-    }
+    int noCoefficients=1;
+    for (int i=0; i<N_DOF; ++i)
+      noCoefficients*=nArrayPtr[i]+3;
+    if (mxGetNumberOfElements(cArray)!=noCoefficients)
+      mexErrMsgIdAndTxt("evalSpline:wrongInputs","Field C in element %d must have %d coefficients.", k, noCoefficients);
+    
+    // each muscle can have its own grid: one spline set per muscle.
+    // The Matlab struct holds only a, b, n and C, so the set is rebuilt and
+    // its coefficients copied on every call; x and the outputs are not copied
+    SplineSetHandle spline=splineSetCreate(N_DOF, aArrayPtr, bArrayPtr, nArrayPtr, 1, cArrayPtr, 1, noCoefficients);
+    if (spline==NULL)
+      mexErrMsgIdAndTxt("evalSpline:wrongInputs","Wrong grid in element %d.", k);
+    
+    int result=splineSetEvaluate(spline, noSamples, anglesPtr, 1, -noSamples, lmtArrayPtr+k*noSamples, 1, 0);
+    if (result==SPLINE_C_OK && nlhs>1)
+      result=splineSetEvaluateFirstDerivatives(spline, noSamples, anglesPtr, 1, -noSamples,
+                                               maArrayPtr+k*noSamples, 1, 0, noMuscles*noSamples);
+    splineSetDestroy(spline);
+    if (result!=SPLINE_C_OK)
+      mexErrMsgIdAndTxt("evalSpline:wrongInputs","Values x are out of boundaries.");
   }
 
 } 
-
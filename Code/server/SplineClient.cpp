@@ -0,0 +1,227 @@
+// Copyright (c) 2011, Massimo Sartori and Monica Reggiani
+// All rights reserved.
+
+// Redistribution and use in source and binary forms, with or without 
+// modification, are permitted provided that the following conditions are met:
+// - Redistributions of source code must retain the above copyright notice, 
+//   this list of conditions and the following disclaimer.
+// - Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+
+
+
+#include <iostream>
+#include <sstream>
+#include <algorithm>
+#include <chrono>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <sched.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+
+#include "SplineClient.h"
+
+
+SplineClient::SplineClient(const std::string& socketPath, const int timeout)
+:fd_(-1), ring_(NULL), requested_(0), timeout_(timeout), lost_(false) {
+  sockaddr_un address;
+  memset(&address, 0, sizeof(address));
+  address.sun_family = AF_UNIX;
+  if (socketPath.size() >= sizeof(address.sun_path)) {
+    std::cout << "ERROR: socket path " << socketPath << " is too long\n";
+    exit(EXIT_FAILURE);
+  }
+  strcpy(address.sun_path, socketPath.c_str());
+  
+  fd_ = socket(AF_UNIX, SOCK_STREAM, 0);
+  if (fd_ < 0 || connect(fd_, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0) {
+    std::cout << "ERROR: cannot connect to " << socketPath << ": " << strerror(errno) << std::endl;
+    exit(EXIT_FAILURE);
+  }
+  
+  readModels();
+  openRing();
+}
+
+
+SplineClient::~SplineClient() {
+  // closing the socket tells the server to release the ring
+  if (ring_ != NULL)
+    munmap(ring_, SPLINE_RING_SIZE);
+  close(fd_);
+}
+
+
+void SplineClient::readModels() {
+  std::string line;
+  if (!writeControlLine(fd_, "LIST")) {
+    std::cout << "ERROR: the spline server closed the connection\n";
+    exit(EXIT_FAILURE);
+  }
+  while (readControlLine(fd_, pending_, line) && line != "END") {
+    std::stringstream myStream(line);
+    ModelInfo model;
+    int index, noMuscles;
+    myStream >> index >> model.dim_ >> noMuscles;
+    model.a_.resize(model.dim_);
+    model.b_.resize(model.dim_);
+    for (int i = 0; i < model.dim_; ++i)
+      myStream >> model.a_[i] >> model.b_[i];
+    model.muscleNames_.resize(noMuscles);
+    for (int k = 0; k < noMuscles; ++k)
+      myStream >> model.muscleNames_[k];
+    myStream >> model.file_;
+    models_.push_back(model);
+  }
+  if (line != "END") {
+    std::cout << "ERROR: the spline server closed the connection\n";
+    exit(EXIT_FAILURE);
+  }
+}
+
+
+void SplineClient::openRing() {
+  std::string reply;
+  if (!writeControlLine(fd_, "OPEN") || !readControlLine(fd_, pending_, reply) || reply.compare(0, 3, "OK ") != 0) {
+    std::cout << "ERROR: the spline server did not open a ring: " << reply << std::endl;
+    exit(EXIT_FAILURE);
+  }
+  
+  std::string name = reply.substr(3);
+  int shmFd = shm_open(name.c_str(), O_RDWR, 0600);
+  void* memory = MAP_FAILED;
+  if (shmFd >= 0) {
+    memory = mmap(NULL, SPLINE_RING_SIZE, PROT_READ | PROT_WRITE, MAP_SHARED, shmFd, 0);
+    close(shmFd);
+  }
+  if (memory == MAP_FAILED) {
+    std::cout << "ERROR: cannot map " << name << ": " << strerror(errno) << std::endl;
+    exit(EXIT_FAILURE);
+  }
+  ring_ = static_cast<SplineRingHeader*>(memory);
+  if (ring_->magic_ != SPLINE_RING_MAGIC || ring_->slotSize_ != SPLINE_RING_SLOT_SIZE) {
+    std::cout << "ERROR: " << name << " is not a ring of this version of the spline server\n";
+    exit(EXIT_FAILURE);
+  }
+  requested_ = ring_->requested_.load();
+}
+
+
+int SplineClient::getModelIndex(const std::string& file) const {
+  for (unsigned int m = 0; m < models_.size(); ++m)
+    if (models_[m].file_ == file)
+      return m;
+  return -1;
+}
+
+
+// spins, then yields and finally polls the socket: the server never writes
+// on it unasked, so a readable socket means that the server closed it
+bool SplineClient::waitFor(const uint64_t sequence) {
+  const std::chrono::steady_clock::time_point deadline =
+    std::chrono::steady_clock::now() + std::chrono::milliseconds(timeout_);
+  int idle = 0;
+  while (ring_->served_.load(std::memory_order_acquire) < sequence) {
+    ++idle;
+    if (idle <= 1000)
+      continue;
+    if (idle <= 11000) {
+      sched_yield();
+      continue;
+    }
+    pollfd control;
+    control.fd = fd_;
+    control.events = POLLIN;
+    char byte;
+    if (poll(&control, 1, 1) > 0 && recv(fd_, &byte, 1, MSG_PEEK | MSG_DONTWAIT) <= 0)
+      lost_ = true;
+    else if (std::chrono::steady_clock::now() > deadline)
+      lost_ = true;
+    if (lost_) {
+      std::cout << "ERROR: the spline server did not serve request " << sequence - 1 << std::endl;
+      return false;
+    }
+  }
+  return true;
+}
+
+
+// the batch is split into chunks of at most maxFrames_ frames, and up to
+// noSlots_ chunks are in flight at the same time
+int SplineClient::evaluate(const int model, const int noFrames, const double* x, double* lmt, double* ma) {
+  if (lost_)
+    return SPLINE_REQUEST_SERVER_LOST;
+  if (model < 0 || model >= static_cast<int>(models_.size()))
+    return SPLINE_REQUEST_WRONG_MODEL;
+  const int dim = models_[model].dim_;
+  const int noMuscles = models_[model].muscleNames_.size();
+  const int maxFrames = ring_->maxFrames_;
+  const uint64_t first = requested_;
+  const int noChunks = (noFrames + maxFrames - 1) / maxFrames;
+  int status = SPLINE_REQUEST_OK;
+  
+  for (int chunk = 0; chunk < noChunks + static_cast<int>(ring_->noSlots_); ++chunk) {
+    // collect the chunk submitted noSlots_ chunks ago, freeing its slot
+    int done = chunk - ring_->noSlots_;
+    if (done >= 0 && done < noChunks) {
+      // the slots still in flight are lost with the server: the ring is not reused
+      if (!waitFor(first + done + 1))
+        return SPLINE_REQUEST_SERVER_LOST;
+      SplineRequest* request = getSplineRequest(ring_, first + done);
+      const int firstFrame = done * maxFrames;
+      if (request->status_ != SPLINE_REQUEST_OK && status == SPLINE_REQUEST_OK)
+        status = request->status_;
+      std::copy(request->lmt(), request->lmt() + request->noFrames_*noMuscles, lmt + firstFrame*noMuscles);
+      if (ma != NULL)
+        std::copy(request->ma(), request->ma() + request->noFrames_*noMuscles*dim, ma + firstFrame*noMuscles*dim);
+    }
+    if (chunk < noChunks) {
+      SplineRequest* request = getSplineRequest(ring_, requested_);
+      const int firstFrame = chunk * maxFrames;
+      request->model_ = model;
+      request->noFrames_ = std::min(maxFrames, noFrames - firstFrame);
+      request->withDerivatives_ = (ma != NULL);
+      std::copy(x + firstFrame*dim, x + (firstFrame + request->noFrames_)*dim, request->x());
+      ring_->requested_.store(++requested_, std::memory_order_release);
+    }
+  }
+  return status;
+}
+
+
+bool SplineClient::reload(const int model, const std::string& file) {
+  std::stringstream command;
+  command << "RELOAD " << model;
+  if (!file.empty())
+    command << " " << file;
+  std::string reply;
+  if (!writeControlLine(fd_, command.str()) || !readControlLine(fd_, pending_, reply))
+    return false;
+  if (reply != "OK") {
+    std::cout << reply << std::endl;
+    return false;
+  }
+  // the bounds may have changed
+  models_.clear();
+  readModels();
+  return true;
+}
@@ -0,0 +1,83 @@
+// Copyright (c) 2011, Massimo Sartori and Monica Reggiani
+// All rights reserved.
+
+// Redistribution and use in source and binary forms, with or without 
+// modification, are permitted provided that the following conditions are met:
+// - Redistributions of source code must retain the above copyright notice, 
+//   this list of conditions and the following disclaimer.
+// - Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+
+
+
+#ifndef SplineClient_h
+#define SplineClient_h
+
+#include <string>
+#include <vector>
+
+#include "SplineServerProtocol.h"
+
+
+// Evaluates the splines held by a SplineServer: the client never reads
+// lmt.in nor fits anything. Angles are in radians, as for Spline.
+class SplineClient {
+  public:
+    // a request not served within timeout milliseconds fails with
+    // SPLINE_REQUEST_SERVER_LOST
+    SplineClient(const std::string& socketPath, const int timeout = 10000);
+    ~SplineClient();
+    int getNumberOfModels() const { return models_.size(); }
+    // -1 if no model was loaded from file
+    int getModelIndex(const std::string& file) const;
+    int getDimension(const int model) const { return models_[model].dim_; }
+    int getNumberOfMuscles(const int model) const { return models_[model].muscleNames_.size(); }
+    const std::string& getMuscleName(const int model, const int muscle) const { return models_[model].muscleNames_[muscle]; }
+    double getLowerBound(const int model, const int dof) const { return models_[model].a_[dof]; }
+    double getUpperBound(const int model, const int dof) const { return models_[model].b_[dof]; }
+    // x[frame*dim + dof] -> lmt[frame*noMuscles + muscle] and, if ma is not
+    // NULL, the moment arms ma[(frame*noMuscles + muscle)*dim + dof] = -dlmt/dq,
+    // as in the ma*.in files; returns a SplineRequestStatus. The frames out of
+    // bounds get NaN and SPLINE_REQUEST_OUT_OF_BOUNDS, the others their values.
+    // Once the server is lost, every call returns SPLINE_REQUEST_SERVER_LOST
+    int evaluate(const int model, const int noFrames, const double* x, double* lmt, double* ma = NULL);
+    // asks the server to refit a model, from its own file or from a new one
+    bool reload(const int model, const std::string& file = "");
+    
+  private:
+    struct ModelInfo {
+      int dim_;
+      std::vector<double> a_, b_;
+      std::vector<std::string> muscleNames_;
+      std::string file_;
+    };
+    
+    int fd_;
+    std::string pending_;
+    std::vector<ModelInfo> models_;
+    SplineRingHeader* ring_;
+    uint64_t requested_;
+    int timeout_;
+    bool lost_;
+    
+    SplineClient(const SplineClient&);
+    SplineClient& operator=(const SplineClient&);
+    void readModels();
+    void openRing();
+    bool waitFor(const uint64_t sequence);
+};
+
+#endif
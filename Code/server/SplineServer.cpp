@@ -0,0 +1,381 @@
+// Copyright (c) 2011, Massimo Sartori and Monica Reggiani
+// All rights reserved.
+
+// Redistribution and use in source and binary forms, with or without 
+// modification, are permitted provided that the following conditions are met:
+// - Redistributions of source code must retain the above copyright notice, 
+//   this list of conditions and the following disclaimer.
+// - Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+
+
+
+#include <iostream>
+#include <sstream>
+#include <fstream>
+#include <new>
+#include <algorithm>
+#include <thread>
+#define _USE_MATH_DEFINES
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <sched.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+
+#include "SplineServer.h"
+#include "Spline.cpp"
+#include "SplineSet.cpp"
+#include "SnapshotHolder.cpp"
+
+// readers per model: one per ring and one for the control commands
+const int MAX_RINGS = 128;
+const int MAX_READERS = MAX_RINGS + 1;
+
+
+SplineServer::ModelSnapshot::ModelSnapshot(const std::string& file, const std::vector<double>& a, const std::vector<double>& b,
+                                           const std::vector<int>& n, const std::vector<std::string>& muscleNames,
+                                           const std::vector< std::vector<double> >& y)
+:file_(file), splines_(a, b, n, muscleNames, y) {
+  for (int i = 0; i < N_DOF; ++i) {
+    a_[i] = a[i];
+    b_[i] = b[i];
+  }
+}
+
+
+// same format as the lmt.in files read by testSpline; NULL if the file cannot be
+// read or its grid is not valid
+SplineServer::ModelSnapshot* SplineServer::loadModel(const std::string& file) {
+  std::ifstream inputDataFile(file.c_str());
+  if (!inputDataFile.is_open())
+    return NULL;
+  
+  std::vector<double> a(N_DOF), b(N_DOF);
+  std::vector<int> n(N_DOF);
+  for (int i = 0; i < N_DOF; ++i) {
+    std::string dofName;
+    inputDataFile >> dofName >> a[i] >> b[i] >> n[i];
+    a[i] = a[i] * M_PI / 180;
+    b[i] = b[i] * M_PI / 180;
+    // the cubic fit needs 2 intervals at least on each axis
+    if (!inputDataFile || n[i] < 2 || !(a[i] < b[i]))
+      return NULL;
+  }
+  
+  std::string line;
+  getline(inputDataFile, line, '\n'); getline(inputDataFile, line, '\n');
+  std::stringstream myStream(line);
+  std::vector<std::string> muscleNames;
+  std::string nextMuscleName;
+  while (myStream >> nextMuscleName)
+    muscleNames.push_back(nextMuscleName);
+  if (!inputDataFile || muscleNames.empty() || muscleNames.size() > static_cast<unsigned int>(SPLINE_RING_MAX_MUSCLES))
+    return NULL;
+  
+  int noInputData = 1;
+  for (int i = 0; i < N_DOF; ++i)
+    noInputData *= (n[i]+1);
+  std::vector< std::vector<double> > y(muscleNames.size(), std::vector<double>(noInputData));
+  for (int j = 0; j < noInputData; ++j)
+    for (unsigned int i = 0; i < muscleNames.size(); ++i)
+      inputDataFile >> y[i][j];
+  if (!inputDataFile)
+    return NULL;
+  
+  return new ModelSnapshot(file, a, b, n, muscleNames, y);
+}
+
+
+SplineServer::SplineServer(const std::string& socketPath, const std::vector<std::string>& modelFiles)
+:socketPath_(socketPath), listenFd_(-1), stop_(false), noRings_(0), noOpenRings_(0) {
+  
+  for (unsigned int i = 0; i < modelFiles.size(); ++i) {
+    ModelSnapshot* snapshot = loadModel(modelFiles[i]);
+    if (snapshot == NULL) {
+      std::cout << "ERROR: " << modelFiles[i] << " could not be read or has a wrong grid\n";
+      exit(EXIT_FAILURE);
+    }
+    models_.push_back(new Model(snapshot, MAX_READERS));
+  }
+  
+  sockaddr_un address;
+  memset(&address, 0, sizeof(address));
+  address.sun_family = AF_UNIX;
+  if (socketPath_.size() >= sizeof(address.sun_path)) {
+    std::cout << "ERROR: socket path " << socketPath_ << " is too long\n";
+    exit(EXIT_FAILURE);
+  }
+  strcpy(address.sun_path, socketPath_.c_str());
+  unlink(socketPath_.c_str());
+  
+  listenFd_ = socket(AF_UNIX, SOCK_STREAM, 0);
+  if (listenFd_ < 0 || bind(listenFd_, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0
+      || listen(listenFd_, 64) != 0) {
+    std::cout << "ERROR: cannot listen on " << socketPath_ << ": " << strerror(errno) << std::endl;
+    exit(EXIT_FAILURE);
+  }
+}
+
+
+SplineServer::~SplineServer() {
+  stop_ = true;
+  {
+    std::unique_lock<std::mutex> lock(clientsMutex_);
+    for (std::set<int>::iterator it = clientFds_.begin(); it != clientFds_.end(); ++it)
+      shutdown(*it, SHUT_RDWR);
+    while (!clientFds_.empty())
+      clientsDone_.wait(lock);
+  }
+  
+  close(listenFd_);
+  unlink(socketPath_.c_str());
+  for (unsigned int i = 0; i < models_.size(); ++i)
+    delete models_[i];
+}
+
+
+void SplineServer::run() {
+  while (!stop_) {
+    pollfd listener;
+    listener.fd = listenFd_;
+    listener.events = POLLIN;
+    if (poll(&listener, 1, 200) <= 0)
+      continue;
+    int fd = accept(listenFd_, NULL, NULL);
+    if (fd < 0)
+      continue;
+    std::lock_guard<std::mutex> lock(clientsMutex_);
+    clientFds_.insert(fd);
+    std::thread(&SplineServer::serveClient, this, fd).detach();
+  }
+}
+
+
+void SplineServer::serveClient(const int fd) {
+  std::string pending, command;
+  SplineRingHeader* ring = NULL;
+  std::string ringName;
+  std::atomic<bool> stopRing(false);
+  std::thread ringThread;
+  
+  while (readControlLine(fd, pending, command)) {
+    std::string reply;
+    if (command == "LIST")
+      reply = listModels();
+    else if (command.compare(0, 6, "RELOAD") == 0)
+      reply = reloadModel(command);
+    else if (command == "OPEN" && ring == NULL) {
+      ring = createRing(ringName);
+      if (ring == NULL)
+        reply = "ERROR cannot open a ring";
+      else {
+        ringThread = std::thread(&SplineServer::serveRing, this, ring, std::cref(stopRing));
+        reply = "OK " + ringName;
+      }
+    }
+    else
+      reply = "ERROR unknown command " + command;
+    if (!writeControlLine(fd, reply))
+      break;
+  }
+  
+  // the client is gone
+  if (ring != NULL) {
+    stopRing = true;
+    ringThread.join();
+    munmap(ring, SPLINE_RING_SIZE);
+    shm_unlink(ringName.c_str());
+  }
+  std::lock_guard<std::mutex> lock(clientsMutex_);
+  if (ring != NULL)
+    --noOpenRings_;
+  clientFds_.erase(fd);
+  close(fd);
+  clientsDone_.notify_all();
+}
+
+
+std::string SplineServer::listModels() {
+  std::lock_guard<std::mutex> lock(controlMutex_);
+  std::stringstream reply;
+  for (unsigned int m = 0; m < models_.size(); ++m) {
+    Model::Reader reader(*models_[m]);
+    const ModelSnapshot* model = reader.acquire();
+    reply << m << " " << N_DOF << " " << model->splines_.getNumberOfMuscles();
+    reply.precision(17);
+    for (int i = 0; i < N_DOF; ++i)
+      reply << " " << model->a_[i] << " " << model->b_[i];
+    for (int k = 0; k < model->splines_.getNumberOfMuscles(); ++k)
+      reply << " " << model->splines_.getMuscleName(k);
+    reply << " " << model->file_ << "\n";
+    reader.release();
+  }
+  reply << "END";
+  return reply.str();
+}
+
+
+// the model is refitted while the rings keep evaluating the old one
+std::string SplineServer::reloadModel(const std::string& command) {
+  std::stringstream myStream(command);
+  std::string keyword, file;
+  unsigned int index;
+  if (!(myStream >> keyword >> index) || index >= models_.size())
+    return "ERROR wrong model";
+  
+  std::lock_guard<std::mutex> lock(controlMutex_);
+  Model::Reader reader(*models_[index]);
+  const ModelSnapshot* current = reader.acquire();
+  if (!(myStream >> file))
+    file = current->file_;
+  ModelSnapshot* snapshot = loadModel(file);
+  if (snapshot == NULL)
+    return "ERROR " + file + " could not be read or has a wrong grid";
+  
+  bool sameMuscles = (snapshot->splines_.getNumberOfMuscles() == current->splines_.getNumberOfMuscles());
+  for (int k = 0; sameMuscles && k < current->splines_.getNumberOfMuscles(); ++k)
+    sameMuscles = (snapshot->splines_.getMuscleName(k) == current->splines_.getMuscleName(k));
+  reader.release();
+  if (!sameMuscles) {
+    delete snapshot;
+    return "ERROR " + file + " has different muscles";
+  }
+  
+  models_[index]->publish(snapshot);
+  return "OK";
+}
+
+
+SplineRingHeader* SplineServer::createRing(std::string& name) {
+  std::stringstream myStream;
+  {
+    std::lock_guard<std::mutex> lock(clientsMutex_);
+    if (noOpenRings_ == MAX_RINGS)
+      return NULL;
+    ++noOpenRings_;
+    myStream << "/splineServer." << getpid() << "." << noRings_++;
+  }
+  name = myStream.str();
+  
+  void* memory = MAP_FAILED;
+  int fd = shm_open(name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600);
+  if (fd >= 0) {
+    if (ftruncate(fd, SPLINE_RING_SIZE) == 0)
+      memory = mmap(NULL, SPLINE_RING_SIZE, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (memory == MAP_FAILED)
+      shm_unlink(name.c_str());
+  }
+  if (memory == MAP_FAILED) {
+    std::lock_guard<std::mutex> lock(clientsMutex_);
+    --noOpenRings_;
+    return NULL;
+  }
+  
+  SplineRingHeader* ring = new (memory) SplineRingHeader;
+  ring->noSlots_ = SPLINE_RING_SLOTS;
+  ring->maxFrames_ = SPLINE_RING_MAX_FRAMES;
+  ring->maxDim_ = SPLINE_RING_MAX_DIM;
+  ring->maxMuscles_ = SPLINE_RING_MAX_MUSCLES;
+  ring->slotSize_ = SPLINE_RING_SLOT_SIZE;
+  ring->requested_.store(0);
+  ring->served_.store(0);
+  ring->magic_ = SPLINE_RING_MAGIC;
+  return ring;
+}
+
+
+// spins while requests keep coming, then yields and finally sleeps,
+// so that idle clients do not keep a core busy
+void SplineServer::serveRing(SplineRingHeader* ring, const std::atomic<bool>& stopRing) {
+  std::vector<Model::Reader*> readers;
+  for (unsigned int m = 0; m < models_.size(); ++m)
+    readers.push_back(new Model::Reader(*models_[m]));
+  
+  uint64_t served = ring->served_.load(std::memory_order_relaxed);
+  int idle = 0;
+  while (!stopRing && !stop_) {
+    if (ring->requested_.load(std::memory_order_acquire) == served) {
+      ++idle;
+      if (idle > 20000)
+        usleep(100);
+      else if (idle > 10000)
+        sched_yield();
+      continue;
+    }
+    idle = 0;
+    evaluate(*getSplineRequest(ring, served), readers);
+    ring->served_.store(++served, std::memory_order_release);
+  }
+  
+  for (unsigned int m = 0; m < readers.size(); ++m)
+    delete readers[m];
+}
+
+
+void SplineServer::evaluate(SplineRequest& request, std::vector<Model::Reader*>& readers) {
+  if (request.model_ < 0 || request.model_ >= static_cast<int>(models_.size())) {
+    request.status_ = SPLINE_REQUEST_WRONG_MODEL;
+    return;
+  }
+  if (request.noFrames_ < 0 || request.noFrames_ > SPLINE_RING_MAX_FRAMES) {
+    request.status_ = SPLINE_REQUEST_TOO_MANY_FRAMES;
+    return;
+  }
+  
+  Model::Reader& reader = *readers[request.model_];
+  const ModelSnapshot* model = reader.acquire();
+  const int noMuscles = model->splines_.getNumberOfMuscles();
+  const double* x = request.x();
+  double* lmt = request.lmt();
+  double* ma = request.ma();
+  std::vector<double> pose(N_DOF);
+  request.status_ = SPLINE_REQUEST_OK;
+  
+  // a frame out of bounds gets NaN and the status, the others are evaluated
+  for (int f = 0; f < request.noFrames_; ++f) {
+    bool inside = true;
+    for (int i = 0; i < N_DOF; ++i) {
+      pose[i] = x[f*N_DOF + i];
+      // written so that NaN is out too
+      if (!(pose[i] >= model->a_[i] && pose[i] <= model->b_[i]))
+        inside = false;
+    }
+    if (!inside) {
+      request.status_ = SPLINE_REQUEST_OUT_OF_BOUNDS;
+      std::fill(lmt + f*noMuscles, lmt + (f+1)*noMuscles, NAN);
+      if (request.withDerivatives_)
+        std::fill(ma + f*noMuscles*N_DOF, ma + (f+1)*noMuscles*N_DOF, NAN);
+      continue;
+    }
+    for (int k = 0; k < noMuscles; ++k) {
+      const Spline<N_DOF>& spline = model->splines_.getSpline(k);
+      lmt[f*noMuscles + k] = spline.getValue(pose);
+      // the moment arms, as in the ma*.in files: ma = -dlmt/dq
+      if (request.withDerivatives_)
+        for (int i = 0; i < N_DOF; ++i)
+          ma[(f*noMuscles + k)*N_DOF + i] = -spline.getFirstDerivative(pose, i);
+    }
+  }
+  reader.release();
+}
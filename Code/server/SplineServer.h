@@ -0,0 +1,91 @@
+// Copyright (c) 2011, Massimo Sartori and Monica Reggiani
+// All rights reserved.
+
+// Redistribution and use in source and binary forms, with or without 
+// modification, are permitted provided that the following conditions are met:
+// - Redistributions of source code must retain the above copyright notice, 
+//   this list of conditions and the following disclaimer.
+// - Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+
+
+
+#ifndef SplineServer_h
+#define SplineServer_h
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <set>
+#include <string>
+#include <vector>
+
+#include "Spline.h"
+#include "SplineSet.h"
+#include "SnapshotHolder.h"
+#include "SplineServerProtocol.h"
+
+const int N_DOF = 4;
+
+
+// Owns the splines fitted from a list of lmt.in files and evaluates them for
+// the clients connected on a Unix-domain socket (see SplineServerProtocol.h).
+// Each client gets its own shared memory ring, served by its own thread.
+class SplineServer {
+  public:
+    SplineServer(const std::string& socketPath, const std::vector<std::string>& modelFiles);
+    ~SplineServer();
+    // accepts clients until stop() is called, e.g. by a signal handler
+    void run();
+    void stop() { stop_ = true; }
+    
+  private:
+    // what the ring threads read: replaced as a whole on RELOAD
+    struct ModelSnapshot {
+      std::string file_;
+      double a_[N_DOF], b_[N_DOF];
+      SplineSet<N_DOF> splines_;
+      ModelSnapshot(const std::string& file, const std::vector<double>& a, const std::vector<double>& b,
+                    const std::vector<int>& n, const std::vector<std::string>& muscleNames,
+                    const std::vector< std::vector<double> >& y);
+    };
+    typedef SnapshotHolder<ModelSnapshot> Model;
+    
+    std::string socketPath_;
+    int listenFd_;
+    std::atomic<bool> stop_;
+    std::vector<Model*> models_;
+    // LIST and RELOAD are serialized, so they need a single reader per model
+    std::mutex controlMutex_;
+    
+    std::mutex clientsMutex_;
+    std::condition_variable clientsDone_;
+    std::set<int> clientFds_;
+    int noRings_;
+    int noOpenRings_;
+    
+    SplineServer(const SplineServer&);
+    SplineServer& operator=(const SplineServer&);
+    static ModelSnapshot* loadModel(const std::string& file);
+    void serveClient(const int fd);
+    std::string listModels();
+    std::string reloadModel(const std::string& command);
+    SplineRingHeader* createRing(std::string& name);
+    void serveRing(SplineRingHeader* ring, const std::atomic<bool>& stopRing);
+    void evaluate(SplineRequest& request, std::vector<Model::Reader*>& readers);
+};
+
+#endif
@@ -0,0 +1,133 @@
+// Copyright (c) 2011, Massimo Sartori and Monica Reggiani
+// All rights reserved.
+
+// Redistribution and use in source and binary forms, with or without 
+// modification, are permitted provided that the following conditions are met:
+// - Redistributions of source code must retain the above copyright notice, 
+//   this list of conditions and the following disclaimer.
+// - Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+
+
+
+#ifndef SplineServerProtocol_h
+#define SplineServerProtocol_h
+
+#include <atomic>
+#include <string>
+#include <stddef.h>
+#include <stdint.h>
+#include <unistd.h>
+
+// Shared memory protocol between SplineServer and SplineClient.
+//
+// Control, on a Unix-domain stream socket, one text line per command:
+//   LIST            -> one line per model:
+//                      <index> <dim> <noMuscles> <a_0> <b_0> ... <a_dim-1> <b_dim-1> <muscle_0> ... <file>
+//                      then END
+//   OPEN            -> OK <shared memory name>: a ring reserved to this connection
+//   RELOAD <index> [<lmt.in file>]
+//                   -> OK once the model has been refitted and published; the
+//                      muscles and the DOFs must not change
+// Closing the connection releases the ring.
+//
+// Ring: a single-producer/single-consumer queue of slots in shared memory.
+// The client fills slot (requested_ % noSlots) and increments requested_;
+// the server evaluates it in place and increments served_. A frame out of
+// bounds gets NaN in lmt and ma, and the status of the slot is
+// SPLINE_REQUEST_OUT_OF_BOUNDS; the other frames are evaluated. A slot can be
+// reused once served_ has passed it, so nothing is ever locked.
+
+const uint32_t SPLINE_RING_MAGIC = 0x5350524e;   // "SPRN"
+const int SPLINE_RING_SLOTS = 8;
+const int SPLINE_RING_MAX_FRAMES = 256;
+const int SPLINE_RING_MAX_DIM = 8;
+const int SPLINE_RING_MAX_MUSCLES = 64;
+
+enum SplineRequestStatus {
+  SPLINE_REQUEST_OK = 0,
+  SPLINE_REQUEST_WRONG_MODEL = -1,
+  SPLINE_REQUEST_OUT_OF_BOUNDS = -2,
+  SPLINE_REQUEST_TOO_MANY_FRAMES = -3,
+  SPLINE_REQUEST_SERVER_LOST = -4      // the server died or did not answer in time
+};
+
+// std::atomic<uint64_t> must be lock free to work between processes
+static_assert(ATOMIC_LLONG_LOCK_FREE == 2, "the ring needs lock-free 64 bit atomics");
+
+struct SplineRingHeader {
+  uint32_t magic_;
+  uint32_t noSlots_;
+  uint32_t maxFrames_;
+  uint32_t maxDim_;
+  uint32_t maxMuscles_;
+  uint32_t slotSize_;
+  alignas(64) std::atomic<uint64_t> requested_;   // written by the client only
+  alignas(64) std::atomic<uint64_t> served_;      // written by the server only
+};
+
+// x, lmt and ma of a slot are frame-major:
+//   x[frame*dim + dof], lmt[frame*noMuscles + muscle],
+//   ma[(frame*noMuscles + muscle)*dim + dof], the moment arm -dlmt/dq
+struct SplineRequest {
+  int32_t model_;
+  int32_t noFrames_;
+  int32_t withDerivatives_;
+  int32_t status_;
+  double* x() { return reinterpret_cast<double*>(this + 1); }
+  double* lmt() { return x() + SPLINE_RING_MAX_FRAMES*SPLINE_RING_MAX_DIM; }
+  double* ma() { return lmt() + SPLINE_RING_MAX_FRAMES*SPLINE_RING_MAX_MUSCLES; }
+};
+
+const size_t SPLINE_RING_SLOT_SIZE = (sizeof(SplineRequest)
+  + sizeof(double)*SPLINE_RING_MAX_FRAMES*(SPLINE_RING_MAX_DIM + SPLINE_RING_MAX_MUSCLES*(1 + SPLINE_RING_MAX_DIM)) + 63) / 64 * 64;
+const size_t SPLINE_RING_HEADER_SIZE = (sizeof(SplineRingHeader) + 63) / 64 * 64;
+const size_t SPLINE_RING_SIZE = SPLINE_RING_HEADER_SIZE + SPLINE_RING_SLOTS*SPLINE_RING_SLOT_SIZE;
+
+inline SplineRequest* getSplineRequest(SplineRingHeader* ring, const uint64_t sequence) {
+  return reinterpret_cast<SplineRequest*>(reinterpret_cast<char*>(ring) + SPLINE_RING_HEADER_SIZE
+                                          + (sequence % ring->noSlots_) * SPLINE_RING_SLOT_SIZE);
+}
+
+// one line of the control protocol; pending keeps what was read after it
+inline bool readControlLine(const int fd, std::string& pending, std::string& line) {
+  size_t end;
+  while ((end = pending.find('\n')) == std::string::npos) {
+    char buffer[4096];
+    ssize_t noRead = read(fd, buffer, sizeof(buffer));
+    if (noRead <= 0)
+      return false;
+    pending.append(buffer, noRead);
+  }
+  line = pending.substr(0, end);
+  pending.erase(0, end+1);
+  return true;
+}
+
+
+inline bool writeControlLine(const int fd, const std::string& line) {
+  std::string message = line + "\n";
+  size_t written = 0;
+  while (written < message.size()) {
+    ssize_t noWritten = write(fd, message.data() + written, message.size() - written);
+    if (noWritten <= 0)
+      return false;
+    written += noWritten;
+  }
+  return true;
+}
+
+#endif
@@ -0,0 +1,164 @@
+// Copyright (c) 2011, Massimo Sartori and Monica Reggiani
+// All rights reserved.
+
+// Redistribution and use in source and binary forms, with or without 
+// modification, are permitted provided that the following conditions are met:
+// - Redistributions of source code must retain the above copyright notice, 
+//   this list of conditions and the following disclaimer.
+// - Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+
+
+
+#include <iostream>
+using std::cout;
+using std::endl;
+#include <vector>
+using std::vector;
+#include <algorithm>
+#include <chrono>
+#include <stdlib.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "SplineClient.h"
+
+// what each client process writes back in shared memory
+struct ClientTimes {
+  double start_, end_;
+  int status_;
+};
+
+
+double now() {
+  return std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+
+void runClient(const char* socketPath, const int noRequests, const int framesPerRequest, const bool withDerivatives,
+               const int seed, double* latencies, ClientTimes& times) {
+  SplineClient client(socketPath);
+  const int model = 0;
+  const int dim = client.getDimension(model);
+  const int noMuscles = client.getNumberOfMuscles(model);
+  
+  srand(seed);
+  vector<double> x(framesPerRequest * dim);
+  for (int f = 0; f < framesPerRequest; ++f)
+    for (int i = 0; i < dim; ++i)
+      x[f*dim + i] = client.getLowerBound(model, i)
+                     + (client.getUpperBound(model, i) - client.getLowerBound(model, i)) * rand() / RAND_MAX;
+  vector<double> lmt(framesPerRequest * noMuscles);
+  vector<double> ma(framesPerRequest * noMuscles * dim);
+  double* maPtr = withDerivatives ? &ma[0] : NULL;
+  
+  for (int r = 0; r < 10; ++r)
+    client.evaluate(model, framesPerRequest, &x[0], &lmt[0], maPtr);
+  
+  times.status_ = SPLINE_REQUEST_OK;
+  times.start_ = now();
+  for (int r = 0; r < noRequests; ++r) {
+    double before = now();
+    int status = client.evaluate(model, framesPerRequest, &x[0], &lmt[0], maPtr);
+    latencies[r] = now() - before;
+    if (status != SPLINE_REQUEST_OK)
+      times.status_ = status;
+  }
+  times.end_ = now();
+}
+
+
+double percentile(const vector<double>& sorted, const double p) {
+  return sorted[std::min(sorted.size() - 1, static_cast<size_t>(p * sorted.size()))];
+}
+
+
+int main(int argc, const char* argv[])
+{
+  if ( argc < 2 || argc > 6 ) {
+    cout << "Usage: loadTest socketPath [noClients] [noRequests] [framesPerRequest] [withDerivatives]\n";
+    cout << " runs noClients processes, each sending noRequests batches of framesPerRequest\n";
+    cout << " random poses to the first model of a running splineServer\n";
+    exit(EXIT_FAILURE);
+  }
+  const int noClients = (argc > 2) ? atoi(argv[2]) : 4;
+  const int noRequests = (argc > 3) ? atoi(argv[3]) : 10000;
+  const int framesPerRequest = (argc > 4) ? atoi(argv[4]) : 64;
+  const bool withDerivatives = (argc > 5) ? atoi(argv[5]) != 0 : true;
+  if (noClients < 1 || noRequests < 1 || framesPerRequest < 1) {
+    cout << "ERROR: noClients, noRequests and framesPerRequest must be positive\n";
+    exit(EXIT_FAILURE);
+  }
+  
+  size_t sizeOfResults = noClients * (sizeof(ClientTimes) + noRequests * sizeof(double));
+  void* results = mmap(NULL, sizeOfResults, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+  if (results == MAP_FAILED) {
+    cout << "ERROR: cannot allocate the shared results\n";
+    exit(EXIT_FAILURE);
+  }
+  ClientTimes* times = static_cast<ClientTimes*>(results);
+  double* latencies = reinterpret_cast<double*>(times + noClients);
+  
+  for (int c = 0; c < noClients; ++c) {
+    pid_t pid = fork();
+    if (pid == 0) {
+      runClient(argv[1], noRequests, framesPerRequest, withDerivatives, c + 1, latencies + c*noRequests, times[c]);
+      _exit(EXIT_SUCCESS);
+    }
+    if (pid < 0) {
+      cout << "ERROR: cannot start client " << c << endl;
+      exit(EXIT_FAILURE);
+    }
+  }
+  
+  bool failed = false;
+  for (int c = 0; c < noClients; ++c) {
+    int childStatus;
+    wait(&childStatus);
+    if (!WIFEXITED(childStatus) || WEXITSTATUS(childStatus) != EXIT_SUCCESS)
+      failed = true;
+  }
+  for (int c = 0; c < noClients; ++c)
+    if (times[c].status_ != SPLINE_REQUEST_OK)
+      failed = true;
+  if (failed) {
+    cout << "ERROR: some clients failed\n";
+    exit(EXIT_FAILURE);
+  }
+  
+  double start = times[0].start_, end = times[0].end_;
+  for (int c = 1; c < noClients; ++c) {
+    start = std::min(start, times[c].start_);
+    end = std::max(end, times[c].end_);
+  }
+  vector<double> sorted(latencies, latencies + noClients*noRequests);
+  std::sort(sorted.begin(), sorted.end());
+  double noFrames = static_cast<double>(noClients) * noRequests * framesPerRequest;
+  
+  cout << noClients << " clients, " << noRequests << " requests of " << framesPerRequest << " frames each"
+       << (withDerivatives ? ", with moment arms\n" : "\n");
+  cout << "Throughput: " << noClients * noRequests / (end - start) << " requests/s, "
+       << noFrames / (end - start) << " frames/s\n";
+  cout << "Latency (us): p50 " << percentile(sorted, 0.5) * 1e6
+       << " p90 " << percentile(sorted, 0.9) * 1e6
+       << " p99 " << percentile(sorted, 0.99) * 1e6
+       << " p99.9 " << percentile(sorted, 0.999) * 1e6
+       << " max " << sorted.back() * 1e6 << endl;
+  
+  munmap(results, sizeOfResults);
+  exit(EXIT_SUCCESS);
+}
@@ -0,0 +1,67 @@
+// Copyright (c) 2011, Massimo Sartori and Monica Reggiani
+// All rights reserved.
+
+// Redistribution and use in source and binary forms, with or without 
+// modification, are permitted provided that the following conditions are met:
+// - Redistributions of source code must retain the above copyright notice, 
+//   this list of conditions and the following disclaimer.
+// - Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+
+
+
+#include <iostream>
+using std::cout;
+using std::endl;
+#include <string>
+using std::string;
+#include <vector>
+using std::vector;
+#include <stdlib.h>
+#include <signal.h>
+
+#include "SplineServer.h"
+
+SplineServer* server = NULL;
+
+extern "C" void stopServer(int) {
+  if (server != NULL)
+    server->stop();
+}
+
+
+int main(int argc, const char* argv[])
+{
+  if ( argc < 3 ) {
+    cout << "Usage: splineServer socketPath lmtFile [lmtFile ...]\n";
+    cout << " socketPath: Unix-domain socket the clients connect to\n";
+    cout << " lmtFile: input data of a model, as InputData/lmt.in of testSpline\n";
+    exit(EXIT_FAILURE);
+  }
+  
+  vector<string> modelFiles(argv + 2, argv + argc);
+  cout << "Fitting " << modelFiles.size() << " models\n";
+  server = new SplineServer(argv[1], modelFiles);
+  
+  signal(SIGINT, stopServer);
+  signal(SIGTERM, stopServer);
+  signal(SIGPIPE, SIG_IGN);
+  cout << "Serving on " << argv[1] << endl;
+  server->run();
+  
+  delete server;
+  exit(EXIT_SUCCESS);
+}
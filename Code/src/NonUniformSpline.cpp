@@ -0,0 +1,318 @@
+// Copyright (c) 2011, Massimo Sartori and Monica Reggiani
+// All rights reserved.
+
+// Redistribution and use in source and binary forms, with or without 
+// modification, are permitted provided that the following conditions are met:
+// - Redistributions of source code must retain the above copyright notice, 
+//   this list of conditions and the following disclaimer.
+// - Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+
+
+
+#include <math.h>
+#include <stdlib.h>
+#include <iostream>
+#include <algorithm>
+
+//#define LOG_SPLINE
+
+template< int dim >
+NonUniformSpline<dim>::NonUniformSpline(const std::vector< std::vector<double> >& nodes)
+:nodes_(nodes), knots_(dim), n_(dim), stride_(dim), bucketWidth_(dim), intervalOfBucket_(dim), fitMatrix_(dim) {
+
+  if (nodes_.size() != dim) {
+    std::cout << "We have " << nodes_.size() << " axes of nodes for a NonUniformSpline<" << dim << ">\n";
+    exit(EXIT_FAILURE);
+  }
+  
+  for (int i = 0; i < dim; ++i) {
+    const std::vector<double>& axisNodes = nodes_[i];
+    n_[i] = axisNodes.size() - 1;
+    if (n_[i] < 2) {
+      std::cout << "Axis " << i << " needs at least 3 nodes\n";
+      exit(EXIT_FAILURE);
+    }
+    
+    double minInterval = axisNodes[n_[i]] - axisNodes[0];
+    for (int j = 0; j < n_[i]; ++j) {
+      if (axisNodes[j+1] <= axisNodes[j]) {
+        std::cout << "Nodes of axis " << i << " are not increasing\n";
+        exit(EXIT_FAILURE);
+      }
+      minInterval = std::min(minInterval, axisNodes[j+1] - axisNodes[j]);
+    }
+    const double range = axisNodes[n_[i]] - axisNodes[0];
+    
+    // three more knots on each side, spaced as the first and the last interval
+    double firstInterval = axisNodes[1] - axisNodes[0];
+    double lastInterval = axisNodes[n_[i]] - axisNodes[n_[i]-1];
+    for (int j = 3; j > 0; --j)
+      knots_[i].push_back(axisNodes[0] - j * firstInterval);
+    knots_[i].insert(knots_[i].end(), axisNodes.begin(), axisNodes.end());
+    for (int j = 1; j <= 3; ++j)
+      knots_[i].push_back(axisNodes[n_[i]] + j * lastInterval);
+    
+    // clustered nodes would ask for too many buckets: they are capped, and
+    // the nodes left inside a bucket are searched by bisection
+    const int maxBuckets = 4 * (n_[i] + 1);
+    const int noBuckets = (range / minInterval < maxBuckets) ? static_cast<int>(range / minInterval) + 1 : maxBuckets;
+    bucketWidth_[i] = std::max(minInterval, range / noBuckets);
+    // one more entry: the interval where the last bucket ends
+    intervalOfBucket_[i].resize(noBuckets + 1);
+    int l = 0;
+    for (int k = 0; k <= noBuckets; ++k) {
+      double bucketBegin = axisNodes[0] + k * bucketWidth_[i];
+      while ( (l < n_[i]-1) && (axisNodes[l+1] <= bucketBegin) )
+        ++l;
+      intervalOfBucket_[i][k] = l;
+    }
+    
+    computeFitMatrix(i);
+  }
+  
+  int sizeOfCoeff = 1;
+  sizeOfY_ = 1;
+  for (int i = 0; i < dim; ++i) {
+    stride_[i] = sizeOfCoeff;
+    sizeOfCoeff *= ( n_[i] + 3 );
+    sizeOfY_ *= ( n_[i] + 1 );
+  }
+  c_.resize(sizeOfCoeff);
+  
+#ifdef LOG_SPLINE
+  std::cout << " Created NonUniformSpline<" << dim << "> with " << sizeOfCoeff 
+            << " coefficients and " << sizeOfY_ << " Y data" << std::endl;
+#endif 
+}
+
+
+// Build the (n+3)x(n+3) interpolation system of the axis: second derivative
+// on the first node, values on all the nodes, second derivative on the last
+// node. Its right-hand side is a linear function of the data, so solving it
+// once for every node gives the matrix mapping the data to the coefficients.
+// The system is small and solved once, so a dense elimination is enough.
+template< int dim >
+void NonUniformSpline<dim>::computeFitMatrix(const int axis) {
+  const std::vector<double>& t = nodes_[axis];
+  const double* knots = &knots_[axis][0];
+  int n = n_[axis];
+  int noCoeff = n + 3;
+  int noData = n + 1;
+  
+  std::vector<double> A(noCoeff * noCoeff, 0.);
+  std::vector<double> R(noCoeff * noData, 0.);
+  double ders[3][4];
+
+  NonUniformSplineBasisFunction::getDerivatives(t[0], 0, knots, 2, ders);
+  for (int j = 0; j < 4; ++j)
+    A[j] = ders[2][j];
+  double h0 = t[1] - t[0], h1 = t[2] - t[1];
+  R[0] = 2 / ( h0 * ( h0 + h1 ) );
+  R[1] = -2 / ( h0 * h1 );
+  R[2] = 2 / ( h1 * ( h0 + h1 ) );
+
+  for (int k = 0; k <= n; ++k) {
+    int l = std::min(k, n-1);
+    NonUniformSplineBasisFunction::getValues(t[k], l, knots, ders[0]);
+    for (int j = 0; j < 4; ++j)
+      A[(k+1) * noCoeff + l + j] = ders[0][j];
+    R[(k+1) * noData + k] = 1;
+  }
+  
+  NonUniformSplineBasisFunction::getDerivatives(t[n], n-1, knots, 2, ders);
+  for (int j = 0; j < 4; ++j)
+    A[(n+2) * noCoeff + n-1 + j] = ders[2][j];
+  double hn1 = t[n-1] - t[n-2], hn = t[n] - t[n-1];
+  R[(n+2) * noData + n-2] = 2 / ( hn1 * ( hn1 + hn ) );
+  R[(n+2) * noData + n-1] = -2 / ( hn1 * hn );
+  R[(n+2) * noData + n]   = 2 / ( hn * ( hn1 + hn ) );
+
+  // Gauss-Jordan elimination with partial pivoting on [A | R]
+  for (int col = 0; col < noCoeff; ++col) {
+    int pivot = col;
+    for (int row = col+1; row < noCoeff; ++row)
+      if (fabs(A[row * noCoeff + col]) > fabs(A[pivot * noCoeff + col]))
+        pivot = row;
+    if (pivot != col) {
+      std::swap_ranges(A.begin() + col * noCoeff, A.begin() + (col+1) * noCoeff, A.begin() + pivot * noCoeff);
+      std::swap_ranges(R.begin() + col * noData, R.begin() + (col+1) * noData, R.begin() + pivot * noData);
+    }
+    double m = 1 / A[col * noCoeff + col];
+    for (int j = 0; j < noCoeff; ++j) A[col * noCoeff + j] *= m;
+    for (int j = 0; j < noData; ++j)  R[col * noData + j] *= m;
+    for (int row = 0; row < noCoeff; ++row) {
+      double f = A[row * noCoeff + col];
+      if ( (row == col) || (f == 0) ) 
+        continue;
+      for (int j = 0; j < noCoeff; ++j) A[row * noCoeff + j] -= f * A[col * noCoeff + j];
+      for (int j = 0; j < noData; ++j)  R[row * noData + j] -= f * R[col * noData + j];
+    }
+  }
+  
+  fitMatrix_[axis] = R;
+}
+
+
+template< int dim >
+void NonUniformSpline<dim>::applyAlongAxis(const std::vector<double>& in, std::vector<int>& shape, const int axis,
+                                           const std::vector<double>& matrix, const int rows, std::vector<double>& out) {
+  int inner = 1;
+  for (int i = 0; i < axis; ++i)
+    inner *= shape[i];
+  int cols = shape[axis];
+  int outer = 1;
+  for (int i = axis+1; i < dim; ++i)
+    outer *= shape[i];
+  
+  out.assign(inner * rows * outer, 0.);
+  for (int o = 0; o < outer; ++o) 
+    for (int r = 0; r < rows; ++r) {
+      double* dst = &out[(o * rows + r) * inner];
+      for (int c = 0; c < cols; ++c) {
+        double m = matrix[r * cols + c];
+        if (m == 0)
+          continue;
+        const double* src = &in[(o * cols + c) * inner];
+        for (int i = 0; i < inner; ++i)
+          dst[i] += m * src[i];
+      }
+    }
+  shape[axis] = rows;
+}
+
+
+template< int dim >
+void NonUniformSpline<dim>::computeCoefficients(const std::vector<double>& /* y */, std::vector<double>::const_iterator fromWhereInY) {
+  std::vector<double> current(fromWhereInY, fromWhereInY + sizeOfY_);
+  std::vector<double> next;
+  std::vector<int> shape(dim);
+  for (int i = 0; i < dim; ++i)
+    shape[i] = n_[i] + 1;
+  
+  // the interpolation is separable: fit one axis after the other
+  for (int i = 0; i < dim; ++i) {
+    applyAlongAxis(current, shape, i, fitMatrix_[i], n_[i]+3, next);
+    current.swap(next);
+  }
+  c_.swap(current);
+  
+#ifdef LOG_SPLINE
+  std::cout << "NonUniformSpline<" << dim << ">'s " << c_.size() <<" coeffs\n";
+  for (unsigned int i = 0; i < c_.size(); ++i)
+    std::cout << c_[i] << std::endl;
+#endif  
+}
+
+
+template< int dim >
+bool NonUniformSpline<dim>::checkValues(const std::vector<double>& x) const {
+  for (int i = 0; i < dim; ++i )
+    if ( (x[i] < nodes_[i][0]) || (x[i] > nodes_[i][n_[i]]) )
+      return false;
+  return true;
+}
+
+
+template< int dim >
+int NonUniformSpline<dim>::computeInterval(const int axis, const double x) const {
+  const std::vector<double>& axisNodes = nodes_[axis];
+  const int lastBucket = intervalOfBucket_[axis].size() - 2;
+  // clamped as a double, so that no cast overflows (NaN gives the first bucket)
+  const double u = ( x - axisNodes[0] ) / bucketWidth_[axis];
+  int bucket = 0;
+  if (u >= lastBucket)
+    bucket = lastBucket;
+  else if (u > 0)
+    bucket = static_cast<int>(u);
+  // the interval is between those where the bucket begins and ends; with
+  // evenly spread nodes they are the same or next to each other
+  const int first = intervalOfBucket_[axis][bucket], last = intervalOfBucket_[axis][bucket+1];
+  int l = first;
+  if (last > first)
+    l = std::upper_bound(axisNodes.begin() + first + 1, axisNodes.begin() + last + 1, x) - axisNodes.begin() - 1;
+  // the loops only absorb round-off
+  while ( (l < n_[axis]-1) && (x >= axisNodes[l+1]) )
+    ++l;
+  while ( (l > 0) && (x < axisNodes[l]) )
+    --l;
+  return l;
+}
+
+
+template< int dim >
+double NonUniformSpline<dim>::getValue(const std::vector<double>& x) const {
+  if (!checkValues(x)) {
+    std::cout << "Values x are out of boundaries\n";
+    exit(EXIT_FAILURE);
+  }
+  
+  double basis[dim][4];
+  int firstIndex = 0;
+  for (int i = 0; i < dim; ++i) {
+    int l = computeInterval(i, x[i]);
+    NonUniformSplineBasisFunction::getValues(x[i], l, &knots_[i][0], basis[i]);
+    firstIndex += l * stride_[i];
+  }
+  
+  double evaluatedValue = 0;
+  for (int soFar = 0; soFar < (1 << (2*dim)); ++soFar) {
+    int cIndex = firstIndex;
+    double currentStep = 1;
+    int rest = soFar;
+    for (int i = 0; i < dim; ++i) {
+      cIndex += (rest & 3) * stride_[i];
+      currentStep *= basis[i][rest & 3];
+      rest >>= 2;
+    }
+    evaluatedValue += c_[cIndex] * currentStep;
+  }
+  return evaluatedValue;
+}
+
+
+template< int dim >
+double NonUniformSpline<dim>::getFirstDerivative(const std::vector<double>& x, const int dimDerivative) const {
+  if (!checkValues(x)) {
+    std::cout << "Values x are out of boundaries\n";
+    exit(EXIT_FAILURE);
+  }
+  
+  double basis[dim][4];
+  int firstIndex = 0;
+  for (int i = 0; i < dim; ++i) {
+    int l = computeInterval(i, x[i]);
+    if (i == dimDerivative)
+      NonUniformSplineBasisFunction::getFirstDerivatives(x[i], l, &knots_[i][0], basis[i]);
+    else
+      NonUniformSplineBasisFunction::getValues(x[i], l, &knots_[i][0], basis[i]);
+    firstIndex += l * stride_[i];
+  }
+  
+  double evaluatedValue = 0;
+  for (int soFar = 0; soFar < (1 << (2*dim)); ++soFar) {
+    int cIndex = firstIndex;
+    double currentStep = 1;
+    int rest = soFar;
+    for (int i = 0; i < dim; ++i) {
+      cIndex += (rest & 3) * stride_[i];
+      currentStep *= basis[i][rest & 3];
+      rest >>= 2;
+    }
+    evaluatedValue += c_[cIndex] * currentStep;
+  }
+  return evaluatedValue;
+}
@@ -0,0 +1,79 @@
+// Copyright (c) 2011, Massimo Sartori and Monica Reggiani
+// All rights reserved.
+
+// Redistribution and use in source and binary forms, with or without 
+// modification, are permitted provided that the following conditions are met:
+// - Redistributions of source code must retain the above copyright notice, 
+//   this list of conditions and the following disclaimer.
+// - Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+
+
+
+#ifndef NonUniformSpline_h
+#define NonUniformSpline_h
+
+
+#include <vector>
+
+#include "NonUniformSplineBasisFunction.h"
+
+// Multidimensional cubic Bspline on a grid with non-uniformly spaced nodes.
+// The nodes of each axis are given explicitly, and y is sampled on all their
+// combinations with the same ordering used by Spline<dim> (first DOF running
+// fastest). The coefficients interpolate y, with the same end conditions
+// of Spline<dim>: the second derivative on the first and last node of each
+// axis matches the second divided difference of the data.
+template <int dim>
+class NonUniformSpline {
+  private:
+    std::vector< std::vector<double> > nodes_;
+    std::vector< std::vector<double> > knots_;
+    std::vector<int> n_;
+    std::vector<int> stride_;
+    
+    // Interval lookup: at most 4(n+1) buckets per axis, as wide as its
+    // smallest interval if that fits, so the interval of x is found in O(1)
+    // for spread nodes; the clustered nodes left inside a bucket are
+    // bisected. intervalOfBucket_ holds the interval where each bucket
+    // begins, and where the last one ends
+    std::vector<double> bucketWidth_;
+    std::vector< std::vector<int> > intervalOfBucket_;
+    
+    // fitMatrix_[i] maps the n_[i]+1 values on the nodes of axis i to its
+    // n_[i]+3 coefficients (row-major)
+    std::vector< std::vector<double> > fitMatrix_;
+    
+    int sizeOfY_;
+    std::vector<double> c_; 
+
+    bool checkValues(const std::vector<double>& x) const;
+    int computeInterval(const int axis, const double x) const;
+    void computeFitMatrix(const int axis);
+    static void applyAlongAxis(const std::vector<double>& in, std::vector<int>& shape, const int axis,
+                               const std::vector<double>& matrix, const int rows, std::vector<double>& out);
+    
+  public:
+    NonUniformSpline(const std::vector< std::vector<double> >& nodes);
+    // as Spline<dim>: only fromWhereInY is read, y is there for the same calls
+    void computeCoefficients(const std::vector<double>& y, std::vector<double>::const_iterator fromWhereInY);
+    double getValue(const std::vector<double>& x) const;
+    double getFirstDerivative(const std::vector<double>& x, const int dimDerivative) const;
+};
+
+
+
+#endif
@@ -0,0 +1,97 @@
+// Copyright (c) 2011, Massimo Sartori and Monica Reggiani
+// All rights reserved.
+
+// Redistribution and use in source and binary forms, with or without 
+// modification, are permitted provided that the following conditions are met:
+// - Redistributions of source code must retain the above copyright notice, 
+//   this list of conditions and the following disclaimer.
+// - Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+
+#include "NonUniformSplineBasisFunction.h"
+
+void NonUniformSplineBasisFunction::getValues(double x, int l, const double* knots, double values[4]) {
+  double ders[3][4];
+  getDerivatives(x, l, knots, 0, ders);
+  for (int j = 0; j < 4; ++j)
+    values[j] = ders[0][j];
+}
+
+void NonUniformSplineBasisFunction::getFirstDerivatives(double x, int l, const double* knots, double derivatives[4]) {
+  double ders[3][4];
+  getDerivatives(x, l, knots, 1, ders);
+  for (int j = 0; j < 4; ++j)
+    derivatives[j] = ders[1][j];
+}
+
+// Algorithm A2.3 of Piegl and Tiller, The NURBS Book, for degree 3
+void NonUniformSplineBasisFunction::getDerivatives(double x, int l, const double* knots, int noDerivatives, double ders[3][4]) {
+  const int p = 3;
+  int span = l + p;
+  double ndu[p+1][p+1];
+  double left[p+1];
+  double right[p+1];
+  
+  ndu[0][0] = 1;
+  for (int j = 1; j <= p; ++j) {
+    left[j] = x - knots[span+1-j];
+    right[j] = knots[span+j] - x;
+    double saved = 0;
+    for (int r = 0; r < j; ++r) {
+      ndu[j][r] = right[r+1] + left[j-r];
+      double temp = ndu[r][j-1] / ndu[j][r];
+      ndu[r][j] = saved + right[r+1] * temp;
+      saved = left[j-r] * temp;
+    }
+    ndu[j][j] = saved;
+  }
+  for (int j = 0; j <= p; ++j)
+    ders[0][j] = ndu[j][p];
+
+  double a[2][p+1];
+  for (int r = 0; r <= p; ++r) {
+    int s1 = 0, s2 = 1;
+    a[0][0] = 1;
+    for (int k = 1; k <= noDerivatives; ++k) {
+      double d = 0;
+      int rk = r - k;
+      int pk = p - k;
+      if (r >= k) {
+        a[s2][0] = a[s1][0] / ndu[pk+1][rk];
+        d = a[s2][0] * ndu[rk][pk];
+      }
+      int j1 = (rk >= -1) ? 1 : -rk;
+      int j2 = (r-1 <= pk) ? k-1 : p-r;
+      for (int j = j1; j <= j2; ++j) {
+        a[s2][j] = ( a[s1][j] - a[s1][j-1] ) / ndu[pk+1][rk+j];
+        d += a[s2][j] * ndu[rk+j][pk];
+      }
+      if (r <= pk) {
+        a[s2][k] = -a[s1][k-1] / ndu[pk+1][r];
+        d += a[s2][k] * ndu[r][pk];
+      }
+      ders[k][r] = d;
+      int swap = s1; s1 = s2; s2 = swap;
+    }
+  }
+  
+  int factor = p;
+  for (int k = 1; k <= noDerivatives; ++k) {
+    for (int j = 0; j <= p; ++j)
+      ders[k][j] *= factor;
+    factor *= (p-k);
+  }
+}
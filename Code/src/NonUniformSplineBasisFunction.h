@@ -0,0 +1,42 @@
+// Copyright (c) 2011, Massimo Sartori and Monica Reggiani
+// All rights reserved.
+
+// Redistribution and use in source and binary forms, with or without 
+// modification, are permitted provided that the following conditions are met:
+// - Redistributions of source code must retain the above copyright notice, 
+//   this list of conditions and the following disclaimer.
+// - Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+
+
+#ifndef NonUniformSplineBasisFunction_h
+#define NonUniformSplineBasisFunction_h
+
+// Cubic B-spline basis on a non-uniform knot vector (Cox-de Boor recursion).
+// knots is the extended knot vector of an axis, with three additional knots
+// before the first node and after the last one, so that the interval l
+// between node l and node l+1 is [knots[l+3], knots[l+4]] and the non-zero
+// basis functions on it are the ones with index l, ..., l+3, as in
+// SplineBasisFunction.
+class NonUniformSplineBasisFunction {
+public:
+  static void getValues(double x, int l, const double* knots, double values[4]);
+  static void getFirstDerivatives(double x, int l, const double* knots, double derivatives[4]);
+  // ders[k][j] is the k-th derivative of basis function l+j, k = 0, ..., noDerivatives <= 2
+  static void getDerivatives(double x, int l, const double* knots, int noDerivatives, double ders[3][4]);
+};
+ 
+#endif
@@ -0,0 +1,145 @@
+// Copyright (c) 2011, Massimo Sartori and Monica Reggiani
+// All rights reserved.
+
+// Redistribution and use in source and binary forms, with or without 
+// modification, are permitted provided that the following conditions are met:
+// - Redistributions of source code must retain the above copyright notice, 
+//   this list of conditions and the following disclaimer.
+// - Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+
+
+
+#include <stdlib.h>
+#include <iostream>
+#include <algorithm>
+
+
+template <class T>
+SnapshotHolder<T>::SnapshotHolder(const T* initialSnapshot, const int maxReaders)
+:current_(initialSnapshot), maxReaders_(maxReaders) {
+  if (maxReaders_ < 1) {
+    std::cout << "A SnapshotHolder needs at least one reader slot\n";
+    exit(EXIT_FAILURE);
+  }
+  hazard_ = new std::atomic<const T*>[maxReaders_];
+  slotUsed_ = new std::atomic<bool>[maxReaders_];
+  for (int i = 0; i < maxReaders_; ++i) {
+    hazard_[i].store(NULL);
+    slotUsed_[i].store(false);
+  }
+}
+
+
+template <class T>
+SnapshotHolder<T>::~SnapshotHolder() {
+  // no reader can be alive here
+  delete current_.load();
+  for (unsigned int i = 0; i < retired_.size(); ++i)
+    delete retired_[i];
+  delete [] hazard_;
+  delete [] slotUsed_;
+}
+
+
+template <class T>
+void SnapshotHolder<T>::publish(const T* snapshot) {
+  std::lock_guard<std::mutex> lock(writerMutex_);
+  const T* old = current_.exchange(snapshot);
+  if (old != NULL && old != snapshot)
+    retired_.push_back(old);
+  reclaim();
+}
+
+
+template <class T>
+int SnapshotHolder<T>::getNumberOfRetired() const {
+  std::lock_guard<std::mutex> lock(writerMutex_);
+  return retired_.size();
+}
+
+
+template <class T>
+void SnapshotHolder<T>::reclaim() {
+  std::vector<const T*> inUse;
+  inUse.reserve(maxReaders_);
+  for (int i = 0; i < maxReaders_; ++i) {
+    const T* p = hazard_[i].load();
+    if (p != NULL)
+      inUse.push_back(p);
+  }
+  std::sort(inUse.begin(), inUse.end());
+  
+  std::vector<const T*> stillInUse;
+  for (unsigned int i = 0; i < retired_.size(); ++i) {
+    if (std::binary_search(inUse.begin(), inUse.end(), retired_[i]))
+      stillInUse.push_back(retired_[i]);
+    else
+      delete retired_[i];
+  }
+  retired_.swap(stillInUse);
+}
+
+
+template <class T>
+int SnapshotHolder<T>::claimSlot() {
+  for (int i = 0; i < maxReaders_; ++i) {
+    bool expected = false;
+    if (slotUsed_[i].compare_exchange_strong(expected, true))
+      return i;
+  }
+  std::cout << "More than " << maxReaders_ << " concurrent readers on a SnapshotHolder\n";
+  exit(EXIT_FAILURE);
+}
+
+
+template <class T>
+void SnapshotHolder<T>::freeSlot(const int slot) {
+  hazard_[slot].store(NULL);
+  slotUsed_[slot].store(false);
+}
+
+
+template <class T>
+SnapshotHolder<T>::Reader::Reader(SnapshotHolder<T>& holder)
+:holder_(holder), slot_(holder.claimSlot()) { }
+
+
+template <class T>
+SnapshotHolder<T>::Reader::~Reader() {
+  holder_.freeSlot(slot_);
+}
+
+
+template <class T>
+const T* SnapshotHolder<T>::Reader::acquire() {
+  // set the hazard, then check the snapshot is still the current one: if so,
+  // any writer retiring it from now on sees the hazard and does not delete it
+  const T* snapshot = holder_.current_.load();
+  while (true) {
+    holder_.hazard_[slot_].store(snapshot);
+    const T* check = holder_.current_.load();
+    if (check == snapshot)
+      return snapshot;
+    snapshot = check;
+  }
+}
+
+
+template <class T>
+void SnapshotHolder<T>::Reader::release() {
+  holder_.hazard_[slot_].store(NULL);
+}
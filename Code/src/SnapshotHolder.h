@@ -0,0 +1,86 @@
+// Copyright (c) 2011, Massimo Sartori and Monica Reggiani
+// All rights reserved.
+
+// Redistribution and use in source and binary forms, with or without 
+// modification, are permitted provided that the following conditions are met:
+// - Redistributions of source code must retain the above copyright notice, 
+//   this list of conditions and the following disclaimer.
+// - Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+
+
+
+#ifndef SnapshotHolder_h
+#define SnapshotHolder_h
+
+
+#include <atomic>
+#include <mutex>
+#include <vector>
+
+// Holds the current version of an immutable object (e.g. a SplineSet) and
+// lets a writer replace it while other threads keep reading.
+// Readers protect the snapshot they are using with a hazard pointer, so they
+// never take a lock; a replaced snapshot is deleted by a later publish()
+// (or by the destructor) once no reader refers to it any more.
+//
+// Usage, in each reading thread:
+//   SnapshotHolder< SplineSet<4> >::Reader reader(holder);
+//   const SplineSet<4>* splines = reader.acquire();
+//   ... evaluate ...
+//   reader.release();
+template <class T>
+class SnapshotHolder {
+  public:
+    class Reader {
+      private:
+        SnapshotHolder<T>& holder_;
+        int slot_;
+        Reader(const Reader&);
+        Reader& operator=(const Reader&);
+      public:
+        Reader(SnapshotHolder<T>& holder);
+        ~Reader();
+        // the returned snapshot stays valid until release() or the next acquire()
+        const T* acquire();
+        void release();
+    };
+    
+    // takes ownership of initialSnapshot
+    SnapshotHolder(const T* initialSnapshot, const int maxReaders = 64);
+    ~SnapshotHolder();
+    // takes ownership of snapshot; readers that already acquired the old one keep using it
+    void publish(const T* snapshot);
+    int getNumberOfRetired() const;
+    
+  private:
+    std::atomic<const T*> current_;
+    int maxReaders_;
+    std::atomic<const T*>* hazard_;
+    std::atomic<bool>* slotUsed_;
+    std::vector<const T*> retired_;
+    mutable std::mutex writerMutex_;
+    
+    SnapshotHolder(const SnapshotHolder&);
+    SnapshotHolder& operator=(const SnapshotHolder&);
+    int claimSlot();
+    void freeSlot(const int slot);
+    void reclaim();
+};
+
+
+
+#endif
@@ -0,0 +1,162 @@
+// Copyright (c) 2011, Massimo Sartori and Monica Reggiani
+// All rights reserved.
+
+// Redistribution and use in source and binary forms, with or without 
+// modification, are permitted provided that the following conditions are met:
+// - Redistributions of source code must retain the above copyright notice, 
+//   this list of conditions and the following disclaimer.
+// - Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+
+
+
+#include <stdlib.h>
+#include <iostream>
+
+//#define LOG_SPLINE
+
+template< int dim >
+SparseGridSpline<dim>::SparseGridSpline(const std::vector<double>& a, const std::vector<double>& b, const int level)
+:a_(a), b_(b), level_(level), finestN_(2 << level), noNodes_(0) {
+
+  if (level_ < 0) {
+    std::cout << "The level of a SparseGridSpline must not be negative\n";
+    exit(EXIT_FAILURE);
+  }
+
+  // combination technique: binomial(dim-1, q) with alternating sign
+  double binomial = 1;
+  std::vector<int> levels(dim);
+  NodeMap knownNodes;
+  for (int q = 0; (q < dim) && (q <= level_); ++q) {
+    addComponents(levels, 0, level_-q, (q % 2 == 0) ? binomial : -binomial, knownNodes);
+    binomial = binomial * (dim-1-q) / (q+1);
+  }
+  
+#ifdef LOG_SPLINE
+  std::cout << " Created SparseGridSpline<" << dim << "> with " << components_.size() << " components, "
+            << noNodes_ << " nodes and " << getNumberOfCoefficients() << " coefficients" << std::endl;
+#endif
+}
+
+
+template< int dim >
+void SparseGridSpline<dim>::addComponents(std::vector<int>& levels, const int axis, const int levelsLeft, const double weight,
+                                          NodeMap& knownNodes) {
+  if (axis == dim-1) {
+    levels[axis] = levelsLeft;
+    std::vector<int> n(dim);
+    for (int i = 0; i < dim; ++i)
+      n[i] = 2 << levels[i];
+    components_.push_back(Spline<dim>(a_, b_, n));
+    componentN_.push_back(n);
+    weights_.push_back(weight);
+    std::vector<int> indexOfNode;
+    addNodes(n, knownNodes, indexOfNode);
+    return;
+  }
+  for (int l = 0; l <= levelsLeft; ++l) {
+    levels[axis] = l;
+    addComponents(levels, axis+1, levelsLeft-l, weight, knownNodes);
+  }
+}
+
+
+// Add the nodes of a component grid not yet in the sparse grid, and return
+// for each of its nodes (first DOF running fastest) the index in nodes_
+template< int dim >
+void SparseGridSpline<dim>::addNodes(const std::vector<int>& n, NodeMap& knownNodes, std::vector<int>& indexOfNode) {
+  int noComponentNodes = 1;
+  for (int i = 0; i < dim; ++i)
+    noComponentNodes *= (n[i]+1);
+  indexOfNode.resize(noComponentNodes);
+
+  std::vector<int> fineIndex(dim);
+  for (int k = 0; k < noComponentNodes; ++k) {
+    int rest = k;
+    for (int i = 0; i < dim; ++i) {
+      fineIndex[i] = ( rest % (n[i]+1) ) * ( finestN_ / n[i] );
+      rest /= (n[i]+1);
+    }
+    NodeMap::const_iterator it = knownNodes.find(fineIndex);
+    if (it != knownNodes.end())
+      indexOfNode[k] = it->second;
+    else {
+      nodes_.insert(nodes_.end(), fineIndex.begin(), fineIndex.end());
+      knownNodes[fineIndex] = noNodes_;
+      indexOfNode[k] = noNodes_;
+      ++noNodes_;
+    }
+  }
+}
+
+
+template< int dim >
+void SparseGridSpline<dim>::getNode(const int i, std::vector<double>& x) const {
+  x.resize(dim);
+  // the last node is b exactly: a + finestN_ * (b-a) / finestN_ can round past it
+  for (int k = 0; k < dim; ++k)
+    x[k] = (nodes_[i*dim + k] == finestN_) ? b_[k] : a_[k] + nodes_[i*dim + k] * ( b_[k] - a_[k] ) / finestN_;
+}
+
+
+template< int dim >
+int SparseGridSpline<dim>::getNumberOfCoefficients() const {
+  int noCoeff = 0;
+  for (unsigned int k = 0; k < componentN_.size(); ++k) {
+    int componentCoeff = 1;
+    for (int i = 0; i < dim; ++i)
+      componentCoeff *= (componentN_[k][i] + 3);
+    noCoeff += componentCoeff;
+  }
+  return noCoeff;
+}
+
+
+template< int dim >
+void SparseGridSpline<dim>::computeCoefficients(std::vector<double>& /* y */, std::vector<double>::iterator fromWhereInY) {
+  NodeMap knownNodes;
+  for (int k = 0; k < noNodes_; ++k)
+    knownNodes[std::vector<int>(nodes_.begin() + k*dim, nodes_.begin() + (k+1)*dim)] = k;
+
+  std::vector<int> indexOfNode;
+  std::vector<double> componentY;
+  for (unsigned int k = 0; k < components_.size(); ++k) {
+    addNodes(componentN_[k], knownNodes, indexOfNode);
+    componentY.resize(indexOfNode.size());
+    for (unsigned int j = 0; j < indexOfNode.size(); ++j)
+      componentY[j] = *(fromWhereInY + indexOfNode[j]);
+    components_[k].computeCoefficients(componentY, componentY.begin());
+  }
+}
+
+
+template< int dim >
+double SparseGridSpline<dim>::getValue(const std::vector<double>& x) const {
+  double evaluatedValue = 0;
+  for (unsigned int k = 0; k < components_.size(); ++k)
+    evaluatedValue += weights_[k] * components_[k].getValue(x);
+  return evaluatedValue;
+}
+
+
+template< int dim >
+double SparseGridSpline<dim>::getFirstDerivative(const std::vector<double>& x, const int dimDerivative) const {
+  double evaluatedValue = 0;
+  for (unsigned int k = 0; k < components_.size(); ++k)
+    evaluatedValue += weights_[k] * components_[k].getFirstDerivative(x, dimDerivative);
+  return evaluatedValue;
+}
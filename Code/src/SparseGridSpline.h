@@ -0,0 +1,80 @@
+// Copyright (c) 2011, Massimo Sartori and Monica Reggiani
+// All rights reserved.
+
+// Redistribution and use in source and binary forms, with or without 
+// modification, are permitted provided that the following conditions are met:
+// - Redistributions of source code must retain the above copyright notice, 
+//   this list of conditions and the following disclaimer.
+// - Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+
+
+
+#ifndef SparseGridSpline_h
+#define SparseGridSpline_h
+
+
+#include <vector>
+#include <map>
+
+#include "Spline.h"
+
+// Sparse grid of cubic Bsplines for problems with many DOFs, built with the
+// combination technique: the sum of the anisotropic Spline<dim> whose levels
+// l_i >= 0, with n_i = 2^(l_i+1) intervals on axis i, satisfy 
+// level-dim+1 <= l_0+...+l_dim-1 <= level, each weighted by 
+// (-1)^q binomial(dim-1, q) with q = level - (l_0+...+l_dim-1).
+// A full grid with n = 2^(level+1) intervals per axis needs (n+1)^dim nodes,
+// the sparse grid O(n log(n)^(dim-1)).
+// The nodes of the components are nested, so each node of the sparse grid
+// is sampled once: y must list the values on the nodes in the order given 
+// by getNode.
+template <int dim>
+class SparseGridSpline {
+  private:
+    std::vector<double> a_;
+    std::vector<double> b_;
+    int level_;
+    int finestN_;
+    
+    std::vector< Spline<dim> > components_;
+    std::vector< std::vector<int> > componentN_;
+    std::vector<double> weights_;
+    
+    // index of each node on the finest grid of each axis
+    std::vector<int> nodes_;
+    int noNodes_;
+    
+    typedef std::map< std::vector<int>, int > NodeMap;
+    void addComponents(std::vector<int>& levels, const int axis, const int levelsLeft, const double weight,
+                       NodeMap& knownNodes);
+    void addNodes(const std::vector<int>& n, NodeMap& knownNodes, std::vector<int>& indexOfNode);
+    
+  public:
+    SparseGridSpline(const std::vector<double>& a, const std::vector<double>& b, const int level);
+    int getNumberOfNodes() const { return noNodes_; }
+    void getNode(const int i, std::vector<double>& x) const;
+    int getNumberOfCoefficients() const;
+    // the values on the nodes, in the order of getNode, from fromWhereInY;
+    // y is not read, as in Spline<dim>
+    void computeCoefficients(std::vector<double>& y, std::vector<double>::iterator fromWhereInY);
+    double getValue(const std::vector<double>& x) const;
+    double getFirstDerivative(const std::vector<double>& x, const int dimDerivative) const;
+};
+
+
+
+#endif
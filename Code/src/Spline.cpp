@@ -25,104 +25,310 @@
 #include <math.h>
 #include <stdlib.h>
 #include <iostream>
+#include <limits>
+#include <algorithm>
+
+#include "SplineFitter.h"
+#include "SplineFitter.cpp"
 
 //#define DEBUG
 //#define LOG_SPLINE
 
-template< int dim >
-Spline<dim>::Spline(const std::vector<double>& a, const std::vector<double>& b, const std::vector<int>& n)
-:a_(a), b_(b), n_(n), splineFirstPhase_(a_, b_, n_), splineSecondPhase_(a_[dim-1], b_[dim-1], n_[dim-1])   {
+template< int dim, int order >
+Spline<dim, order>::Spline(const std::vector<double>& a, const std::vector<double>& b, const std::vector<int>& n)
+:layout_(ROW_MAJOR_LAYOUT) {
+  init(a, b, n);
+}
+
+
+template< int dim, int order >
+Spline<dim, order>::Spline(const SplineFitter<dim, order>& fitter, const SplineCoefficientLayout layout)
+:layout_(layout) {
+  init(fitter.a_, fitter.b_, fitter.n_);
+  std::vector<double> rowMajorC(fitter.getCoefficients());
+  storeCoefficients(rowMajorC);
+}
+
+
+template< int dim, int order >
+void Spline<dim, order>::init(const std::vector<double>& a, const std::vector<double>& b, const std::vector<int>& n) {
   for (int i = 0 ; i < dim; ++i ) {
-    h_.push_back( ( b_[i]-a_[i] ) / n_[i] );
+    a_[i] = a[i];
+    b_[i] = b[i];
+    n_[i] = n[i];
+    h_[i] = ( b_[i]-a_[i] ) / n_[i];
   }
+  computeOffsets();
  
 #ifdef LOG_SPLINE  
   std::cout << " Creating Spline<" << dim << ">" << std::endl;
 #endif
   
-  int sizeOfCoeff = 1;
-  for (int i = dim-1; i>=0; --i)
-    sizeOfCoeff *= ( n_[i] + 3 );
-   
-  c_.resize(sizeOfCoeff);
-  
   sizeOfY_ = 1;
   for (int i = dim-1; i >=0; --i)
     sizeOfY_ *= (n_[i] + 1); 
     
 #ifdef LOG_SPLINE
   std::cout << " a " << a_[dim-1] << " b " << b_[dim-1] << " n " << n_[dim-1] << " h " << h_[dim-1] << std::endl;
-  std::cout << " number of Coeff " << sizeOfCoeff << std::endl;
+  std::cout << " number of Coeff " << c_.size() << std::endl;
   std::cout << " number of Y data: " << sizeOfY_ << std::endl << std::endl; 
 #endif 
 }
 
-template< int dim >
-void Spline<dim>::computeCoefficients(std::vector<double>& y, std::vector<double>::iterator fromWhereInY ) {
 
-  // compute the number of value to be interpolated
-  std::vector<double>::iterator toWhereInY = fromWhereInY + sizeOfY_;
-  
-  // step 1: compute preCoefficients
-  int numberOfPreCoeffs = ( n_[dim-1] + 1 ); 
-  for (int i = dim-2; i >= 0; i--) 
-    numberOfPreCoeffs *= (n_[i] + 3 );
-
-  std::vector<double> preCoeffs;
-  std::vector<double>::iterator posPreCoeffs;
-  preCoeffs.reserve(numberOfPreCoeffs);
-  
- #ifdef LOG_SPLINE 
-  std::cout << " Step 1: Dim: " << dim << " the number of precoefficients is: " << numberOfPreCoeffs << std::endl;
- #endif
-    
-  std::vector<double>::iterator currentY = fromWhereInY; 
-  for (int i = 0; i <= n_[dim-1]; ++i) {
-     splineFirstPhase_.computeCoefficients(y, currentY);
-     preCoeffs.insert(preCoeffs.end(), splineFirstPhase_.c_.begin(), splineFirstPhase_.c_.end()); 
-     currentY += sizeOfY_/(n_[dim-1]+1) ;
+template< int dim, int order >
+void Spline<dim, order>::computeCoefficients(std::vector<double>& y, std::vector<double>::iterator fromWhereInY ) {
+  std::vector<double> a(a_, a_+dim), b(b_, b_+dim);
+  std::vector<int> n(n_, n_+dim);
+  SplineFitter<dim, order> fitter(a, b, n);
+  fitter.computeCoefficients(y, fromWhereInY);
+  std::vector<double> rowMajorC(fitter.getCoefficients());
+  storeCoefficients(rowMajorC);
+}
+
+
+template< int dim, int order >
+void Spline<dim, order>::computeCoefficients(const double* y, const std::ptrdiff_t stride) {
+  std::vector<double> a(a_, a_+dim), b(b_, b_+dim);
+  std::vector<int> n(n_, n_+dim);
+  SplineFitter<dim, order> fitter(a, b, n);
+  fitter.computeCoefficients(y, stride);
+  std::vector<double> rowMajorC(fitter.getCoefficients());
+  storeCoefficients(rowMajorC);
+}
+
+
+// The interpolation is linear in y and separable: the coefficients generated
+// by a unit value on node (j_0, ..., j_dim-1) are the tensor product of the
+// responses of a Spline<1> to a unit value on node j_i of each axis.
+// These responses decay by a factor of about 0.27 per node only, so they
+// stay above round-off for about 27 nodes: on grids up to n of about 50
+// intervals per axis, each changed node rewrites all the (n+3)^dim
+// coefficients. With 3 DOFs a refit costs as much as about 12 changed nodes
+// for n = 9 and 40 for n = 40 (see checkUpdate): beyond, refit.
+// A tolerance skips the products below tolerance * |deltaY|: with 1e-6 a
+// change reaches about 11 nodes on each side, with 1e-3 about 5, and the
+// error on a coefficient stays about tolerance * |deltaY|.
+// changedNodes are indexes in y (first DOF running fastest), deltaY the
+// difference between the new and the old value of each of them.
+template< int dim, int order >
+void Spline<dim, order>::updateCoefficients(const std::vector<int>& changedNodes, const std::vector<double>& deltaY,
+                                            const double tolerance) {
+
+  if (changedNodes.size() != deltaY.size()) {
+    std::cout << "We have " << changedNodes.size() << " changed nodes, but "
+              << deltaY.size() << " new values\n";
+    exit(EXIT_FAILURE);
   }
-  
-// step 2: Now solve the spline interpolation problem
-#ifdef LOG_SPLINE
-     std::cout << "Beginning of step 2" << std::endl;
-#endif     
-  c_.clear();
-  if (!c_.empty()) {
-    std::cout << " Should be empty!!!\n"; 
+  if (tolerance < 0.) {
+    std::cout << "The tolerance of the update cannot be negative\n";
     exit(EXIT_FAILURE);
   }
-  int sizeOfC = 1;
-  for (int i = 0; i < dim; ++i)
-    sizeOfC *= (n_[i]+3); 
-  c_.resize(sizeOfC);
-  
-  int noInterpolatedDataFromPreCoeffs = numberOfPreCoeffs/(n_[dim-1]+1);
-  std::vector<double> interpolatedDataFromPreCoeffs(noInterpolatedDataFromPreCoeffs);
-  
-  for (int i = 0; i < noInterpolatedDataFromPreCoeffs; ++i) {
-    for (int j = 0; j < (n_[dim-1]+1); ++j) {
-       interpolatedDataFromPreCoeffs[j] = preCoeffs[j * noInterpolatedDataFromPreCoeffs+i];
- 
+
+  // responses of each axis, computed only for the nodes we need
+  std::vector< std::vector< std::vector<double> > > responses(dim);
+  std::vector< std::vector<double> > maxResponses(dim);
+  for (int i = 0; i < dim; ++i) {
+    responses[i].resize(n_[i]+1);
+    maxResponses[i].resize(n_[i]+1);
+  }
+
+  std::vector<int> node(dim);
+  std::vector<const double*> currentResponses(dim);
+  std::vector<double> maxOfInnerAxes(dim);
+  for (unsigned int k = 0; k < changedNodes.size(); ++k) {
+    if ( (changedNodes[k] < 0) || (changedNodes[k] >= sizeOfY_) ) {
+      std::cout << "Node " << changedNodes[k] << " out of boundaries\n";
+      exit(EXIT_FAILURE);
+    }
+
+    int rest = changedNodes[k];
+    for (int i = 0; i < dim; ++i) {
+      node[i] = rest % (n_[i]+1);
+      rest /= (n_[i]+1);
     }
-    splineSecondPhase_.computeCoefficients(interpolatedDataFromPreCoeffs, interpolatedDataFromPreCoeffs.begin());
-    for(int j=0; j< n_[dim-1]+3;j++) {
-      c_[j*(noInterpolatedDataFromPreCoeffs)+i] = splineSecondPhase_.c_[j];
-   }
-      
+
+    for (int i = 0; i < dim; ++i) {
+      std::vector<double>& response = responses[i][node[i]];
+      if (response.empty()) {
+        Spline<1, order> axisSpline(a_[i], b_[i], n_[i]);
+        std::vector<double> unitY(n_[i]+1, 0.);
+        unitY[node[i]] = 1;
+        axisSpline.computeCoefficients(unitY, unitY.begin());
+        response = axisSpline.c_;
+        for (int j = 0; j < SplineOrder<order>::getNumberOfCoefficients(n_[i]); ++j)
+          maxResponses[i][node[i]] = std::max(maxResponses[i][node[i]], fabs(response[j]));
+      }
+      currentResponses[i] = &response[0];
+    }
+
+    maxOfInnerAxes[0] = 1;
+    for (int i = 1; i < dim; ++i)
+      maxOfInnerAxes[i] = maxOfInnerAxes[i-1] * maxResponses[i-1][node[i-1]];
+    double threshold = fabs(deltaY[k]) * std::max(tolerance, maxOfInnerAxes[dim-1] * maxResponses[dim-1][node[dim-1]]
+                                                            * std::numeric_limits<double>::epsilon());
+
+    addTensorProduct(dim-1, 0, deltaY[k], currentResponses, maxOfInnerAxes, threshold);
   }
+
 #ifdef LOG_SPLINE
-  std::cout << "Spline<" << dim << ">'s " << c_.size() <<" coeffs\n";
-    for (int i = 0; i < c_.size(); ++i)
-     std::cout << c_[i] << std::endl;
-  std::cout << std::endl;
-#endif  
+  std::cout << "Spline<" << dim << "> updated with " << changedNodes.size() << " changed nodes\n";
+#endif
+}
+
+
+template< int dim, int order >
+void Spline<dim, order>::addTensorProduct(const int axis, const int cIndexOfOuterAxes, const double productOfOuterAxes,
+                                   const std::vector<const double*>& responses, const std::vector<double>& maxOfInnerAxes,
+                                   const double threshold) {
+  for (int j = 0; j < SplineOrder<order>::getNumberOfCoefficients(n_[axis]); ++j) {
+    double currentStep = productOfOuterAxes * responses[axis][j];
+    // the remaining axes cannot bring this term above round-off
+    if (fabs(currentStep) * maxOfInnerAxes[axis] <= threshold)
+      continue;
+    int cIndex = cIndexOfOuterAxes + offset_[firstOffset_[axis] + j];
+    if (axis == 0)
+      c_[cIndex] += currentStep;
+    else
+      addTensorProduct(axis-1, cIndex, currentStep, responses, maxOfInnerAxes, threshold);
+  }
+}
+
+
+template< int dim, int order >
+void Spline<dim, order>::computeOffsets() {
+  int noBits = 0;
+  std::vector<int> bitsOfAxis(dim, 0);
+  int sizeOfTile = 1;
+  for (int i = 0; i < dim; ++i)
+    sizeOfTile *= order;
+  int tileStride = 1;
+  int powerOfOrder = 1;
+  int rowMajorStride = 1;
+
+  for (int i = 0; i < dim; ++i) {
+    while ( (1 << bitsOfAxis[i]) < SplineOrder<order>::getNumberOfCoefficients(n_[i]) )
+      ++bitsOfAxis[i];
+    noBits = std::max(noBits, bitsOfAxis[i]);
+  }
+  if (layout_ == MORTON_LAYOUT) {
+    // the offsets are ints: the padded axes must fit in 31 bits
+    int totalBits = 0;
+    for (int i = 0; i < dim; ++i)
+      totalBits += bitsOfAxis[i];
+    if (totalBits > 30) {
+      std::cout << "The Morton layout needs 2^" << totalBits << " coefficients, more than the offsets can hold\n";
+      exit(EXIT_FAILURE);
+    }
+  }
+
+  offset_.clear();
+  for (int i = 0; i < dim; ++i) {
+    firstOffset_[i] = offset_.size();
+    offset_.resize(offset_.size() + SplineOrder<order>::getNumberOfCoefficients(n_[i]));
+    int* axisOffset = &offset_[firstOffset_[i]];
+    for (int j = 0; j < SplineOrder<order>::getNumberOfCoefficients(n_[i]); ++j) {
+      switch (layout_) {
+        case ROW_MAJOR_LAYOUT:
+          axisOffset[j] = j * rowMajorStride;
+          break;
+        case TILED_LAYOUT:
+          axisOffset[j] = (j / order) * tileStride * sizeOfTile + (j % order) * powerOfOrder;
+          break;
+        case MORTON_LAYOUT: {
+          // interleave the bits of the axes, lowest bits first; an axis
+          // with fewer bits leaves its place to the others
+          axisOffset[j] = 0;
+          int position = 0;
+          for (int bit = 0; bit < noBits; ++bit)
+            for (int k = 0; k < dim; ++k) {
+              if (bit >= bitsOfAxis[k])
+                continue;
+              if ( (k == i) && ( (j >> bit) & 1 ) )
+                axisOffset[j] |= 1 << position;
+              ++position;
+            }
+          break;
+        }
+      }
+    }
+    rowMajorStride *= SplineOrder<order>::getNumberOfCoefficients(n_[i]);
+    tileStride *= (SplineOrder<order>::getNumberOfCoefficients(n_[i]) + order-1) / order;
+    powerOfOrder *= order;
+  }
+  
+  std::vector<double> rowMajorC(rowMajorStride, 0.);
+  storeCoefficients(rowMajorC);
+}
+
+
+template< int dim, int order >
+void Spline<dim, order>::storeCoefficients(std::vector<double>& rowMajorC) {
+  if (layout_ == ROW_MAJOR_LAYOUT) {
+    c_.swap(rowMajorC);
+    return;
+  }
+  // the offsets grow with j, so the last coefficient is the farthest
+  int sizeOfC = 1;
+  for (int i = 0; i < dim; ++i)
+    sizeOfC += offset_[firstOffset_[i] + SplineOrder<order>::getNumberOfCoefficients(n_[i])-1];
+  c_.assign(sizeOfC, 0.);
+  std::vector<int> j(dim, 0);
+  for (unsigned int k = 0; k < rowMajorC.size(); ++k) {
+    int cIndex = 0;
+    for (int i = 0; i < dim; ++i)
+      cIndex += offset_[firstOffset_[i] + j[i]];
+    c_[cIndex] = rowMajorC[k];
+    for (int i = 0; (i < dim) && (++j[i] == SplineOrder<order>::getNumberOfCoefficients(n_[i])); ++i)
+      j[i] = 0;
+  }
+}
 
+
+template< int dim, int order >
+void Spline<dim, order>::setLayout(const SplineCoefficientLayout layout) {
+  std::vector<double> rowMajorC(getCoefficients());
+  layout_ = layout;
+  computeOffsets();
+  storeCoefficients(rowMajorC);
 }
 
 
-template< int dim >
-bool Spline<dim>::checkValues(const std::vector<double>& x) const {
+template< int dim, int order >
+std::vector<double> Spline<dim, order>::getCoefficients() const {
+  int sizeOfC = 1;
+  for (int i = 0; i < dim; ++i)
+    sizeOfC *= (SplineOrder<order>::getNumberOfCoefficients(n_[i]));
+  std::vector<double> rowMajorC(sizeOfC);
+  std::vector<int> j(dim, 0);
+  for (int k = 0; k < sizeOfC; ++k) {
+    int cIndex = 0;
+    for (int i = 0; i < dim; ++i)
+      cIndex += offset_[firstOffset_[i] + j[i]];
+    rowMajorC[k] = c_[cIndex];
+    for (int i = 0; (i < dim) && (++j[i] == SplineOrder<order>::getNumberOfCoefficients(n_[i])); ++i)
+      j[i] = 0;
+  }
+  return rowMajorC;
+}
+
+
+template< int dim, int order >
+void Spline<dim, order>::setCoefficients(const std::vector<double>& c) {
+  int sizeOfC = 1;
+  for (int i = 0; i < dim; ++i)
+    sizeOfC *= (SplineOrder<order>::getNumberOfCoefficients(n_[i]));
+  if (static_cast<int>(c.size()) != sizeOfC) {
+    std::cout << "Spline<" << dim << "> has " << sizeOfC << " coefficients, not " << c.size() << std::endl;
+    exit(EXIT_FAILURE);
+  }
+  std::vector<double> rowMajorC(c);
+  storeCoefficients(rowMajorC);
+}
+
+
+template< int dim, int order >
+bool Spline<dim, order>::checkValues(const std::vector<double>& x) const {
   for (int i = 0; i < dim; ++i )
     if ( (x[i] < a_[i]) || (x[i] > b_[i]) )
       return false;
@@ -130,189 +336,642 @@ bool Spline<dim>::checkValues(const std::vector<double>& x) const {
 }
 
 
-template< int dim >
-void Spline<dim>::computeInterval(std::vector<int>& l, std::vector<int>& m, const std::vector<double>& x) const {
+// first of the order basis functions not null in x; on x = b the first one
+// is null too, so we can keep the last interval and always use order of them
+template< int dim, int order >
+int Spline<dim, order>::computeInterval(const int axis, const double x) const {
+  return SplineOrder<order>::computeInterval(x, a_[axis], h_[axis], n_[axis]);
+}
+
+
+template< int dim, int order >
+void Spline<dim, order>::getStencilIndexes(const std::vector<double>& x, std::vector<int>& indexes) const {
+  if (!checkValues(x)) {
+    std::cout << "Values x are out of boundaries\n";
+    exit(EXIT_FAILURE);
+  }
+  indexes.assign(1, 0);
   for (int i = 0; i < dim; ++i) {
-    l[i] = floor( ( x[i] - a_[i] ) / h_[i] );
-    m[i] = std::min( l[i] + 3, n_[i] + 2);  
+    int l = computeInterval(i, x[i]);
+    int size = indexes.size();
+    indexes.resize(order * size);
+    for (int j = order-1; j >= 0; --j)
+      for (int k = 0; k < size; ++k)
+        indexes[j * size + k] = indexes[k] + offset_[firstOffset_[i] + l+j];
   }
 }
 
 
-template< int dim >
-double Spline<dim>::getValue(const std::vector<double>& x) const {
-  std::vector<int> l(dim);
-  std::vector<int> m(dim);
+template< int dim, int order >
+double Spline<dim, order>::getValue(const std::vector<double>& x) const {
   if (!checkValues(x)) {
     std::cout << "Values x are out of boundaries\n";
     exit(EXIT_FAILURE);
   }
   
-  
-  computeInterval(l, m, x);
-
-  std::vector<int> numberOfIterations(dim); 
+  double basis[dim][order];
+  const int* offsets[dim];
   for (int i = 0; i < dim; ++i) {
-    numberOfIterations[i]= (m[i]-l[i]+1);
+    int l = computeInterval(i, x[i]);
+    for (int j = 0; j < order; ++j)
+      basis[i][j] = SplineOrder<order>::getValue(x[i], l+j, a_[i], h_[i]);
+    offsets[i] = &offset_[firstOffset_[i] + l];
+  }
+  return SplineStencil<dim-1, order>::sum(&c_[0], offsets, basis, 0);
+}
+
+
+template< int dim, int order >
+double Spline<dim, order>::getFirstDerivative(const std::vector<double>& x, const int dimDerivative) const {
+  if (!checkValues(x)) {
+    std::cout << "Values x are out of boundaries\n";
+    exit(EXIT_FAILURE);
   }
   
-  int totIterations = 1; 
+  double basis[dim][order];
+  const int* offsets[dim];
   for (int i = 0; i < dim; ++i) {
-    totIterations *= numberOfIterations[i]; 
+    int l = computeInterval(i, x[i]);
+    for (int j = 0; j < order; ++j)
+      basis[i][j] = (i == dimDerivative) ? SplineOrder<order>::getFirstDerivative(x[i], l+j, a_[i], h_[i])
+                                         : SplineOrder<order>::getValue(x[i], l+j, a_[i], h_[i]);
+    offsets[i] = &offset_[firstOffset_[i] + l];
   }
+  return SplineStencil<dim-1, order>::sum(&c_[0], offsets, basis, 0);
+}
 
-  std::vector<int> index(dim);
-  double evaluatedValue = 0;
-  for (int soFar = 0; soFar < totIterations; ++soFar) {
-    double tot = 0;
-    double mul = totIterations;
-    for (int i = dim-1; i > 0; --i) {
-      mul = mul / numberOfIterations[i];
-      index[i] = ( soFar - tot )/ mul;
-      tot += index[i] * mul;
-    } 
-    index[0] = soFar % numberOfIterations[0];
-    
-    
-    mul = 1;
-    int cIndex = 0;
-    for (int i = 0; i < dim; ++i) {
-      cIndex += (l[i]+index[i]) * mul;
-      mul = mul * (n_[i]+3);
+template< int dim, int order >
+template< typename Scalar >
+Scalar Spline<dim, order>::getValue(const std::vector<Scalar>& x) const {
+  return evaluate(x, -1);
+}
+
+
+template< int dim, int order >
+template< typename Scalar >
+Scalar Spline<dim, order>::getFirstDerivative(const std::vector<Scalar>& x, const int dimDerivative) const {
+  return evaluate(x, dimDerivative);
+}
+
+
+template< int dim, int order >
+template< typename Scalar >
+Scalar Spline<dim, order>::evaluate(const std::vector<Scalar>& x, const int dimDerivative) const {
+  for (int i = 0; i < dim; ++i ) {
+    const double xValue = SplineScalar<Scalar>::getValue(x[i]);
+    if ( (xValue < a_[i]) || (xValue > b_[i]) ) {
+      std::cout << "Values x are out of boundaries\n";
+      exit(EXIT_FAILURE);
     }
-#ifdef LOG_SPLINE    
-    std::cout << "Multiply c_[" << cIndex << "]:" << c_[cIndex];
-#endif    
-    double currentStep = 1;
-    for (int i = 0; i < dim; ++i) {
-#ifdef LOG_SPLINE    
-      std::cout << "\tx[" << i << "]:" << x[i] << "*" << "u[" << l[i]+index[i] << "]:" << SplineBasisFunction::getValue(x[i], l[i]+index[i], a_[i], h_[i]);
-#endif
-      currentStep *= SplineBasisFunction::getValue(x[i], l[i]+index[i], a_[i], h_[i]); 
+  }
+  
+  Scalar basis[dim][order];
+  const int* offsets[dim];
+  for (int i = 0; i < dim; ++i) {
+    int l = computeInterval(i, SplineScalar<Scalar>::getValue(x[i]));
+    for (int j = 0; j < order; ++j)
+      basis[i][j] = (i == dimDerivative) ? SplineOrder<order>::getGenericFirstDerivative(x[i], l+j, a_[i], h_[i])
+                                         : SplineOrder<order>::getGenericValue(x[i], l+j, a_[i], h_[i]);
+    offsets[i] = &offset_[firstOffset_[i] + l];
+  }
+  return SplineStencil<dim-1, order, int, Scalar>::sum(&c_[0], offsets, basis, 0);
+}
+
+
+template< int dim, int order >
+template< int noVariables >
+SplineDual<noVariables> Spline<dim, order>::getValue(const std::vector< SplineDual<noVariables> >& x) const {
+  return evaluateDual(x, -1);
+}
+
+
+template< int dim, int order >
+template< int noVariables >
+SplineDual<noVariables> Spline<dim, order>::getFirstDerivative(const std::vector< SplineDual<noVariables> >& x,
+                                                               const int dimDerivative) const {
+  return evaluateDual(x, dimDerivative);
+}
+
+
+// derivative[i] is the derivative along x[i] of basis[i]: SplineGradientStencil
+// gives the gradient along the angles with the value
+template< int dim, int order >
+void Spline<dim, order>::computeGradientBasis(const double* x, const int dimDerivative, double (*basis)[order],
+                                              double (*derivative)[order], const int** offsets) const {
+  for (int i = 0; i < dim; ++i ) {
+    if ( (x[i] < a_[i]) || (x[i] > b_[i]) ) {
+      std::cout << "Values x are out of boundaries\n";
+      exit(EXIT_FAILURE);
     }
-#ifdef LOG_SPLINE    
-    std::cout << std::endl;
-#endif
-    evaluatedValue += c_[cIndex] * currentStep;
   }
-  return evaluatedValue;
+  
+  for (int i = 0; i < dim; ++i) {
+    int l = computeInterval(i, x[i]);
+    for (int j = 0; j < order; ++j)
+      if (i == dimDerivative) {
+        basis[i][j] = SplineOrder<order>::getFirstDerivative(x[i], l+j, a_[i], h_[i]);
+        derivative[i][j] = SplineOrder<order>::getSecondDerivative(x[i], l+j, a_[i], h_[i]);
+      }
+      else {
+        basis[i][j] = SplineOrder<order>::getValue(x[i], l+j, a_[i], h_[i]);
+        derivative[i][j] = SplineOrder<order>::getFirstDerivative(x[i], l+j, a_[i], h_[i]);
+      }
+    offsets[i] = &offset_[firstOffset_[i] + l];
+  }
 }
 
-template< int dim >
-double Spline<dim>::getFirstDerivative(const std::vector<double>& x, const int dimDerivative) {
 
-  std::vector<int> l(dim);
-  std::vector<int> m(dim);
-  if (!checkValues(x)) {
+template< int dim, int order >
+template< int noVariables >
+SplineDual<noVariables> Spline<dim, order>::evaluateDual(const std::vector< SplineDual<noVariables> >& x,
+                                                         const int dimDerivative) const {
+  double xValue[dim];
+  for (int i = 0; i < dim; ++i )
+    xValue[i] = x[i].getValue();
+  double basis[dim][order];
+  double derivative[dim][order];
+  const int* offsets[dim];
+  computeGradientBasis(xValue, dimDerivative, basis, derivative, offsets);
+  
+  double sums[dim+1];
+  SplineGradientStencil<dim-1, order>::sum(&c_[0], offsets, basis, derivative, 0, sums);
+  SplineDual<noVariables> result(sums[0]);
+  for (int k = 0; k < noVariables; ++k) {
+    double chained = 0;
+    for (int i = 0; i < dim; ++i)
+      chained += sums[1+i] * x[i].getDerivative(k);
+    result.setDerivative(k, chained);
+  }
+  return result;
+}
+
+
+template< int dim, int order >
+void Spline<dim, order>::getValueAndGradient(const std::vector<double>& x, double& value, std::vector<double>& gradient) const {
+  double basis[dim][order];
+  double derivative[dim][order];
+  const int* offsets[dim];
+  computeGradientBasis(&x[0], -1, basis, derivative, offsets);
+  double sums[dim+1];
+  SplineGradientStencil<dim-1, order>::sum(&c_[0], offsets, basis, derivative, 0, sums);
+  value = sums[0];
+  gradient.assign(sums + 1, sums + dim+1);
+}
+
+
+template< int dim, int order >
+template< int otherDim >
+void Spline<dim, order>::setCoefficientsOf(Spline<otherDim, order>& spline, std::vector<double>& rowMajorC) {
+  spline.setCoefficients(rowMajorC);
+}
+
+
+template< int dim, int order >
+void Spline<dim, order>::getValuesOnGrid(const std::vector< std::vector<double> >& samples, std::vector<double>& values) const {
+  evaluateOnGrid(samples, -1, values);
+}
+
+
+template< int dim, int order >
+void Spline<dim, order>::getFirstDerivativesOnGrid(const std::vector< std::vector<double> >& samples, const int dimDerivative,
+                                                   std::vector<double>& derivatives) const {
+  evaluateOnGrid(samples, dimDerivative, derivatives);
+}
+
+
+template< int dim, int order >
+double Spline<dim, order>::getIntegral(const std::vector<double>& lower, const std::vector<double>& upper) const {
+  return integrateOnBox(lower, upper, -1);
+}
+
+
+template< int dim, int order >
+double Spline<dim, order>::getIntegralOfFirstDerivative(const std::vector<double>& lower, const std::vector<double>& upper,
+                                                        const int dimDerivative) const {
+  return integrateOnBox(lower, upper, dimDerivative);
+}
+
+
+// weights[i][m] is the integral from lower[i] to upper[i] of the basis
+// function first[i]+m of axis i, or its difference between the two ends on
+// the axis of the derivative; the other basis functions vanish on the box
+template< int dim, int order >
+double Spline<dim, order>::integrateOnBox(const std::vector<double>& lower, const std::vector<double>& upper,
+                                          const int dimDerivative) const {
+  if (!checkValues(lower) || !checkValues(upper)) {
     std::cout << "Values x are out of boundaries\n";
     exit(EXIT_FAILURE);
   }
   
-  computeInterval(l, m, x);
-
-  std::vector<int> numberOfIterations(dim); 
+  std::vector<double> weights[dim];
+  int first[dim];
   for (int i = 0; i < dim; ++i) {
-    numberOfIterations[i]= (m[i]-l[i]+1);
+    first[i] = computeInterval(i, std::min(lower[i], upper[i]));
+    const int last = computeInterval(i, std::max(lower[i], upper[i])) + order-1;
+    weights[i].resize(last - first[i] + 1);
+    for (int m = 0; m <= last - first[i]; ++m)
+      weights[i][m] = (i == dimDerivative) 
+                      ? SplineOrder<order>::getValue(upper[i], first[i]+m, a_[i], h_[i]) 
+                        - SplineOrder<order>::getValue(lower[i], first[i]+m, a_[i], h_[i])
+                      : SplineOrder<order>::getIntegral(lower[i], upper[i], first[i]+m, a_[i], h_[i]);
   }
-  
-  int totIterations = 1; 
-  for (int i = 0; i < dim; ++i) {
-    totIterations *= numberOfIterations[i]; 
+  return contractWeights(dim-1, 0, weights, first);
+}
+
+
+template< int dim, int order >
+double Spline<dim, order>::contractWeights(const int axis, const int index, const std::vector<double>* weights,
+                                           const int* first) const {
+  const int* offsets = &offset_[firstOffset_[axis] + first[axis]];
+  const std::vector<double>& weightsOfAxis = weights[axis];
+  double sum = 0;
+  if (axis == 0) {
+    for (unsigned int m = 0; m < weightsOfAxis.size(); ++m)
+      sum += weightsOfAxis[m] * c_[index + offsets[m]];
+    return sum;
   }
+  for (unsigned int m = 0; m < weightsOfAxis.size(); ++m)
+    if (weightsOfAxis[m] != 0)
+      sum += weightsOfAxis[m] * contractWeights(axis-1, index + offsets[m], weights, first);
+  return sum;
+}
 
-  std::vector<int> index(dim);
-  double evaluatedValue = 0;
-  for (int soFar = 0; soFar < totIterations; ++soFar) {
-    double tot = 0;
-    double mul = totIterations;
-    for (int i = dim-1; i > 0; --i) {
-      mul = mul / numberOfIterations[i];
-      index[i] = ( soFar - tot )/ mul;
-      tot += index[i] * mul;
-    } 
-    index[0] = soFar % numberOfIterations[0];
-      
-    mul = 1;
-    int cIndex = 0;
-    for (int i = 0; i < dim; ++i) {
-      cIndex += (l[i]+index[i]) * mul;
-      mul = mul * (n_[i]+3);
+
+template< int dim, int order >
+double Spline<dim, order>::getLineIntegral(const std::vector< std::vector<double> >& path) const {
+  return integrateOnPath(path, -1);
+}
+
+
+template< int dim, int order >
+double Spline<dim, order>::getLineIntegralOfFirstDerivative(const std::vector< std::vector<double> >& path,
+                                                            const int dimDerivative) const {
+  return integrateOnPath(path, dimDerivative);
+}
+
+
+// nodes and weights of the Gauss-Legendre rule on [0, 1], exact up to the
+// degree 2*noPoints - 1: the roots of the Legendre polynomial by Newton
+template< int dim, int order >
+void Spline<dim, order>::computeGaussLegendre(const int noPoints, std::vector<double>& nodes, std::vector<double>& weights) {
+  nodes.resize(noPoints);
+  weights.resize(noPoints);
+  const double pi = acos(-1.);
+  for (int i = 0; i < noPoints; ++i) {
+    double z = cos(pi * (i + 0.75) / (noPoints + 0.5));
+    double derivative = 1;
+    for (int iteration = 0; iteration < 100; ++iteration) {
+      double p = 1, previousP = 0;
+      for (int k = 1; k <= noPoints; ++k) {
+        double olderP = previousP;
+        previousP = p;
+        p = ( (2*k - 1) * z * previousP - (k - 1) * olderP ) / k;
+      }
+      derivative = noPoints * (z * p - previousP) / (z * z - 1);
+      double step = p / derivative;
+      z -= step;
+      if (fabs(step) < 1e-15)
+        break;
+    }
+    nodes[i] = 0.5 * (1 - z);
+    weights[i] = 1. / ( (1 - z * z) * derivative * derivative );
+  }
+}
+
+
+// On the segment x(tau) = p + tau * (q - p) each axis is a polynomial of
+// degree order-1 in tau between two of its breaks, on the nodes for the even
+// orders and halfway for the odd ones (see SplineOrder): the spline has
+// degree dim*(order-1) between two breaks of any axis, which Gauss-Legendre
+// integrates exactly
+template< int dim, int order >
+double Spline<dim, order>::integrateOnPath(const std::vector< std::vector<double> >& path, const int dimDerivative) const {
+  for (unsigned int s = 0; s < path.size(); ++s)
+    if (!checkValues(path[s])) {
+      std::cout << "Values x are out of boundaries\n";
+      exit(EXIT_FAILURE);
     }
-#ifdef LOG_SPLINE    
-    std::cout << "Multiply c_[" << cIndex << "]:" << c_[cIndex];
-#endif    
-    double currentStep = 1;
-    for (int i = 0; i < dimDerivative; ++i) {
-#ifdef LOG_SPLINE    
-      std::cout << "\tx[" << i << "]:" << x[i] << "*" << "u[" << l[i]+index[i] << "]:" << SplineBasisFunction::getValue(x[i], l[i]+index[i], a_[i], h_[i]);
-#endif
-       currentStep *= SplineBasisFunction::getValue(x[i], l[i]+index[i], a_[i], h_[i]); 
   
+  std::vector<double> gaussNodes, gaussWeights;
+  computeGaussLegendre( (dim * (order-1)) / 2 + 1, gaussNodes, gaussWeights);
+  const double shift = (order % 2) ? 0.5 : 0.;
+  double integral = 0;
+  std::vector<double> x(dim), breaks;
+  for (unsigned int s = 1; s < path.size(); ++s) {
+    const std::vector<double>& p = path[s-1];
+    const std::vector<double>& q = path[s];
+    double length = 0;
+    for (int i = 0; i < dim; ++i)
+      length += (q[i] - p[i]) * (q[i] - p[i]);
+    const double factor = (dimDerivative < 0) ? sqrt(length) : q[dimDerivative] - p[dimDerivative];
+    if (factor == 0)
+      continue;
+    
+    breaks.assign(1, 0.);
+    breaks.push_back(1.);
+    for (int i = 0; i < dim; ++i) {
+      if (q[i] == p[i])
+        continue;
+      const double u0 = (std::min(p[i], q[i]) - a_[i]) / h_[i] - shift;
+      const double u1 = (std::max(p[i], q[i]) - a_[i]) / h_[i] - shift;
+      for (int m = static_cast<int>(floor(u0)) + 1; m < u1; ++m)
+        breaks.push_back( (a_[i] + (m + shift) * h_[i] - p[i]) / (q[i] - p[i]) );
     }
+    std::sort(breaks.begin(), breaks.end());
     
-#ifdef LOG_SPLINE    
-    std::cout << "\tdx/dim[" << dimDerivative << "]:" << x[dimDerivative] << "*" << "u[" << l[dimDerivative]+index[dimDerivative] << "]:" << SplineBasisFunction::getValue(x[dimDerivative], l[dimDerivative]+index[dimDerivative], a_[dimDerivative], h_[dimDerivative]);
-#endif
+    for (unsigned int b = 1; b < breaks.size(); ++b) {
+      const double tau0 = std::max(0., breaks[b-1]), tau1 = std::min(1., breaks[b]);
+      if (tau1 <= tau0)
+        continue;
+      for (unsigned int g = 0; g < gaussNodes.size(); ++g) {
+        const double tau = tau0 + (tau1 - tau0) * gaussNodes[g];
+        for (int i = 0; i < dim; ++i)
+          x[i] = std::min(b_[i], std::max(a_[i], p[i] + tau * (q[i] - p[i])));
+        const double value = (dimDerivative < 0) ? getValue(x) : getFirstDerivative(x, dimDerivative);
+        integral += factor * (tau1 - tau0) * gaussWeights[g] * value;
+      }
+    }
+  }
+  return integral;
+}
 
-    currentStep *= SplineBasisFunction::getFirstDerivative(x[dimDerivative], l[dimDerivative]+index[dimDerivative], a_[dimDerivative], h_[dimDerivative]);
+
+// The tensor starts as the row-major coefficients and the axes are replaced
+// by their samples one after the other: for each sample p of the axis, its
+// order rows of the tensor, each one contiguous over the faster axes, are
+// summed with the weights of the basis in p. The first axis has rows of one
+// element, so it goes first, while the tensor is still small; the last one
+// goes with the longest rows.
+template< int dim, int order >
+void Spline<dim, order>::evaluateOnGrid(const std::vector< std::vector<double> >& samples, const int dimDerivative,
+                                        std::vector<double>& values) const {
+  if (static_cast<int>(samples.size()) != dim) {
+    std::cout << "Spline<" << dim << "> needs the samples of " << dim << " axes, not " << samples.size() << std::endl;
+    exit(EXIT_FAILURE);
+  }
+  for (int i = 0; i < dim; ++i)
+    for (unsigned int p = 0; p < samples[i].size(); ++p)
+      if ( (samples[i][p] < a_[i]) || (samples[i][p] > b_[i]) ) {
+        std::cout << "Values x are out of boundaries\n";
+        exit(EXIT_FAILURE);
+      }
+  
+  std::vector<double> tensor(getCoefficients());
+  std::vector<double> contracted;
+  int sizeOfAxis[dim];
+  for (int i = 0; i < dim; ++i)
+    sizeOfAxis[i] = SplineOrder<order>::getNumberOfCoefficients(n_[i]);
+  
+  for (int axis = 0; axis < dim; ++axis) {
+    const int noSamples = samples[axis].size();
+    int inner = 1, outer = 1;
+    for (int i = 0; i < axis; ++i)
+      inner *= sizeOfAxis[i];
+    for (int i = axis+1; i < dim; ++i)
+      outer *= sizeOfAxis[i];
     
-    for (int i = dimDerivative+1; i < dim; ++i) {
-#ifdef LOG_SPLINE    
-      std::cout << "\tx[" << i << "]:" << x[i] << "*" << "u[" << l[i]+index[i] << "]:" << SplineBasisFunction::getValue(x[i], l[i]+index[i], a_[i], h_[i]);
-#endif
-      currentStep *= SplineBasisFunction::getValue(x[i], l[i]+index[i], a_[i], h_[i]); 
+    std::vector<int> first(noSamples);
+    std::vector<double> basis(noSamples*order);
+    for (int p = 0; p < noSamples; ++p) {
+      const double x = samples[axis][p];
+      first[p] = computeInterval(axis, x);
+      for (int j = 0; j < order; ++j)
+        basis[p*order + j] = (axis == dimDerivative) ? SplineOrder<order>::getFirstDerivative(x, first[p]+j, a_[axis], h_[axis])
+                                                     : SplineOrder<order>::getValue(x, first[p]+j, a_[axis], h_[axis]);
     }
-#ifdef LOG_SPLINE    
-    std::cout << std::endl;
-#endif
-    evaluatedValue += c_[cIndex] * currentStep;
+    
+    contracted.assign(static_cast<size_t>(inner) * noSamples * outer, 0.);
+    for (int o = 0; o < outer; ++o)
+      for (int p = 0; p < noSamples; ++p) {
+        const double* weight = &basis[p*order];
+        const double* source = &tensor[(static_cast<size_t>(o) * sizeOfAxis[axis] + first[p]) * inner];
+        double* destination = &contracted[(static_cast<size_t>(o) * noSamples + p) * inner];
+        if (inner == 1) {
+          for (int j = 0; j < order; ++j)
+            destination[0] += weight[j] * source[j];
+          continue;
+        }
+        for (int j = 0; j < order; ++j, source += inner)
+          for (int k = 0; k < inner; ++k)
+            destination[k] += weight[j] * source[k];
+      }
+    tensor.swap(contracted);
+    sizeOfAxis[axis] = noSamples;
   }
-  return evaluatedValue;
+  values.swap(tensor);
+}
+
+
+template< int dim, int order >
+void Spline<dim, order>::setCoefficientsOf(Spline<1, order>& spline, std::vector<double>& rowMajorC) {
+  spline.c_.swap(rowMajorC);
+}
+
 
+// The stencil of the locked DOFs is the same for all the coefficients of the
+// other DOFs: it is flattened once into order^noFixed (offset, weight) pairs,
+// then every coefficient of the result is one dot product with c_.
+template< int dim, int order >
+template< int remainingDim >
+Spline<remainingDim, order> Spline<dim, order>::getSplineWithFixedDofs(const std::vector<int>& fixedDofs,
+                                                                       const std::vector<double>& fixedValues) const {
+  const int noFixed = fixedDofs.size();
+  if ( (remainingDim < 1) || (noFixed + remainingDim != dim) || (static_cast<int>(fixedValues.size()) != noFixed) ) {
+    std::cout << "Spline<" << dim << "> with " << noFixed << " fixed DOFs and " << fixedValues.size()
+              << " values cannot give a Spline<" << remainingDim << ">" << std::endl;
+    exit(EXIT_FAILURE);
+  }
+  
+  bool isFixed[dim];
+  for (int i = 0; i < dim; ++i)
+    isFixed[i] = false;
+  for (int k = 0; k < noFixed; ++k) {
+    const int axis = fixedDofs[k];
+    if ( (axis < 0) || (axis >= dim) || isFixed[axis] ) {
+      std::cout << "DOF " << axis << " cannot be fixed in a Spline<" << dim << ">" << std::endl;
+      exit(EXIT_FAILURE);
+    }
+    if ( (fixedValues[k] < a_[axis]) || (fixedValues[k] > b_[axis]) ) {
+      std::cout << "Values x are out of boundaries\n";
+      exit(EXIT_FAILURE);
+    }
+    isFixed[axis] = true;
+  }
+  
+  std::vector<int> stencilOffset(1, 0);
+  std::vector<double> stencilWeight(1, 1.);
+  for (int k = 0; k < noFixed; ++k) {
+    const int axis = fixedDofs[k];
+    const int l = computeInterval(axis, fixedValues[k]);
+    const int sizeOfStencil = stencilOffset.size();
+    std::vector<int> newOffset(sizeOfStencil*order);
+    std::vector<double> newWeight(sizeOfStencil*order);
+    for (int j = 0; j < order; ++j) {
+      const int offset = offset_[firstOffset_[axis] + l + j];
+      const double weight = SplineOrder<order>::getValue(fixedValues[k], l+j, a_[axis], h_[axis]);
+      for (int s = 0; s < sizeOfStencil; ++s) {
+        newOffset[j*sizeOfStencil + s] = stencilOffset[s] + offset;
+        newWeight[j*sizeOfStencil + s] = stencilWeight[s] * weight;
+      }
+    }
+    stencilOffset.swap(newOffset);
+    stencilWeight.swap(newWeight);
+  }
+  
+  std::vector<double> a, b;
+  std::vector<int> n, remainingAxes;
+  int sizeOfC = 1;
+  for (int i = 0; i < dim; ++i)
+    if (!isFixed[i]) {
+      a.push_back(a_[i]);
+      b.push_back(b_[i]);
+      n.push_back(n_[i]);
+      remainingAxes.push_back(i);
+      sizeOfC *= SplineOrder<order>::getNumberOfCoefficients(n_[i]);
+    }
+  
+  const int sizeOfStencil = stencilOffset.size();
+  std::vector<double> rowMajorC(sizeOfC);
+  std::vector<int> j(remainingDim, 0);
+  for (int k = 0; k < sizeOfC; ++k) {
+    int cIndex = 0;
+    for (int i = 0; i < remainingDim; ++i)
+      cIndex += offset_[firstOffset_[remainingAxes[i]] + j[i]];
+    double contracted = 0.;
+    for (int s = 0; s < sizeOfStencil; ++s)
+      contracted += stencilWeight[s] * c_[cIndex + stencilOffset[s]];
+    rowMajorC[k] = contracted;
+    for (int i = 0; (i < remainingDim) && (++j[i] == SplineOrder<order>::getNumberOfCoefficients(n[i])); ++i)
+      j[i] = 0;
+  }
+  
+  Spline<remainingDim, order> spline(a, b, n);
+  setCoefficientsOf(spline, rowMajorC);
+  return spline;
 }
 
+
+
 /*************************************** Spline<1> ****************************************/
 
 
-Spline<1>::Spline(const double a, const double b, const int n)
+template< int order >
+Spline<1, order>::Spline(const double a, const double b, const int n)
 :a_(a), b_(b), n_(n), h_((b-a)/n) {
 #ifdef LOG_SPLINE
   std::cout << " Creating Spline<1> n_" << n_ << std::endl;
 #endif
-  c_.empty();
-  c_.resize(n_+3);
-
-#ifdef LOG_SPLINE
-  std::cout << std::endl << " Created Spline of dim 1 " ;
-  std::cout << " a " << a_ << " b " << b_ << " n " << n_ << " h " << h_ << std::endl;
-  std::cout << " number of Coeff " << n_+3 << std::endl;
-#endif 
+  init();
 }
 
-Spline<1>::Spline(const std::vector<double>& a, const std::vector<double>& b, const std::vector<int>& n) 
-:a_(a[a.size()-1]), b_(b[b.size()-1]), n_(n[n.size()-1]), h_((b_-a_)/n_) {
+template< int order >
+Spline<1, order>::Spline(const std::vector<double>& a, const std::vector<double>& b, const std::vector<int>& n) 
+:a_(a[0]), b_(b[0]), n_(n[0]), h_((b_-a_)/n_) {
 #ifdef LOG_SPLINE
   std::cout << " Creating Spline<1> n_:" << n_ << std::endl;
 #endif  
-  c_.empty();
-  c_.resize(n_+3);
- 
+  init();
+}
+
+
+// The orders other than cubic factorize, once per grid, the band system made
+// of the interpolation on the n+1 nodes and of halfWidth end conditions on
+// each side: the derivatives of order 2 to halfWidth+1 equal the ones of the
+// polynomial through the first (last) order nodes. This is the second finite
+// difference of the cubic spline, made accurate enough for the higher orders.
+template< int order >
+void Spline<1, order>::init() {
+  const int halfWidth = SplineOrder<order>::halfWidth;
+  const int noCoefficients = SplineOrder<order>::getNumberOfCoefficients(n_);
+  c_.assign(noCoefficients, 0.);
+
 #ifdef LOG_SPLINE
   std::cout << std::endl << " Created Spline of dim 1 " ;
   std::cout << " a " << a_ << " b " << b_ << " n " << n_ << " h " << h_ << std::endl;
-  std::cout << " number of Coeff " << n_+3 << std::endl;
+  std::cout << " number of Coeff " << noCoefficients << std::endl;
 #endif 
 
+  if (order == 4)
+    return;
+  if (n_ < order-1) {
+    std::cout << "A Spline of order " << order << " needs at least " << order-1 << " intervals\n";
+    exit(EXIT_FAILURE);
+  }
+  
+  // derivatives in 0 of the Lagrange polynomials on the nodes 0, ..., order-1,
+  // with unit spacing: endWeights_[(r-2)*order + m] for the node m
+  endWeights_.assign(halfWidth*order, 0.);
+  for (int m = 0; m < order; ++m) {
+    std::vector<double> polynomial(1, 1.);
+    for (int q = 0; q < order; ++q) {
+      if (q == m)
+        continue;
+      // multiply by (t - q) / (m - q)
+      polynomial.push_back(0.);
+      for (int e = polynomial.size()-1; e >= 0; --e)
+        polynomial[e] = ( (e > 0 ? polynomial[e-1] : 0.) - q * polynomial[e] ) / (m - q);
+    }
+    double factorial = 1;
+    for (int r = 1; r <= halfWidth+1; ++r) {
+      factorial *= r;
+      if (r >= 2)
+        endWeights_[(r-2)*order + m] = factorial * polynomial[r];
+    }
+  }
+  
+  // row halfWidth+i is the interpolation on node i, the basis functions
+  // not null on it are i to i+2*halfWidth
+  fitMatrix_ = SplineBandMatrix(noCoefficients, order, order);
+  for (int i = 0; i <= n_; ++i)
+    for (int j = i; j <= i + 2*halfWidth; ++j)
+      fitMatrix_.set(halfWidth+i, j, SplineOrder<order>::getDerivative(i - (j - halfWidth), 0));
+  for (int r = 2; r <= halfWidth+1; ++r)
+    for (int j = 0; j < order; ++j) {
+      fitMatrix_.set(r-2, j, SplineOrder<order>::getDerivative(0 - (j - halfWidth), r));
+      fitMatrix_.set(noCoefficients-1 - (r-2), noCoefficients-1 - j,
+                     SplineOrder<order>::getDerivative(n_ - (noCoefficients-1 - j - halfWidth), r));
+    }
+  fitMatrix_.factorize();
+}
+
+
+template< int order >
+void Spline<1, order>::computeBandCoefficients(const double* y, const std::ptrdiff_t stride) {
+  const int halfWidth = SplineOrder<order>::halfWidth;
+  const int noCoefficients = c_.size();
+  for (int i = 0; i <= n_; ++i)
+    c_[halfWidth+i] = y[i*stride];
+  // derivatives of order r at the ends, scaled by h^r; at b the spacing is -h
+  for (int r = 2; r <= halfWidth+1; ++r) {
+    double atA = 0, atB = 0;
+    for (int m = 0; m < order; ++m) {
+      atA += endWeights_[(r-2)*order + m] * y[m*stride];
+      atB += endWeights_[(r-2)*order + m] * y[(n_-m)*stride];
+    }
+    c_[r-2] = atA;
+    c_[noCoefficients-1 - (r-2)] = (r % 2) ? -atB : atB;
+  }
+  fitMatrix_.solve(&c_[0]);
+}
 
 
+template< int order >
+void Spline<1, order>::computeCoefficients(const std::vector<double>& /* y */, std::vector<double>::const_iterator fromWhereInY) { 
+  computeCoefficients(&fromWhereInY[0], 1);
 }
 
 
-void Spline<1>::computeCoefficients(const std::vector<double>& y, std::vector<double>::iterator fromWhereInY) { 
+template< int order >
+void Spline<1, order>::computeCoefficients(const double* y, const std::ptrdiff_t stride) { 
 
-  std::vector<double>::iterator toWhereInY = fromWhereInY + (n_+1); 
-  std::vector<double> d;
-  d.assign(fromWhereInY, toWhereInY);
+  if (order != 4) {
+    computeBandCoefficients(y, stride);
+    return;
+  }
+
+  std::vector<double> d(n_+1);
+  for (int i = 0; i <= n_; ++i)
+    d[i] = y[i*stride];
 
   double alpha = (d[2]-2*d[1]+d[0])/(h_*h_);
   double beta = (d[n_]-2*d[n_-1]+d[n_-2])/(h_*h_);
@@ -348,7 +1007,33 @@ void Spline<1>::computeCoefficients(const std::vector<double>& y, std::vector<do
  
 }
 
-void Spline<1>::computeFewCoefficients(const std::vector<double>& y, std::vector<double>::iterator fromWhereInY) {
+template< int order >
+void Spline<1, order>::updateCoefficients(const std::vector<int>& changedNodes, const std::vector<double>& deltaY) {
+
+  if (changedNodes.size() != deltaY.size()) {
+    std::cout << "We have " << changedNodes.size() << " changed nodes, but "
+              << deltaY.size() << " new values\n";
+    exit(EXIT_FAILURE);
+  }
+
+  // the coefficients are linear in y: add the response to each change
+  Spline<1, order> responseSpline(a_, b_, n_);
+  std::vector<double> unitY(n_+1, 0.);
+  for (unsigned int k = 0; k < changedNodes.size(); ++k) {
+    if ( (changedNodes[k] < 0) || (changedNodes[k] > n_) ) {
+      std::cout << "Node " << changedNodes[k] << " out of boundaries\n";
+      exit(EXIT_FAILURE);
+    }
+    unitY[changedNodes[k]] = 1;
+    responseSpline.computeCoefficients(unitY, unitY.begin());
+    unitY[changedNodes[k]] = 0;
+    for (unsigned int i = 0; i < c_.size(); ++i)
+      c_[i] += deltaY[k] * responseSpline.c_[i];
+  }
+}
+
+template< int order >
+void Spline<1, order>::computeFewCoefficients(const std::vector<double>& y, std::vector<double>::iterator fromWhereInY) {
 
   std::vector<double>::iterator toWhereInY = fromWhereInY + (n_+1); 
   std::vector<double> d;
@@ -373,12 +1058,14 @@ void Spline<1>::computeFewCoefficients(const std::vector<double>& y, std::vector
 
 }
 
-void Spline<1>::computeInterval(int& l, int& m, const double x) const {
-  l = floor( ( x - a_ ) / h_ );
-  m = std::min( l + 3, n_ + 2);  
+template< int order >
+void Spline<1, order>::computeInterval(int& l, int& m, const double x) const {
+  l = SplineOrder<order>::computeInterval(x, a_, h_, n_);
+  m = l + order-1;  
 }
 
-double Spline<1>::getValue(const double x) const {
+template< int order >
+double Spline<1, order>::getValue(const double x) const {
   int l, m;
   double evaluatedValue = 0;
   if ( (x < a_) || (x > b_) ) {
@@ -387,12 +1074,13 @@ double Spline<1>::getValue(const double x) const {
   }
   computeInterval(l, m, x);
   for (int i = l; i <=m; ++i) {
-    evaluatedValue += c_[i] * SplineBasisFunction::getValue(x, i, a_, h_);
+    evaluatedValue += c_[i] * SplineOrder<order>::getValue(x, i, a_, h_);
   }
   return evaluatedValue;
 }
 
-double Spline<1>::getFirstDerivative(const double x) {
+template< int order >
+double Spline<1, order>::getFirstDerivative(const double x) const {
   int l, m;
   double evaluatedValue = 0;
   if ( (x < a_) || (x > b_) ) {
@@ -402,7 +1090,7 @@ double Spline<1>::getFirstDerivative(const double x) {
   
   computeInterval(l, m, x);
   for (int i = l; i <= m; ++i)
-    evaluatedValue += c_[i] * SplineBasisFunction::getFirstDerivative(x, i, a_, h_);
+    evaluatedValue += c_[i] * SplineOrder<order>::getFirstDerivative(x, i, a_, h_);
   return evaluatedValue;
 }
 
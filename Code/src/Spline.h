@@ -27,14 +27,30 @@
 
 
 #include <vector>
+#include <cstddef>
 
 #include "SplineBasisFunction.h"
+#include "SplineOrder.h"
+#include "SplineBandMatrix.h"
+#include "SplineStencil.h"
 
-template <int dim>
+// How Spline<dim> stores its coefficients
+enum SplineCoefficientLayout {
+  ROW_MAJOR_LAYOUT,   // first DOF running fastest
+  TILED_LAYOUT,       // tiles of order^dim coefficients, row-major inside and among tiles
+  MORTON_LAYOUT       // Z-order curve, each axis padded to a power of two: for 4 DOFs
+                      // 3.0 times the row-major memory at n = 9, 3.5 at n = 20
+};
+
+// order is the order of the Bspline: 3 quadratic, 4 cubic (the default), 5 quartic, 6 quintic
+template <int dim, int order = 4>
 class Spline; 
 
-template <>
-class Spline<1> {
+template <int dim, int order = 4>
+class SplineFitter;
+
+template <int order>
+class Spline<1, order> {
   private:
     double a_;
     double b_;
@@ -42,42 +58,151 @@ class Spline<1> {
     double h_;
      
     void computeInterval(int& l, int& m, const double x) const;
+    void init();
+    void computeBandCoefficients(const double* y, const std::ptrdiff_t stride);
 
     std::vector<double> c_; 
+    // interpolation conditions and end conditions of the orders other than
+    // cubic, which has its own tridiagonal solver
+    SplineBandMatrix fitMatrix_;
+    std::vector<double> endWeights_;
     
   public:
     Spline(const double a, const double b, const int n);
     Spline(const std::vector<double>& a, const std::vector<double>& b, const std::vector<int>& n); 
     void computeFewCoefficients(const std::vector<double>& y, std::vector<double>::iterator fromWhereInY); 
-    void computeCoefficients(const std::vector<double>& y, std::vector<double>::iterator fromWhereInY); 
+    // the n+1 values start at fromWhereInY; y itself is not read, it stays
+    // in the signature for source compatibility with the callers
+    void computeCoefficients(const std::vector<double>& y, std::vector<double>::const_iterator fromWhereInY); 
+    // the value of node k is y[k * stride]
+    void computeCoefficients(const double* y, const std::ptrdiff_t stride);
+    void updateCoefficients(const std::vector<int>& changedNodes, const std::vector<double>& deltaY);
     double getValue(const double x) const;
-    double getFirstDerivative(const double x);
-    template<int dim> friend class Spline;
+    double getFirstDerivative(const double x) const;
+    template<int otherDim, int otherOrder> friend class Spline;
+    template<int otherDim, int otherOrder> friend class SplineFitter;
 };
 
 
-template <int dim>
+// Evaluation of a multidimensional Bspline, cubic unless another order is
+// given: the grid and one buffer of coefficients. The coefficients come from
+// a SplineFitter<dim, order>, which can be dropped afterwards;
+// computeCoefficients uses a temporary one.
+template <int dim, int order>
 class Spline {
   protected:
-    std::vector<double> a_;
-    std::vector<double> b_;
-    std::vector<int> n_;
-    std::vector<double> h_;
+    double a_[dim];
+    double b_[dim];
+    int n_[dim];
+    double h_[dim];
     
     int sizeOfY_;
     bool checkValues(const std::vector<double>& x) const;
-    void computeInterval(std::vector<int>& l, std::vector<int>& m, const std::vector<double>& x) const;
-    Spline<dim-1> splineFirstPhase_;
-    Spline<1> splineSecondPhase_;
+    int computeInterval(const int axis, const double x) const;
+    void addTensorProduct(const int axis, const int cIndexOfOuterAxes, const double productOfOuterAxes,
+                          const std::vector<const double*>& responses, const std::vector<double>& maxOfInnerAxes,
+                          const double threshold);
+    void init(const std::vector<double>& a, const std::vector<double>& b, const std::vector<int>& n);
+    void computeOffsets();
+    void storeCoefficients(std::vector<double>& rowMajorC);
+    void evaluateOnGrid(const std::vector< std::vector<double> >& samples, const int dimDerivative,
+                        std::vector<double>& values) const;
+    template <typename Scalar> Scalar evaluate(const std::vector<Scalar>& x, const int dimDerivative) const;
+    void computeGradientBasis(const double* x, const int dimDerivative, double (*basis)[order], double (*derivative)[order],
+                              const int** offsets) const;
+    template <int noVariables> SplineDual<noVariables> evaluateDual(const std::vector< SplineDual<noVariables> >& x,
+                                                                    const int dimDerivative) const;
+    double integrateOnBox(const std::vector<double>& lower, const std::vector<double>& upper, const int dimDerivative) const;
+    double contractWeights(const int axis, const int index, const std::vector<double>* weights, const int* first) const;
+    double integrateOnPath(const std::vector< std::vector<double> >& path, const int dimDerivative) const;
+    static void computeGaussLegendre(const int noPoints, std::vector<double>& nodes, std::vector<double>& weights);
+    template <int otherDim> static void setCoefficientsOf(Spline<otherDim, order>& spline, std::vector<double>& rowMajorC);
+    static void setCoefficientsOf(Spline<1, order>& spline, std::vector<double>& rowMajorC);
+    
+    // c_ is stored with layout_: the coefficient (j_0, ..., j_dim-1) is
+    // c_[offset_[firstOffset_[0] + j_0] + ... + offset_[firstOffset_[dim-1] + j_dim-1]]
+    SplineCoefficientLayout layout_;
+    int firstOffset_[dim];
+    std::vector<int> offset_;
     std::vector<double> c_; 
     
   public:
     Spline(const std::vector<double>& a, const std::vector<double>& b, const std::vector<int>& n ); 
+    Spline(const SplineFitter<dim, order>& fitter, const SplineCoefficientLayout layout = ROW_MAJOR_LAYOUT);
+    // the original interface: the values on the nodes are read from
+    // fromWhereInY, and y is passed on to SplineFitter, which ignores it
     void computeCoefficients(std::vector<double>& y, std::vector<double>::iterator fromWhereInY);
+    // Read-only strided view of the values on the nodes: the value of node k
+    // (in the order of y) is y[k * stride]. With the values of all the
+    // muscles of a node side by side, as in the rows of lmt.in, the spline of
+    // muscle i is fitted in place from &rows[i] with stride noMuscles.
+    void computeCoefficients(const double* y, const std::ptrdiff_t stride);
+    // Adds the change deltaY[k] of the values of the nodes changedNodes[k].
+    // The terms below tolerance * |deltaY[k]| are skipped (round-off only by
+    // default), so each changed node costs up to all the coefficients.
+    void updateCoefficients(const std::vector<int>& changedNodes, const std::vector<double>& deltaY,
+                            const double tolerance = 0.);
+    void setLayout(const SplineCoefficientLayout layout);
+    SplineCoefficientLayout getLayout() const { return layout_; }
+    // bytes of the stored coefficients, the padding of the layout included
+    long getMemory() const { return c_.size() * sizeof(double); }
+    // coefficients in row-major order, whatever the layout
+    std::vector<double> getCoefficients() const;
+    void setCoefficients(const std::vector<double>& c);
+    void getStencilIndexes(const std::vector<double>& x, std::vector<int>& indexes) const;
     double getValue(const std::vector<double>& x) const;
-    double getFirstDerivative(const std::vector<double>& x, const int dimDerivative);
-    
-    friend class Spline<dim+1>;
+    double getFirstDerivative(const std::vector<double>& x, const int dimDerivative) const;
+    // The same with another scalar type: float, or SplineDual for the
+    // derivatives with respect to any variables the angles depend on. The
+    // basis is computed in Scalar and the coefficients stay double.
+    template <typename Scalar> Scalar getValue(const std::vector<Scalar>& x) const;
+    template <typename Scalar> Scalar getFirstDerivative(const std::vector<Scalar>& x, const int dimDerivative) const;
+    // SplineDual without propagating it through the basis: the value and the
+    // derivatives along the angles are double stencil sums, with the analytic
+    // derivatives of the basis, and only then chained to the variables.
+    template <int noVariables> SplineDual<noVariables> getValue(const std::vector< SplineDual<noVariables> >& x) const;
+    template <int noVariables> SplineDual<noVariables> getFirstDerivative(const std::vector< SplineDual<noVariables> >& x,
+                                                                          const int dimDerivative) const;
+    // the value and the first derivatives along all the DOFs, in one pass
+    // on the coefficients
+    void getValueAndGradient(const std::vector<double>& x, double& value, std::vector<double>& gradient) const;
+    // values (first derivatives) on the tensor grid of the samples of each
+    // axis, the first axis running fastest as the y of the nodes. The basis
+    // of each axis is computed once per sample and applied to the whole
+    // tensor of coefficients one axis after the other, so a dense grid costs
+    // a few small matrix products instead of a stencil sum per point.
+    void getValuesOnGrid(const std::vector< std::vector<double> >& samples, std::vector<double>& values) const;
+    void getFirstDerivativesOnGrid(const std::vector< std::vector<double> >& samples, const int dimDerivative,
+                                   std::vector<double>& derivatives) const;
+    // Exact integrals of the value, or of its first derivative along
+    // dimDerivative, over the box [lower, upper]. Each basis function has
+    // a closed-form integral (a difference of basis values for the axis of
+    // the derivative), so the cost is one product per coefficient touched by
+    // the box, whatever its size.
+    double getIntegral(const std::vector<double>& lower, const std::vector<double>& upper) const;
+    double getIntegralOfFirstDerivative(const std::vector<double>& lower, const std::vector<double>& upper,
+                                        const int dimDerivative) const;
+    // Exact integrals along the piecewise-linear path through the poses of
+    // path: of the value over the length of the path, and of the first
+    // derivative along dimDerivative times dx[dimDerivative], e.g. the work
+    // of the moment arm of one DOF over a motion (the sum over the DOFs is
+    // the change of the value). Between two crossings of the knots the
+    // spline is a polynomial along the path, integrated by Gauss-Legendre.
+    double getLineIntegral(const std::vector< std::vector<double> >& path) const;
+    double getLineIntegralOfFirstDerivative(const std::vector< std::vector<double> >& path, const int dimDerivative) const;
+    template<int otherDim, int otherOrder> friend class SplineCompressed;
+    template<int otherDim, int otherOrder> friend class SplineBounds;
+    template<int otherDim> friend class SplineBatchEvaluator;
+    template<int otherDim> friend class SplinePoseCache;
+    template<int otherDim> friend class SplineSet;
+    // Partial evaluation: the spline of the other DOFs when the DOFs
+    // fixedDofs are locked at fixedValues. The coefficients are contracted
+    // with the basis of the locked DOFs, so the result is exact and each
+    // locked DOF divides the cost of an evaluation by order.
+    // remainingDim must be dim - fixedDofs.size().
+    template <int remainingDim>
+    Spline<remainingDim, order> getSplineWithFixedDofs(const std::vector<int>& fixedDofs,
+                                                       const std::vector<double>& fixedValues) const;
 };
 
 
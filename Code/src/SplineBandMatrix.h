@@ -0,0 +1,99 @@
+// Copyright (c) 2011, Massimo Sartori and Monica Reggiani
+// All rights reserved.
+
+// Redistribution and use in source and binary forms, with or without 
+// modification, are permitted provided that the following conditions are met:
+// - Redistributions of source code must retain the above copyright notice, 
+//   this list of conditions and the following disclaimer.
+// - Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+
+
+
+#ifndef SplineBandMatrix_h
+#define SplineBandMatrix_h
+
+#include <math.h>
+#include <stdlib.h>
+#include <iostream>
+#include <vector>
+
+// Square band matrix with kl diagonals below and ku above the main one,
+// factorized by Gaussian elimination with partial pivoting among the rows
+// of the band. Row swaps widen the upper band to kl+ku, so each row stores
+// the columns from i-kl to i+kl+ku. Once factorized, solve() can be called
+// for any number of right hand sides.
+class SplineBandMatrix {
+  private:
+    int size_, kl_, ku_, width_;
+    std::vector<double> band_;
+    std::vector<int> pivot_;
+    
+    double& at(const int i, const int j) { return band_[i*width_ + j - i + kl_]; }
+    double at(const int i, const int j) const { return band_[i*width_ + j - i + kl_]; }
+    
+  public:
+    SplineBandMatrix()
+    :size_(0), kl_(0), ku_(0), width_(1) { }
+    
+    SplineBandMatrix(const int size, const int kl, const int ku)
+    :size_(size), kl_(kl), ku_(ku), width_(2*kl + ku + 1), band_(size*(2*kl + ku + 1), 0.), pivot_(size) { }
+    
+    void set(const int i, const int j, const double value) { at(i, j) = value; }
+    
+    void factorize() {
+      for (int p = 0; p < size_; ++p) {
+        const int lastRow = std::min(size_-1, p + kl_);
+        const int lastColumn = std::min(size_-1, p + kl_ + ku_);
+        int q = p;
+        for (int i = p+1; i <= lastRow; ++i)
+          if (fabs(at(i, p)) > fabs(at(q, p)))
+            q = i;
+        if (at(q, p) == 0) {
+          std::cout << "Singular band matrix\n";
+          exit(EXIT_FAILURE);
+        }
+        pivot_[p] = q;
+        if (q != p)
+          for (int j = p; j <= lastColumn; ++j)
+            std::swap(at(p, j), at(q, j));
+        for (int i = p+1; i <= lastRow; ++i) {
+          double m = at(i, p) / at(p, p);
+          at(i, p) = m;
+          for (int j = p+1; j <= lastColumn; ++j)
+            at(i, j) -= m * at(p, j);
+        }
+      }
+    }
+    
+    // b is overwritten with the solution
+    void solve(double* b) const {
+      for (int p = 0; p < size_; ++p) {
+        std::swap(b[p], b[pivot_[p]]);
+        const int lastRow = std::min(size_-1, p + kl_);
+        for (int i = p+1; i <= lastRow; ++i)
+          b[i] -= at(i, p) * b[p];
+      }
+      for (int p = size_-1; p >= 0; --p) {
+        const int lastColumn = std::min(size_-1, p + kl_ + ku_);
+        for (int j = p+1; j <= lastColumn; ++j)
+          b[p] -= at(p, j) * b[j];
+        b[p] /= at(p, p);
+      }
+    }
+};
+
+#endif
@@ -0,0 +1,219 @@
+// Copyright (c) 2011, Massimo Sartori and Monica Reggiani
+// All rights reserved.
+
+// Redistribution and use in source and binary forms, with or without 
+// modification, are permitted provided that the following conditions are met:
+// - Redistributions of source code must retain the above copyright notice, 
+//   this list of conditions and the following disclaimer.
+// - Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+
+
+
+#include <stdlib.h>
+#include <iostream>
+#include <algorithm>
+
+//#define LOG_SPLINE
+
+template< int dim >
+SplineBatchEvaluator<dim>::SplineBatchEvaluator(const SplineSet<dim>& splineSet, const bool numaAware, const int noThreads)
+:splineSet_(splineSet), numaAware_(numaAware), batch_(0), noBusyWorkers_(0), stop_(false),
+ x_(NULL), values_(NULL), noPoses_(0), localAccesses_(0.), remoteAccesses_(0.), cellsPerBin_(0), poseOrder_(NULL) {
+  createReplicas();
+  
+  const int noNodes = topology_.getNumberOfNodes();
+  const int noWorkers = (noThreads > 0) ? noThreads : topology_.getNumberOfCpus();
+  for (int w = 0; w < noWorkers; ++w) {
+    const std::vector<int>& cpus = topology_.getCpusOfNode(w % noNodes);
+    cpuOfWorker_.push_back(cpus[(w / noNodes) % cpus.size()]);
+  }
+  for (int w = 0; w < noWorkers; ++w)
+    workers_.push_back(std::thread(&SplineBatchEvaluator<dim>::work, this, w));
+  
+#ifdef LOG_SPLINE
+  std::cout << "SplineBatchEvaluator: " << noWorkers << " threads on " << noNodes << " NUMA nodes\n";
+#endif
+}
+
+
+template< int dim >
+SplineBatchEvaluator<dim>::~SplineBatchEvaluator() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stop_ = true;
+  }
+  startBatch_.notify_all();
+  for (unsigned int w = 0; w < workers_.size(); ++w)
+    workers_[w].join();
+  for (unsigned int k = 0; k < replicas_.size(); ++k)
+    delete replicas_[k];
+}
+
+
+// A single node uses the given set: it is local already.
+template< int dim >
+void SplineBatchEvaluator<dim>::createReplicas() {
+  const int noNodes = topology_.getNumberOfNodes();
+  replicaOfNode_.assign(noNodes, &splineSet_);
+  if (numaAware_ && (noNodes > 1)) {
+    replicas_.assign(noNodes, NULL);
+    for (int k = 0; k < noNodes; ++k) {
+      std::thread builder([this, k]() {
+        SplineNumaTopology::pinThread(topology_.getCpusOfNode(k)[0]);
+        replicas_[k] = new SplineSet<dim>(splineSet_);
+      });
+      builder.join();
+      replicaOfNode_[k] = replicas_[k];
+    }
+  }
+  
+  localFractionOfNode_.resize(noNodes);
+  for (int k = 0; k < noNodes; ++k)
+    localFractionOfNode_[k] = computeLocalFraction(*replicaOfNode_[k], k);
+}
+
+
+template< int dim >
+double SplineBatchEvaluator<dim>::computeLocalFraction(const SplineSet<dim>& splineSet, const int node) const {
+  long localPages = 0, allPages = 0;
+  std::vector<long> pagesOfNode;
+  for (int i = 0; i < splineSet.getNumberOfMuscles(); ++i) {
+    const std::vector<double>& c = splineSet.getSpline(i).c_;
+    topology_.getPlacement(&c[0], c.size() * sizeof(double), pagesOfNode);
+    localPages += pagesOfNode[node];
+    for (unsigned int k = 0; k < pagesOfNode.size(); ++k)
+      allPages += pagesOfNode[k];
+  }
+  return (allPages > 0) ? static_cast<double>(localPages) / allPages : 1.;
+}
+
+
+template< int dim >
+void SplineBatchEvaluator<dim>::work(const int worker) {
+  if (numaAware_)
+    SplineNumaTopology::pinThread(cpuOfWorker_[worker]);
+  
+  const int noWorkers = cpuOfWorker_.size();
+  const int noMuscles = splineSet_.getNumberOfMuscles();
+  int sizeOfStencil = 1;
+  for (int i = 0; i < dim; ++i)
+    sizeOfStencil *= 4;
+  std::vector<double> x(dim);
+  long lastBatch = 0;
+  
+  for (;;) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    startBatch_.wait(lock, [this, lastBatch]() { return stop_ || (batch_ != lastBatch); });
+    if (stop_)
+      return;
+    lastBatch = batch_;
+    const double* allX = x_;
+    double* values = values_;
+    const long noPoses = noPoses_;
+    const int* poseOrder = poseOrder_;
+    lock.unlock();
+    
+    // unpinned workers may change node in the middle of a slice: we take
+    // the one at its beginning
+    const int node = topology_.getCurrentNode();
+    const SplineSet<dim>& splineSet = *replicaOfNode_[node];
+    const long firstPose = noPoses * worker / noWorkers;
+    const long lastPose = noPoses * (worker+1) / noWorkers;
+    for (long k = firstPose; k < lastPose; ++k) {
+      const long p = (poseOrder != NULL) ? poseOrder[k] : k;
+      for (int i = 0; i < dim; ++i)
+        x[i] = allX[p*dim + i];
+      for (int i = 0; i < noMuscles; ++i)
+        values[p*noMuscles + i] = splineSet.getSpline(i).getValue(x);
+    }
+    const double accesses = static_cast<double>(lastPose - firstPose) * noMuscles * sizeOfStencil;
+    
+    lock.lock();
+    localAccesses_ += accesses * localFractionOfNode_[node];
+    remoteAccesses_ += accesses * (1. - localFractionOfNode_[node]);
+    if (--noBusyWorkers_ == 0)
+      endBatch_.notify_one();
+  }
+}
+
+
+template< int dim >
+void SplineBatchEvaluator<dim>::evaluate(const std::vector<double>& x, std::vector<double>& values) {
+  if (x.size() % dim != 0) {
+    std::cout << "The batch has " << x.size() << " values, not a multiple of " << dim << std::endl;
+    exit(EXIT_FAILURE);
+  }
+  const int noPoses = x.size() / dim;
+  values.resize(noPoses * splineSet_.getNumberOfMuscles());
+  if (values.empty())
+    return;
+  
+  poseOrder_ = NULL;
+  if ( (cellsPerBin_ > 0) && (noPoses > 1) ) {
+    sortPoses(x);
+    poseOrder_ = &sortedPoses_[0];
+  }
+  
+  std::unique_lock<std::mutex> lock(mutex_);
+  x_ = &x[0];
+  values_ = &values[0];
+  noPoses_ = noPoses;
+  noBusyWorkers_ = workers_.size();
+  ++batch_;
+  startBatch_.notify_all();
+  endBatch_.wait(lock, [this]() { return noBusyWorkers_ == 0; });
+}
+
+
+// The key of a pose is its bin, row-major in the grid of bins; a first
+// pass counts the poses of each bin, a second one places them.
+template< int dim >
+void SplineBatchEvaluator<dim>::sortPoses(const std::vector<double>& x) {
+  const Spline<dim>& spline = splineSet_.getSpline(0);
+  const int noPoses = x.size() / dim;
+  int cellsPerBin = cellsPerBin_;
+  long noBins;
+  long binStride[dim];
+  for (;;) {
+    noBins = 1;
+    for (int i = 0; i < dim; ++i) {
+      binStride[i] = noBins;
+      // computeInterval gives one of the n_[i] cells
+      noBins *= (spline.n_[i] + cellsPerBin-1) / cellsPerBin;
+    }
+    if (noBins <= noPoses)
+      break;
+    cellsPerBin *= 2;
+  }
+  
+  keyOfPose_.resize(noPoses);
+  binStart_.assign(noBins+1, 0);
+  for (int p = 0; p < noPoses; ++p) {
+    long key = 0;
+    for (int i = 0; i < dim; ++i) {
+      double xi = std::min(std::max(x[p*dim + i], spline.a_[i]), spline.b_[i]);
+      key += (spline.computeInterval(i, xi) / cellsPerBin) * binStride[i];
+    }
+    keyOfPose_[p] = key;
+    ++binStart_[key+1];
+  }
+  for (long k = 0; k < noBins; ++k)
+    binStart_[k+1] += binStart_[k];
+  sortedPoses_.resize(noPoses);
+  for (int p = 0; p < noPoses; ++p)
+    sortedPoses_[binStart_[keyOfPose_[p]]++] = p;
+}
@@ -0,0 +1,115 @@
+// Copyright (c) 2011, Massimo Sartori and Monica Reggiani
+// All rights reserved.
+
+// Redistribution and use in source and binary forms, with or without 
+// modification, are permitted provided that the following conditions are met:
+// - Redistributions of source code must retain the above copyright notice, 
+//   this list of conditions and the following disclaimer.
+// - Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+
+
+
+#ifndef SplineBatchEvaluator_h
+#define SplineBatchEvaluator_h
+
+
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+#include "SplineSet.h"
+#include "SplineNumaTopology.h"
+
+// Evaluates a SplineSet on a batch of poses with a pool of worker threads,
+// each one on a contiguous slice of the batch.
+// In the NUMA-aware mode each worker is pinned on a CPU, the workers are
+// spread evenly on the nodes, and each node has its own copy of the
+// splines, made by a thread of that node so that the first touch places
+// its pages there. Otherwise all the workers read the given SplineSet,
+// wherever it was allocated, and the scheduler moves them freely.
+// On a single node the two modes differ only by the pinning.
+//
+// The local and remote accesses are estimated from the placement of the
+// pages of the coefficients (see SplineNumaTopology::getPlacement) and from
+// the node of the CPU running the worker: each evaluation of a muscle reads
+// 4^dim coefficients.
+//
+// With binning, the poses of a batch are first sorted by bins of cells of
+// the grid (of the first spline) with a counting sort, so that each worker
+// runs through the bins in turn and the poses of a bin find their
+// coefficients still in cache; the values are written back in the order of
+// the batch. Bins of 4 cells per axis match the tiles of TILED_LAYOUT.
+template <int dim>
+class SplineBatchEvaluator {
+  private:
+    const SplineSet<dim>& splineSet_;
+    SplineNumaTopology topology_;
+    bool numaAware_;
+    std::vector<const SplineSet<dim>*> replicaOfNode_;
+    std::vector<SplineSet<dim>*> replicas_;
+    // fraction of the coefficients of the set used by node k that are on node k
+    std::vector<double> localFractionOfNode_;
+    
+    std::vector<std::thread> workers_;
+    std::vector<int> cpuOfWorker_;
+    std::mutex mutex_;
+    std::condition_variable startBatch_;
+    std::condition_variable endBatch_;
+    long batch_;
+    int noBusyWorkers_;
+    bool stop_;
+    const double* x_;
+    double* values_;
+    int noPoses_;
+    double localAccesses_;
+    double remoteAccesses_;
+    
+    int cellsPerBin_;
+    std::vector<long> keyOfPose_;
+    std::vector<int> binStart_;
+    std::vector<int> sortedPoses_;
+    const int* poseOrder_;
+    
+    SplineBatchEvaluator(const SplineBatchEvaluator&);
+    SplineBatchEvaluator& operator=(const SplineBatchEvaluator&);
+    void createReplicas();
+    double computeLocalFraction(const SplineSet<dim>& splineSet, const int node) const;
+    void work(const int worker);
+    void sortPoses(const std::vector<double>& x);
+    
+  public:
+    // noThreads = 0 uses all the CPUs of the process
+    SplineBatchEvaluator(const SplineSet<dim>& splineSet, const bool numaAware = true, const int noThreads = 0);
+    ~SplineBatchEvaluator();
+    // x has dim values per pose, values gets the values of all the muscles for
+    // each pose: values[p * noMuscles + i] is the muscle i in the pose p
+    void evaluate(const std::vector<double>& x, std::vector<double>& values);
+    // cellsPerBin cells of each axis in a bin, 0 (the default) for no binning.
+    // When the batch is small for the grid, the bins are made larger so that
+    // there are no more bins than poses
+    void setBinning(const int cellsPerBin) { cellsPerBin_ = cellsPerBin; }
+    int getNumberOfThreads() const { return workers_.size(); }
+    const SplineNumaTopology& getTopology() const { return topology_; }
+    // coefficients read since the construction
+    long getLocalAccesses() const { return static_cast<long>(localAccesses_); }
+    long getRemoteAccesses() const { return static_cast<long>(remoteAccesses_); }
+};
+
+
+
+#endif
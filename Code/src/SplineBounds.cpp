@@ -0,0 +1,470 @@
+// Copyright (c) 2011, Massimo Sartori and Monica Reggiani
+// All rights reserved.
+
+// Redistribution and use in source and binary forms, with or without 
+// modification, are permitted provided that the following conditions are met:
+// - Redistributions of source code must retain the above copyright notice, 
+//   this list of conditions and the following disclaimer.
+// - Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+
+
+
+#include <math.h>
+#include <stdlib.h>
+#include <iostream>
+#include <limits>
+#include <algorithm>
+#include <queue>
+
+//#define LOG_SPLINE
+
+// A box of the refinement: a node of the pyramid, or (level -1) a piece of
+// a cell in Bernstein form
+template< int dim, int order >
+struct SplineBounds<dim, order>::Region {
+  double bound;
+  int level;
+  int node[dim];
+  double lower[dim];
+  double upper[dim];
+  bool operator<(const Region& other) const { return bound < other.bound; }
+};
+
+
+template< int dim, int order >
+SplineBounds<dim, order>::SplineBounds(const Spline<dim, order>& spline)
+:spline_(spline), bounds_(dim+1) {
+  std::vector<int> noNodes(dim);
+  for (int i = 0; i < dim; ++i) {
+    sizeOfAxis_[i] = SplineOrder<order>::getNumberOfCoefficients(spline_.n_[i]);
+    noCells_[i] = noNodes[i] = sizeOfAxis_[i] - order + 1;
+  }
+  noNodes_.push_back(noNodes);
+  while (*std::max_element(noNodes.begin(), noNodes.end()) > 1) {
+    for (int i = 0; i < dim; ++i)
+      noNodes[i] = (noNodes[i] + 1) / 2;
+    noNodes_.push_back(noNodes);
+  }
+  for (int quantity = 0; quantity <= dim; ++quantity)
+    buildPyramid(quantity);
+  
+  // invert the matrix of the Bernstein polynomials in m/(order-1)
+  const int degree = order-1;
+  double matrix[order][2*order];
+  for (int m = 0; m < order; ++m) {
+    const double t = static_cast<double>(m) / degree;
+    double binomial = 1;
+    for (int k = 0; k < order; ++k) {
+      matrix[m][k] = binomial * pow(t, k) * pow(1-t, degree-k);
+      matrix[m][order+k] = (k == m) ? 1. : 0.;
+      binomial = binomial * (degree-k) / (k+1);
+    }
+  }
+  for (int k = 0; k < order; ++k) {
+    int pivot = k;
+    for (int m = k+1; m < order; ++m)
+      if (fabs(matrix[m][k]) > fabs(matrix[pivot][k]))
+        pivot = m;
+    for (int j = 0; j < 2*order; ++j)
+      std::swap(matrix[k][j], matrix[pivot][j]);
+    const double inverse = 1. / matrix[k][k];
+    for (int j = 0; j < 2*order; ++j)
+      matrix[k][j] *= inverse;
+    for (int m = 0; m < order; ++m)
+      if (m != k) {
+        const double factor = matrix[m][k];
+        for (int j = 0; j < 2*order; ++j)
+          matrix[m][j] -= factor * matrix[k][j];
+      }
+  }
+  for (int k = 0; k < order; ++k)
+    for (int m = 0; m < order; ++m)
+      fromValues_[k*order + m] = matrix[k][order+m];
+  
+#ifdef LOG_SPLINE
+  std::cout << "SplineBounds: " << noNodes_.size() << " levels, " << getMemory() << " bytes\n";
+#endif
+}
+
+
+// the first axis running fastest; size[axis] is left to the caller
+template< int dim, int order >
+void SplineBounds<dim, order>::slide(std::vector<double>& tensor, std::vector<int>& size, const int axis, const int width,
+                                     const bool maximum) {
+  int inner = 1, outer = 1;
+  for (int i = 0; i < axis; ++i)
+    inner *= size[i];
+  for (int i = axis+1; i < dim; ++i)
+    outer *= size[i];
+  const int noIn = size[axis], noOut = size[axis] - width + 1;
+  std::vector<double> slid(static_cast<long>(inner) * noOut * outer);
+  for (int o = 0; o < outer; ++o)
+    for (int p = 0; p < noOut; ++p)
+      for (int q = 0; q < inner; ++q) {
+        const double* in = &tensor[(static_cast<long>(o) * noIn + p) * inner + q];
+        double value = in[0];
+        for (int j = 1; j < width; ++j)
+          value = maximum ? std::max(value, in[j * inner]) : std::min(value, in[j * inner]);
+        slid[(static_cast<long>(o) * noOut + p) * inner + q] = value;
+      }
+  tensor.swap(slid);
+}
+
+
+// the minimum and the maximum of the coefficients touching each cell, or of
+// their differences along the axis of the derivative, in windows of order
+// (order-1 for the differences) on each axis one after the other
+template< int dim, int order >
+void SplineBounds<dim, order>::computeCellBounds(const int quantity, std::vector<float>& bounds) const {
+  const int dimDerivative = quantity - 1;
+  std::vector<double> minimum(spline_.getCoefficients());
+  std::vector<int> size(sizeOfAxis_, sizeOfAxis_ + dim);
+  double scale = 1;
+  for (int m = 2; m < order; ++m)
+    scale *= m;
+  scale = pow(scale, dim);
+  
+  if (dimDerivative >= 0) {
+    int inner = 1, outer = 1;
+    for (int i = 0; i < dimDerivative; ++i)
+      inner *= size[i];
+    for (int i = dimDerivative+1; i < dim; ++i)
+      outer *= size[i];
+    const int noIn = size[dimDerivative];
+    std::vector<double> differences(static_cast<long>(inner) * (noIn-1) * outer);
+    for (int o = 0; o < outer; ++o)
+      for (int p = 0; p < noIn-1; ++p)
+        for (int q = 0; q < inner; ++q)
+          differences[(static_cast<long>(o) * (noIn-1) + p) * inner + q] 
+            = minimum[(static_cast<long>(o) * noIn + p+1) * inner + q] - minimum[(static_cast<long>(o) * noIn + p) * inner + q];
+    minimum.swap(differences);
+    --size[dimDerivative];
+    scale /= spline_.h_[dimDerivative];
+  }
+  
+  std::vector<double> maximum(minimum);
+  for (int i = 0; i < dim; ++i) {
+    const int width = (i == dimDerivative) ? order-1 : order;
+    slide(minimum, size, i, width, false);
+    slide(maximum, size, i, width, true);
+    size[i] -= width - 1;
+  }
+  // rounded outwards to float
+  bounds.resize(2 * minimum.size());
+  for (unsigned int cell = 0; cell < minimum.size(); ++cell) {
+    bounds[2*cell] = nextafterf(static_cast<float>(scale * minimum[cell]), -std::numeric_limits<float>::max());
+    bounds[2*cell + 1] = nextafterf(static_cast<float>(scale * maximum[cell]), std::numeric_limits<float>::max());
+  }
+}
+
+
+template< int dim, int order >
+void SplineBounds<dim, order>::buildPyramid(const int quantity) {
+  std::vector< std::vector<float> >& levels = bounds_[quantity];
+  levels.resize(noNodes_.size());
+  computeCellBounds(quantity, levels[0]);
+  for (unsigned int level = 1; level < noNodes_.size(); ++level) {
+    const std::vector<int>& below = noNodes_[level-1];
+    const std::vector<int>& here = noNodes_[level];
+    int noHere = 1;
+    for (int i = 0; i < dim; ++i)
+      noHere *= here[i];
+    std::vector<float>& merged = levels[level];
+    merged.resize(2 * noHere);
+    for (int node = 0; node < noHere; ++node) {
+      merged[2*node] = std::numeric_limits<float>::max();
+      merged[2*node + 1] = -std::numeric_limits<float>::max();
+    }
+    const std::vector<float>& children = levels[level-1];
+    const int noBelow = children.size() / 2;
+    for (int child = 0; child < noBelow; ++child) {
+      int rest = child, node = 0, stride = 1;
+      for (int i = 0; i < dim; ++i) {
+        node += (rest % below[i]) / 2 * stride;
+        rest /= below[i];
+        stride *= here[i];
+      }
+      merged[2*node] = std::min(merged[2*node], children[2*child]);
+      merged[2*node + 1] = std::max(merged[2*node + 1], children[2*child + 1]);
+    }
+  }
+}
+
+
+template< int dim, int order >
+int SplineBounds<dim, order>::getCell(const int axis, const double x) const {
+  return SplineOrder<order>::computeInterval(x, spline_.a_[axis], spline_.h_[axis], spline_.n_[axis]);
+}
+
+
+template< int dim, int order >
+void SplineBounds<dim, order>::checkBox(const std::vector<double>& lower, const std::vector<double>& upper) const {
+  for (int i = 0; i < dim; ++i)
+    if ( (lower[i] < spline_.a_[i]) || (upper[i] > spline_.b_[i]) || (lower[i] > upper[i]) ) {
+      std::cout << "The box is out of boundaries or its lower corner is above the upper one\n";
+      exit(EXIT_FAILURE);
+    }
+}
+
+
+// the children of a node of the pyramid that meet the cells [firstCell, lastCell]
+template< int dim, int order >
+void SplineBounds<dim, order>::pushChildren(const int quantity, const double sign, const Region& region,
+                                            const int* firstCell, const int* lastCell, std::priority_queue<Region>& queue) const {
+  Region child;
+  child.level = region.level - 1;
+  for (int bits = 0; bits < (1 << dim); ++bits) {
+    bool useful = true;
+    int index = 0, stride = 1;
+    for (int i = 0; i < dim; ++i) {
+      child.node[i] = 2*region.node[i] + ( (bits >> i) & 1 );
+      const int first = child.node[i] << child.level;
+      const int last = std::min( ( (child.node[i]+1) << child.level ) - 1, noCells_[i] - 1);
+      useful = useful && (child.node[i] < noNodes_[child.level][i]) && (last >= firstCell[i]) && (first <= lastCell[i]);
+      index += child.node[i] * stride;
+      stride *= noNodes_[child.level][i];
+    }
+    if (!useful)
+      continue;
+    child.bound = (sign > 0) ? bounds_[quantity][child.level][2*index + 1] : -bounds_[quantity][child.level][2*index];
+    queue.push(child);
+  }
+}
+
+
+// Best first: the node with the largest bound is opened first, so the first
+// one inside the box (or a cell meeting it) gives the result, and the nodes
+// below it are never visited
+template< int dim, int order >
+double SplineBounds<dim, order>::searchMaximum(const int quantity, const double sign, const int* firstCell,
+                                               const int* lastCell) const {
+  const int top = noNodes_.size() - 1;
+  std::priority_queue<Region> queue;
+  Region region;
+  region.level = top;
+  for (int i = 0; i < dim; ++i)
+    region.node[i] = 0;
+  region.bound = (sign > 0) ? bounds_[quantity][top][1] : -bounds_[quantity][top][0];
+  queue.push(region);
+  while (true) {
+    region = queue.top();
+    queue.pop();
+    bool inside = true;
+    for (int i = 0; inside && (i < dim); ++i) {
+      const int first = region.node[i] << region.level;
+      const int last = std::min( ( (region.node[i]+1) << region.level ) - 1, noCells_[i] - 1);
+      inside = (first >= firstCell[i]) && (last <= lastCell[i]);
+    }
+    if (inside || (region.level == 0))
+      return region.bound;
+    pushChildren(quantity, sign, region, firstCell, lastCell, queue);
+  }
+}
+
+
+template< int dim, int order >
+void SplineBounds<dim, order>::getBounds(const std::vector<double>& lower, const std::vector<double>& upper,
+                                         double& minimum, double& maximum) const {
+  getFirstDerivativeBounds(lower, upper, -1, minimum, maximum);
+}
+
+
+// dimDerivative -1 is the value
+template< int dim, int order >
+void SplineBounds<dim, order>::getFirstDerivativeBounds(const std::vector<double>& lower, const std::vector<double>& upper,
+                                                        const int dimDerivative, double& minimum, double& maximum) const {
+  checkBox(lower, upper);
+  int firstCell[dim], lastCell[dim];
+  for (int i = 0; i < dim; ++i) {
+    firstCell[i] = getCell(i, lower[i]);
+    lastCell[i] = getCell(i, upper[i]);
+  }
+  maximum = searchMaximum(dimDerivative+1, 1., firstCell, lastCell);
+  minimum = -searchMaximum(dimDerivative+1, -1., firstCell, lastCell);
+}
+
+
+// bernstein[k_0 + order*k_1 + ...] are the Bernstein coefficients, on the
+// box [lower, upper] inside the cell, of the value (of the first derivative
+// along dimDerivative): the basis of each axis is sampled in order points
+// and turned to Bernstein, then applied to the coefficients of the cell
+template< int dim, int order >
+void SplineBounds<dim, order>::computeBernstein(const int dimDerivative, const int* cell, const double* lower, const double* upper,
+                                                std::vector<double>& bernstein) const {
+  double toBernstein[dim][order*order];
+  for (int i = 0; i < dim; ++i) {
+    double values[order][order];
+    for (int m = 0; m < order; ++m) {
+      const double x = lower[i] + (upper[i] - lower[i]) * m / (order-1);
+      for (int j = 0; j < order; ++j)
+        values[m][j] = (i == dimDerivative) 
+                       ? SplineOrder<order>::getFirstDerivative(x, cell[i]+j, spline_.a_[i], spline_.h_[i])
+                       : SplineOrder<order>::getValue(x, cell[i]+j, spline_.a_[i], spline_.h_[i]);
+    }
+    for (int k = 0; k < order; ++k)
+      for (int j = 0; j < order; ++j) {
+        double sum = 0;
+        for (int m = 0; m < order; ++m)
+          sum += fromValues_[k*order + m] * values[m][j];
+        toBernstein[i][k*order + j] = sum;
+      }
+  }
+  
+  int size = 1;
+  for (int i = 0; i < dim; ++i)
+    size *= order;
+  bernstein.resize(size);
+  int j[dim], index[dim+1];
+  for (int i = 0; i < dim; ++i)
+    j[i] = 0;
+  for (int p = 0; p < size; ++p) {
+    index[dim] = 0;
+    for (int i = dim-1; i >= 0; --i)
+      index[i] = index[i+1] + spline_.offset_[spline_.firstOffset_[i] + cell[i] + j[i]];
+    bernstein[p] = spline_.c_[index[0]];
+    for (int i = 0; (i < dim) && (++j[i] == order); ++i)
+      j[i] = 0;
+  }
+  std::vector<double> applied(size);
+  int inner = 1;
+  for (int i = 0; i < dim; ++i) {
+    for (int first = 0; first < size; first += inner * order)
+      for (int k = 0; k < order; ++k)
+        for (int q = 0; q < inner; ++q) {
+          const double* in = &bernstein[first + q];
+          double sum = 0;
+          for (int m = 0; m < order; ++m)
+            sum += toBernstein[i][k*order + m] * in[m * inner];
+          applied[first + k * inner + q] = sum;
+        }
+    bernstein.swap(applied);
+    inner *= order;
+  }
+}
+
+
+// Branch and bound on sign * the value (its first derivative): the upper
+// bound of the best region, once within tolerance of the best corner value
+template< int dim, int order >
+double SplineBounds<dim, order>::refineMaximum(const std::vector<double>& lower, const std::vector<double>& upper,
+                                               const int dimDerivative, const double sign, const double tolerance) const {
+  const int quantity = dimDerivative + 1;
+  const int top = noNodes_.size() - 1;
+  int firstCell[dim], lastCell[dim];
+  for (int i = 0; i < dim; ++i) {
+    firstCell[i] = getCell(i, lower[i]);
+    lastCell[i] = getCell(i, upper[i]);
+  }
+  const double shift = (order % 2) ? 0.5 : 0.;
+  
+  std::priority_queue<Region> queue;
+  Region region;
+  region.level = top;
+  for (int i = 0; i < dim; ++i)
+    region.node[i] = 0;
+  region.bound = (sign > 0) ? bounds_[quantity][top][1] : -bounds_[quantity][top][0];
+  queue.push(region);
+  // below the round-off of the Bernstein forms, the halves would be split forever
+  const double magnitude = std::max(fabs(bounds_[quantity][top][0]), fabs(bounds_[quantity][top][1]));
+  const double reachableTolerance = std::max(tolerance, 1e-12 * magnitude);
+  double best = -std::numeric_limits<double>::max();
+  std::vector<double> bernstein;
+  const int noCorners = 1 << dim;
+  
+  while (!queue.empty()) {
+    region = queue.top();
+    if (region.bound - best <= reachableTolerance)
+      return region.bound;
+    queue.pop();
+    
+    if (region.level > 0) {
+      pushChildren(quantity, sign, region, firstCell, lastCell, queue);
+      continue;
+    }
+    
+    // a cell gives its piece inside the box, a piece its two halves along
+    // the axis longest compared to its h
+    Region pieces[2];
+    int noPieces = 1;
+    pieces[0] = region;
+    pieces[0].level = -1;
+    if (region.level == 0)
+      for (int i = 0; i < dim; ++i) {
+        const double cellLower = spline_.a_[i] + (region.node[i] - shift) * spline_.h_[i];
+        pieces[0].lower[i] = std::max(lower[i], cellLower);
+        pieces[0].upper[i] = std::min(upper[i], cellLower + spline_.h_[i]);
+      }
+    else {
+      int longest = 0;
+      for (int i = 1; i < dim; ++i)
+        if ( (region.upper[i] - region.lower[i]) / spline_.h_[i] > (region.upper[longest] - region.lower[longest]) / spline_.h_[longest] )
+          longest = i;
+      pieces[1] = pieces[0];
+      pieces[0].upper[longest] = pieces[1].lower[longest] = 0.5 * (region.lower[longest] + region.upper[longest]);
+      noPieces = 2;
+    }
+    
+    for (int p = 0; p < noPieces; ++p) {
+      computeBernstein(dimDerivative, pieces[p].node, pieces[p].lower, pieces[p].upper, bernstein);
+      pieces[p].bound = -std::numeric_limits<double>::max();
+      for (unsigned int k = 0; k < bernstein.size(); ++k)
+        pieces[p].bound = std::max(pieces[p].bound, sign * bernstein[k]);
+      // the corners of the Bernstein form are values of the spline
+      for (int corner = 0; corner < noCorners; ++corner) {
+        int index = 0, stride = 1;
+        for (int i = 0; i < dim; ++i) {
+          index += ( (corner >> i) & 1 ) * (order-1) * stride;
+          stride *= order;
+        }
+        best = std::max(best, sign * bernstein[index]);
+      }
+      queue.push(pieces[p]);
+    }
+  }
+  return best;
+}
+
+
+template< int dim, int order >
+void SplineBounds<dim, order>::getTightBounds(const std::vector<double>& lower, const std::vector<double>& upper,
+                                              const double tolerance, double& minimum, double& maximum) const {
+  getTightFirstDerivativeBounds(lower, upper, -1, tolerance, minimum, maximum);
+}
+
+
+template< int dim, int order >
+void SplineBounds<dim, order>::getTightFirstDerivativeBounds(const std::vector<double>& lower, const std::vector<double>& upper,
+                                                             const int dimDerivative, const double tolerance,
+                                                             double& minimum, double& maximum) const {
+  checkBox(lower, upper);
+  if (tolerance <= 0) {
+    std::cout << "The tolerance of the bounds must be positive\n";
+    exit(EXIT_FAILURE);
+  }
+  maximum = refineMaximum(lower, upper, dimDerivative, 1., tolerance);
+  minimum = -refineMaximum(lower, upper, dimDerivative, -1., tolerance);
+}
+
+
+template< int dim, int order >
+long SplineBounds<dim, order>::getMemory() const {
+  long noBounds = 0;
+  for (unsigned int quantity = 0; quantity < bounds_.size(); ++quantity)
+    for (unsigned int level = 0; level < bounds_[quantity].size(); ++level)
+      noBounds += bounds_[quantity][level].size();
+  return noBounds * sizeof(float);
+}
@@ -0,0 +1,108 @@
+// Copyright (c) 2011, Massimo Sartori and Monica Reggiani
+// All rights reserved.
+
+// Redistribution and use in source and binary forms, with or without 
+// modification, are permitted provided that the following conditions are met:
+// - Redistributions of source code must retain the above copyright notice, 
+//   this list of conditions and the following disclaimer.
+// - Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+
+
+
+#ifndef SplineBounds_h
+#define SplineBounds_h
+
+
+#include <vector>
+#include <queue>
+
+#include "Spline.h"
+
+// Bounds of a spline, and of its first derivatives, over boxes of the DOFs,
+// e.g. to tell whether a muscle can exceed a length anywhere in a region.
+// A B-spline lies in the convex hull of the coefficients touching a cell,
+// so each cell gets ((order-1)!)^dim times their minimum and maximum, and
+// the first derivative along i the same with the differences of the
+// coefficients along i, divided by h_i. The cells are merged two by two on
+// each axis into a pyramid, up to a single node. The maximum over a box
+// opens the nodes meeting it best bound first and stops at the first one
+// inside the box (or a cell), so the nodes that cannot beat it are never
+// visited; this is not logarithmic, the worst case still opens the nodes
+// along the border of the box, its surface in cells. The pyramids of the
+// value and of the dim first derivatives take 2*(dim+1)*2^dim/(2^dim-1)
+// floats per cell, about 3 times the coefficients: 6.8 MB against 2.2 MB
+// for 4 DOFs and n = 20.
+// These bounds are conservative. The tight bounds refine them where they
+// matter only: the nodes are opened best bound first, a cell cut by the box
+// is rewritten in Bernstein form, whose corners are exact values, and split
+// in halves until the bound is within tolerance of a value reached. Every
+// cell whose convex hull exceeds the extremum is opened, some hundreds on
+// boxes of a quarter of the range with n = 20, so a tight bound costs a
+// third of sampling the box in 12^4 points for the value, and nearly as
+// much for a first derivative (see checkBounds in cppTest/readme.txt).
+template <int dim, int order = 4>
+class SplineBounds {
+  private:
+    struct Region;
+    
+    const Spline<dim, order>& spline_;
+    int sizeOfAxis_[dim];
+    int noCells_[dim];
+    // bounds_[quantity][level][2*node] and [2*node+1], the minimum and the
+    // maximum of the quantity (0 the value, 1+i the first derivative along i)
+    // on the node; level 0 are the cells, the first axis running fastest.
+    // float is plenty for bounds rounded outwards, and halves the memory
+    std::vector< std::vector< std::vector<float> > > bounds_;
+    std::vector< std::vector<int> > noNodes_;
+    // Bernstein coefficients of the polynomial with values v_m in m/(order-1):
+    // fromValues_[k*order + m] * v_m
+    double fromValues_[order*order];
+    
+    static void slide(std::vector<double>& tensor, std::vector<int>& size, const int axis, const int width, const bool maximum);
+    void computeCellBounds(const int quantity, std::vector<float>& bounds) const;
+    void buildPyramid(const int quantity);
+    int getCell(const int axis, const double x) const;
+    void checkBox(const std::vector<double>& lower, const std::vector<double>& upper) const;
+    void pushChildren(const int quantity, const double sign, const Region& region, const int* firstCell,
+                      const int* lastCell, std::priority_queue<Region>& queue) const;
+    double searchMaximum(const int quantity, const double sign, const int* firstCell, const int* lastCell) const;
+    void computeBernstein(const int dimDerivative, const int* cell, const double* lower, const double* upper,
+                          std::vector<double>& bernstein) const;
+    double refineMaximum(const std::vector<double>& lower, const std::vector<double>& upper, const int dimDerivative,
+                         const double sign, const double tolerance) const;
+    
+  public:
+    SplineBounds(const Spline<dim, order>& spline);
+    // conservative bounds over the box [lower, upper]
+    void getBounds(const std::vector<double>& lower, const std::vector<double>& upper,
+                   double& minimum, double& maximum) const;
+    void getFirstDerivativeBounds(const std::vector<double>& lower, const std::vector<double>& upper, const int dimDerivative,
+                                  double& minimum, double& maximum) const;
+    // bounds at most tolerance away from the true extrema, still conservative;
+    // a tolerance below the round-off of the values (1e-12 of their
+    // magnitude) is raised to it
+    void getTightBounds(const std::vector<double>& lower, const std::vector<double>& upper, const double tolerance,
+                        double& minimum, double& maximum) const;
+    void getTightFirstDerivativeBounds(const std::vector<double>& lower, const std::vector<double>& upper,
+                                       const int dimDerivative, const double tolerance,
+                                       double& minimum, double& maximum) const;
+    long getMemory() const;
+};
+
+
+
+#endif
@@ -0,0 +1,310 @@
+// Copyright (c) 2011, Massimo Sartori and Monica Reggiani
+// All rights reserved.
+
+// Redistribution and use in source and binary forms, with or without 
+// modification, are permitted provided that the following conditions are met:
+// - Redistributions of source code must retain the above copyright notice, 
+//   this list of conditions and the following disclaimer.
+// - Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+
+
+
+#include <string>
+#include <vector>
+#include <limits.h>
+
+#include "SplineC.h"
+#include "Spline.h"
+#include "Spline.cpp"
+#include "SplineSet.h"
+#include "SplineSet.cpp"
+
+// the model behind a SplineSetHandle, whatever its number of DOFs
+struct SplineSetC {
+  int dim_;
+  std::vector<double> a_, b_;
+  int noMuscles_;
+  // checkGrid makes sure it fits in an int
+  int noCoefficients_;
+  
+  SplineSetC(const int dim, const double* a, const double* b, const int* n, const int noMuscles)
+  :dim_(dim), a_(a, a+dim), b_(b, b+dim), noMuscles_(noMuscles) {
+    noCoefficients_ = static_cast<int>(getNumberOfCoefficients(dim, n));
+  }
+  
+  static ptrdiff_t getNumberOfCoefficients(const int dim, const int* n) {
+    ptrdiff_t noCoefficients = 1;
+    for (int i = 0; i < dim; ++i)
+      noCoefficients *= static_cast<ptrdiff_t>(n[i]) + 3;
+    return noCoefficients;
+  }
+  virtual ~SplineSetC() { }
+  
+  // written so that NaN is out too
+  bool isInside(const double* x, const ptrdiff_t xDofStride) const {
+    for (int i = 0; i < dim_; ++i)
+      if ( !( (x[i*xDofStride] >= a_[i]) && (x[i*xDofStride] <= b_[i]) ) )
+        return false;
+    return true;
+  }
+  
+  virtual void getCoefficients(const int muscle, double* c, const ptrdiff_t cStride) const = 0;
+  virtual int evaluate(const ptrdiff_t noFrames, const double* x, const ptrdiff_t xFrameStride, const ptrdiff_t xDofStride,
+                       double* values, const ptrdiff_t valueFrameStride, const ptrdiff_t valueMuscleStride) const = 0;
+  virtual int evaluateFirstDerivatives(const ptrdiff_t noFrames, const double* x, const ptrdiff_t xFrameStride, const ptrdiff_t xDofStride,
+                                       double* derivatives, const ptrdiff_t derivativeFrameStride,
+                                       const ptrdiff_t derivativeMuscleStride, const ptrdiff_t derivativeDofStride) const = 0;
+};
+
+
+namespace {
+
+template <int dim>
+class SplineSetCImpl : public SplineSetC {
+  private:
+    SplineSet<dim>* splineSet_;
+    
+    SplineSetCImpl(const SplineSetCImpl&);
+    SplineSetCImpl& operator=(const SplineSetCImpl&);
+    
+  public:
+    SplineSetCImpl(const double* a, const double* b, const int* n, const int noMuscles, SplineSet<dim>* splineSet)
+    :SplineSetC(dim, a, b, n, noMuscles), splineSet_(splineSet) { }
+    ~SplineSetCImpl() { delete splineSet_; }
+    
+    static SplineSetC* fit(const double* a, const double* b, const int* n, const int noMuscles,
+                           const double* y, const ptrdiff_t yNodeStride, const ptrdiff_t yMuscleStride) {
+      std::vector<double> aV(a, a+dim), bV(b, b+dim);
+      std::vector<int> nV(n, n+dim);
+      
+      // the fitter reads the strided columns in place
+      SplineFitter<dim> fitter(aV, bV, nV);
+      std::vector< Spline<dim> > splines;
+      splines.reserve(noMuscles);
+      for (int k = 0; k < noMuscles; ++k) {
+        fitter.computeCoefficients(y + k*yMuscleStride, yNodeStride);
+        splines.push_back(Spline<dim>(fitter));
+      }
+      return new SplineSetCImpl<dim>(a, b, n, noMuscles,
+                                     new SplineSet<dim>(std::vector<std::string>(noMuscles), splines));
+    }
+    
+    static SplineSetC* create(const double* a, const double* b, const int* n, const int noMuscles,
+                              const double* c, const ptrdiff_t cCoefficientStride, const ptrdiff_t cMuscleStride) {
+      std::vector<double> aV(a, a+dim), bV(b, b+dim);
+      std::vector<int> nV(n, n+dim);
+      const int noCoefficients = static_cast<int>(getNumberOfCoefficients(dim, n));
+      
+      std::vector<double> muscleC(noCoefficients);
+      std::vector< Spline<dim> > splines(noMuscles, Spline<dim>(aV, bV, nV));
+      for (int k = 0; k < noMuscles; ++k) {
+        const double* cOfMuscle = c + k*cMuscleStride;
+        for (int j = 0; j < noCoefficients; ++j)
+          muscleC[j] = cOfMuscle[j*cCoefficientStride];
+        splines[k].setCoefficients(muscleC);
+      }
+      return new SplineSetCImpl<dim>(a, b, n, noMuscles,
+                                     new SplineSet<dim>(std::vector<std::string>(noMuscles), splines));
+    }
+    
+    void getCoefficients(const int muscle, double* c, const ptrdiff_t cStride) const {
+      std::vector<double> muscleC = splineSet_->getSpline(muscle).getCoefficients();
+      for (unsigned int j = 0; j < muscleC.size(); ++j)
+        c[j*cStride] = muscleC[j];
+    }
+    
+    int evaluate(const ptrdiff_t noFrames, const double* x, const ptrdiff_t xFrameStride, const ptrdiff_t xDofStride,
+                 double* values, const ptrdiff_t valueFrameStride, const ptrdiff_t valueMuscleStride) const {
+      std::vector<double> pose(dim);
+      for (ptrdiff_t f = 0; f < noFrames; ++f) {
+        const double* xOfFrame = x + f*xFrameStride;
+        if (!isInside(xOfFrame, xDofStride))
+          return SPLINE_C_OUT_OF_BOUNDS;
+        for (int i = 0; i < dim; ++i)
+          pose[i] = xOfFrame[i*xDofStride];
+        double* valuesOfFrame = values + f*valueFrameStride;
+        for (int k = 0; k < noMuscles_; ++k)
+          valuesOfFrame[k*valueMuscleStride] = splineSet_->getSpline(k).getValue(pose);
+      }
+      return SPLINE_C_OK;
+    }
+    
+    int evaluateFirstDerivatives(const ptrdiff_t noFrames, const double* x, const ptrdiff_t xFrameStride, const ptrdiff_t xDofStride,
+                                 double* derivatives, const ptrdiff_t derivativeFrameStride,
+                                 const ptrdiff_t derivativeMuscleStride, const ptrdiff_t derivativeDofStride) const {
+      std::vector<double> pose(dim);
+      for (ptrdiff_t f = 0; f < noFrames; ++f) {
+        const double* xOfFrame = x + f*xFrameStride;
+        if (!isInside(xOfFrame, xDofStride))
+          return SPLINE_C_OUT_OF_BOUNDS;
+        for (int i = 0; i < dim; ++i)
+          pose[i] = xOfFrame[i*xDofStride];
+        double* derivativesOfFrame = derivatives + f*derivativeFrameStride;
+        for (int k = 0; k < noMuscles_; ++k)
+          for (int i = 0; i < dim; ++i)
+            derivativesOfFrame[k*derivativeMuscleStride + i*derivativeDofStride] = splineSet_->getSpline(k).getFirstDerivative(pose, i);
+      }
+      return SPLINE_C_OK;
+    }
+};
+
+
+bool checkGrid(const int dim, const double* a, const double* b, const int* n, const int noMuscles, const double* data) {
+  if (dim < 2 || dim > SPLINE_C_MAX_DIM || a == NULL || b == NULL || n == NULL || noMuscles < 1 || data == NULL)
+    return false;
+  // the cubic fit needs 2 intervals at least on each axis
+  for (int i = 0; i < dim; ++i)
+    if (n[i] < 2 || !(a[i] < b[i]))
+      return false;
+  // the coefficients of a muscle are counted and indexed in int: with
+  // n[i] < INT_MAX the product below stays within 62 bits until it stops
+  ptrdiff_t noCoefficients = 1;
+  for (int i = 0; i < dim; ++i) {
+    noCoefficients *= static_cast<ptrdiff_t>(n[i]) + 3;
+    if (noCoefficients > INT_MAX)
+      return false;
+  }
+  return true;
+}
+
+}
+
+
+extern "C" {
+
+SplineSetHandle splineSetFit(int dim, const double* a, const double* b, const int* n, int noMuscles,
+                             const double* y, ptrdiff_t yNodeStride, ptrdiff_t yMuscleStride) {
+  try {
+    if (!checkGrid(dim, a, b, n, noMuscles, y))
+      return NULL;
+    switch (dim) {
+      case 2: return SplineSetCImpl<2>::fit(a, b, n, noMuscles, y, yNodeStride, yMuscleStride);
+      case 3: return SplineSetCImpl<3>::fit(a, b, n, noMuscles, y, yNodeStride, yMuscleStride);
+      case 4: return SplineSetCImpl<4>::fit(a, b, n, noMuscles, y, yNodeStride, yMuscleStride);
+      case 5: return SplineSetCImpl<5>::fit(a, b, n, noMuscles, y, yNodeStride, yMuscleStride);
+      case 6: return SplineSetCImpl<6>::fit(a, b, n, noMuscles, y, yNodeStride, yMuscleStride);
+    }
+    return NULL;
+  }
+  catch (...) {
+    return NULL;
+  }
+}
+
+
+SplineSetHandle splineSetCreate(int dim, const double* a, const double* b, const int* n, int noMuscles,
+                                const double* c, ptrdiff_t cCoefficientStride, ptrdiff_t cMuscleStride) {
+  try {
+    if (!checkGrid(dim, a, b, n, noMuscles, c))
+      return NULL;
+    switch (dim) {
+      case 2: return SplineSetCImpl<2>::create(a, b, n, noMuscles, c, cCoefficientStride, cMuscleStride);
+      case 3: return SplineSetCImpl<3>::create(a, b, n, noMuscles, c, cCoefficientStride, cMuscleStride);
+      case 4: return SplineSetCImpl<4>::create(a, b, n, noMuscles, c, cCoefficientStride, cMuscleStride);
+      case 5: return SplineSetCImpl<5>::create(a, b, n, noMuscles, c, cCoefficientStride, cMuscleStride);
+      case 6: return SplineSetCImpl<6>::create(a, b, n, noMuscles, c, cCoefficientStride, cMuscleStride);
+    }
+    return NULL;
+  }
+  catch (...) {
+    return NULL;
+  }
+}
+
+
+void splineSetDestroy(SplineSetHandle splineSet) {
+  try {
+    delete splineSet;
+  }
+  catch (...) {
+  }
+}
+
+
+int splineSetGetDimension(SplineSetHandle splineSet) {
+  try {
+    return (splineSet == NULL) ? SPLINE_C_INVALID_ARGUMENT : splineSet->dim_;
+  }
+  catch (...) {
+    return SPLINE_C_INTERNAL_ERROR;
+  }
+}
+
+
+int splineSetGetNumberOfMuscles(SplineSetHandle splineSet) {
+  try {
+    return (splineSet == NULL) ? SPLINE_C_INVALID_ARGUMENT : splineSet->noMuscles_;
+  }
+  catch (...) {
+    return SPLINE_C_INTERNAL_ERROR;
+  }
+}
+
+
+int splineSetGetNumberOfCoefficients(SplineSetHandle splineSet) {
+  try {
+    return (splineSet == NULL) ? SPLINE_C_INVALID_ARGUMENT : splineSet->noCoefficients_;
+  }
+  catch (...) {
+    return SPLINE_C_INTERNAL_ERROR;
+  }
+}
+
+
+int splineSetGetCoefficients(SplineSetHandle splineSet, int muscle, double* c, ptrdiff_t cStride) {
+  try {
+    if (splineSet == NULL || c == NULL || muscle < 0 || muscle >= splineSet->noMuscles_)
+      return SPLINE_C_INVALID_ARGUMENT;
+    splineSet->getCoefficients(muscle, c, cStride);
+    return SPLINE_C_OK;
+  }
+  catch (...) {
+    return SPLINE_C_INTERNAL_ERROR;
+  }
+}
+
+
+int splineSetEvaluate(SplineSetHandle splineSet, ptrdiff_t noFrames,
+                      const double* x, ptrdiff_t xFrameStride, ptrdiff_t xDofStride,
+                      double* values, ptrdiff_t valueFrameStride, ptrdiff_t valueMuscleStride) {
+  try {
+    if (splineSet == NULL || noFrames < 0 || x == NULL || values == NULL)
+      return SPLINE_C_INVALID_ARGUMENT;
+    return splineSet->evaluate(noFrames, x, xFrameStride, xDofStride, values, valueFrameStride, valueMuscleStride);
+  }
+  catch (...) {
+    return SPLINE_C_INTERNAL_ERROR;
+  }
+}
+
+
+int splineSetEvaluateFirstDerivatives(SplineSetHandle splineSet, ptrdiff_t noFrames,
+                                      const double* x, ptrdiff_t xFrameStride, ptrdiff_t xDofStride,
+                                      double* derivatives, ptrdiff_t derivativeFrameStride,
+                                      ptrdiff_t derivativeMuscleStride, ptrdiff_t derivativeDofStride) {
+  try {
+    if (splineSet == NULL || noFrames < 0 || x == NULL || derivatives == NULL)
+      return SPLINE_C_INVALID_ARGUMENT;
+    return splineSet->evaluateFirstDerivatives(noFrames, x, xFrameStride, xDofStride,
+                                               derivatives, derivativeFrameStride, derivativeMuscleStride, derivativeDofStride);
+  }
+  catch (...) {
+    return SPLINE_C_INTERNAL_ERROR;
+  }
+}
+
+}
@@ -0,0 +1,93 @@
+// Copyright (c) 2011, Massimo Sartori and Monica Reggiani
+// All rights reserved.
+
+// Redistribution and use in source and binary forms, with or without 
+// modification, are permitted provided that the following conditions are met:
+// - Redistributions of source code must retain the above copyright notice, 
+//   this list of conditions and the following disclaimer.
+// - Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+
+
+
+#ifndef SplineC_h
+#define SplineC_h
+
+/* C interface to the multidimensional cubic Bspline.
+ *
+ * A SplineSetHandle is the fitted model of a group of muscles spanning the
+ * same DOFs and the same grid; it stays resident until splineSetDestroy.
+ * Every buffer belongs to the caller and is addressed through element
+ * strides, so row-major and column-major matrices (and subsets of them) are
+ * read and written in place:
+ *   x[frame*xFrameStride + dof*xDofStride]
+ *   values[frame*valueFrameStride + muscle*valueMuscleStride]
+ * Nodes are numbered as in Spline<dim>: the first DOF runs fastest.
+ * Supported numbers of DOFs: 2 to SPLINE_C_MAX_DIM.
+ */
+
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define SPLINE_C_MAX_DIM 6
+
+enum {
+  SPLINE_C_OK = 0,
+  SPLINE_C_INVALID_ARGUMENT = -1,
+  SPLINE_C_OUT_OF_BOUNDS = -2,  /* some x outside [a, b] or not a number; later frames are not evaluated */
+  SPLINE_C_INTERNAL_ERROR = -3  /* an exception (e.g. out of memory) caught at the interface */
+};
+
+typedef struct SplineSetC* SplineSetHandle;
+
+/* Fits one spline per muscle on the grid a, b, n (dim elements each, n[i] >= 2 and a[i] < b[i]):
+ * y[node*yNodeStride + muscle*yMuscleStride]. Returns NULL on invalid arguments, among them grids
+ * of more than INT_MAX coefficients (the product of n[i]+3), or on failure. */
+SplineSetHandle splineSetFit(int dim, const double* a, const double* b, const int* n, int noMuscles,
+                             const double* y, ptrdiff_t yNodeStride, ptrdiff_t yMuscleStride);
+
+/* Rebuilds a model from coefficients previously read with splineSetGetCoefficients:
+ * c[coefficient*cCoefficientStride + muscle*cMuscleStride]. */
+SplineSetHandle splineSetCreate(int dim, const double* a, const double* b, const int* n, int noMuscles,
+                                const double* c, ptrdiff_t cCoefficientStride, ptrdiff_t cMuscleStride);
+
+void splineSetDestroy(SplineSetHandle splineSet);
+
+int splineSetGetDimension(SplineSetHandle splineSet);
+int splineSetGetNumberOfMuscles(SplineSetHandle splineSet);
+int splineSetGetNumberOfCoefficients(SplineSetHandle splineSet);
+int splineSetGetCoefficients(SplineSetHandle splineSet, int muscle, double* c, ptrdiff_t cStride);
+
+/* values of all the muscles on noFrames frames */
+int splineSetEvaluate(SplineSetHandle splineSet, ptrdiff_t noFrames,
+                      const double* x, ptrdiff_t xFrameStride, ptrdiff_t xDofStride,
+                      double* values, ptrdiff_t valueFrameStride, ptrdiff_t valueMuscleStride);
+
+/* first derivatives of all the muscles with respect to all the DOFs:
+ * derivatives[frame*derivativeFrameStride + muscle*derivativeMuscleStride + dof*derivativeDofStride] */
+int splineSetEvaluateFirstDerivatives(SplineSetHandle splineSet, ptrdiff_t noFrames,
+                                      const double* x, ptrdiff_t xFrameStride, ptrdiff_t xDofStride,
+                                      double* derivatives, ptrdiff_t derivativeFrameStride,
+                                      ptrdiff_t derivativeMuscleStride, ptrdiff_t derivativeDofStride);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,207 @@
+// Copyright (c) 2011, Massimo Sartori and Monica Reggiani
+// All rights reserved.
+
+// Redistribution and use in source and binary forms, with or without 
+// modification, are permitted provided that the following conditions are met:
+// - Redistributions of source code must retain the above copyright notice, 
+//   this list of conditions and the following disclaimer.
+// - Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+
+
+
+#include <math.h>
+#include <stdlib.h>
+#include <iostream>
+#include <limits>
+#include <algorithm>
+
+//#define LOG_SPLINE
+
+template< int dim, int order >
+SplineCompressed<dim, order>::SplineCompressed(const Spline<dim, order>& spline, const SplineQuantization quantization)
+:quantization_(quantization), maxCoefficientError_(0.) {
+  Spline<dim, order> tiledSpline(spline);
+  tiledSpline.setLayout(TILED_LAYOUT);
+  for (int i = 0; i < dim; ++i) {
+    a_[i] = tiledSpline.a_[i];
+    b_[i] = tiledSpline.b_[i];
+    n_[i] = tiledSpline.n_[i];
+    h_[i] = tiledSpline.h_[i];
+    firstOffset_[i] = tiledSpline.firstOffset_[i];
+  }
+  offset_ = tiledSpline.offset_;
+  
+  // in the tiled layout the part of an offset below sizeOfTile is the
+  // position inside the tile, the rest is the tile
+  int sizeOfTile = 1;
+  for (int i = 0; i < dim; ++i)
+    sizeOfTile *= order;
+  tileOffset_.resize(offset_.size());
+  for (unsigned int k = 0; k < offset_.size(); ++k)
+    tileOffset_[k] = offset_[k] / sizeOfTile;
+  
+  // the padding of the tiles is never evaluated, so it does not count in
+  // the range of a tile
+  const std::vector<double>& c = tiledSpline.c_;
+  std::vector<int> tileOfC(c.size(), -1);
+  int sizeOfC = 1;
+  for (int i = 0; i < dim; ++i)
+    sizeOfC *= SplineOrder<order>::getNumberOfCoefficients(n_[i]);
+  std::vector<int> j(dim, 0);
+  for (int k = 0; k < sizeOfC; ++k) {
+    int cIndex = 0, tile = 0;
+    for (int i = 0; i < dim; ++i) {
+      cIndex += offset_[firstOffset_[i] + j[i]];
+      tile += tileOffset_[firstOffset_[i] + j[i]];
+    }
+    tileOfC[cIndex] = tile;
+    for (int i = 0; (i < dim) && (++j[i] == SplineOrder<order>::getNumberOfCoefficients(n_[i])); ++i)
+      j[i] = 0;
+  }
+  
+  if (quantization_ == QUANTIZATION_16_BITS)
+    quantize(c, tileOfC, q16_);
+  else
+    quantize(c, tileOfC, q8_);
+  
+#ifdef LOG_SPLINE
+  std::cout << "Compressed Spline<" << dim << ">: " << getMemory() << " bytes instead of "
+            << c.size() * sizeof(double) << ", error of the coefficients " << maxCoefficientError_ << std::endl;
+#endif
+}
+
+
+// Each tile maps [min, max] on the whole range of Quantized. The error is
+// measured on the decoded values, so it includes their rounding.
+template< int dim, int order >
+template< typename Quantized >
+void SplineCompressed<dim, order>::quantize(const std::vector<double>& c, const std::vector<int>& tileOfC, std::vector<Quantized>& q) {
+  const double levels = std::numeric_limits<Quantized>::max();
+  const int noTiles = *std::max_element(tileOfC.begin(), tileOfC.end()) + 1;
+  std::vector<double> minOfTile(noTiles, std::numeric_limits<double>::max());
+  std::vector<double> maxOfTile(noTiles, -std::numeric_limits<double>::max());
+  for (unsigned int k = 0; k < c.size(); ++k)
+    if (tileOfC[k] >= 0) {
+      minOfTile[tileOfC[k]] = std::min(minOfTile[tileOfC[k]], c[k]);
+      maxOfTile[tileOfC[k]] = std::max(maxOfTile[tileOfC[k]], c[k]);
+    }
+  
+  tileScale_.resize(2*noTiles);
+  for (int t = 0; t < noTiles; ++t) {
+    if (minOfTile[t] > maxOfTile[t])
+      minOfTile[t] = maxOfTile[t] = 0.;
+    tileScale_[2*t] = minOfTile[t];
+    tileScale_[2*t+1] = (maxOfTile[t] - minOfTile[t]) / levels;
+  }
+  
+  q.assign(c.size(), 0);
+  maxCoefficientError_ = 0.;
+  for (unsigned int k = 0; k < c.size(); ++k) {
+    if (tileOfC[k] < 0)
+      continue;
+    const double* scale = &tileScale_[2*tileOfC[k]];
+    if (scale[1] > 0.)
+      q[k] = static_cast<Quantized>(std::min(levels, floor((c[k] - scale[0]) / scale[1] + 0.5)));
+    maxCoefficientError_ = std::max(maxCoefficientError_, fabs(scale[0] + scale[1] * q[k] - c[k]));
+  }
+}
+
+
+template< int dim, int order >
+bool SplineCompressed<dim, order>::checkValues(const std::vector<double>& x) const {
+  for (int i = 0; i < dim; ++i )
+    if ( (x[i] < a_[i]) || (x[i] > b_[i]) )
+      return false;
+  return true;
+}
+
+
+template< int dim, int order >
+double SplineCompressed<dim, order>::sum(const int* const* offsets, const int* const* tiles, const double (*basis)[order]) const {
+  if (quantization_ == QUANTIZATION_16_BITS)
+    return SplineQuantizedStencil<dim-1, order, unsigned short>::sum(&q16_[0], &tileScale_[0], offsets, tiles, basis, 0, 0);
+  return SplineQuantizedStencil<dim-1, order, unsigned char>::sum(&q8_[0], &tileScale_[0], offsets, tiles, basis, 0, 0);
+}
+
+
+template< int dim, int order >
+double SplineCompressed<dim, order>::getValue(const std::vector<double>& x) const {
+  if (!checkValues(x)) {
+    std::cout << "Values x are out of boundaries\n";
+    exit(EXIT_FAILURE);
+  }
+  
+  double basis[dim][order];
+  const int* offsets[dim];
+  const int* tiles[dim];
+  for (int i = 0; i < dim; ++i) {
+    int l = SplineOrder<order>::computeInterval(x[i], a_[i], h_[i], n_[i]);
+    for (int j = 0; j < order; ++j)
+      basis[i][j] = SplineOrder<order>::getValue(x[i], l+j, a_[i], h_[i]);
+    offsets[i] = &offset_[firstOffset_[i] + l];
+    tiles[i] = &tileOffset_[firstOffset_[i] + l];
+  }
+  return sum(offsets, tiles, basis);
+}
+
+
+template< int dim, int order >
+double SplineCompressed<dim, order>::getFirstDerivative(const std::vector<double>& x, const int dimDerivative) const {
+  if (!checkValues(x)) {
+    std::cout << "Values x are out of boundaries\n";
+    exit(EXIT_FAILURE);
+  }
+  
+  double basis[dim][order];
+  const int* offsets[dim];
+  const int* tiles[dim];
+  for (int i = 0; i < dim; ++i) {
+    int l = SplineOrder<order>::computeInterval(x[i], a_[i], h_[i], n_[i]);
+    for (int j = 0; j < order; ++j)
+      basis[i][j] = (i == dimDerivative) ? SplineOrder<order>::getFirstDerivative(x[i], l+j, a_[i], h_[i])
+                                         : SplineOrder<order>::getValue(x[i], l+j, a_[i], h_[i]);
+    offsets[i] = &offset_[firstOffset_[i] + l];
+    tiles[i] = &tileOffset_[firstOffset_[i] + l];
+  }
+  return sum(offsets, tiles, basis);
+}
+
+
+template< int dim, int order >
+double SplineCompressed<dim, order>::getMaxValueError() const {
+  double bound = maxCoefficientError_;
+  for (int i = 0; i < dim; ++i)
+    for (int m = 2; m < order; ++m)
+      bound *= m;
+  return bound;
+}
+
+
+// the derivative of a basis function of order k is the difference of two
+// of order k-1 over h, so the sum on an axis of c_j times the derivatives
+// is the sum of (c_j - c_j-1) times basis functions of order k-1
+template< int dim, int order >
+double SplineCompressed<dim, order>::getMaxFirstDerivativeError(const int dimDerivative) const {
+  return 2. * getMaxValueError() / h_[dimDerivative];
+}
+
+
+template< int dim, int order >
+size_t SplineCompressed<dim, order>::getMemory() const {
+  return q16_.size() * sizeof(unsigned short) + q8_.size() * sizeof(unsigned char)
+       + tileScale_.size() * sizeof(double) + (offset_.size() + tileOffset_.size()) * sizeof(int);
+}
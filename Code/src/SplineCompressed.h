@@ -0,0 +1,115 @@
+// Copyright (c) 2011, Massimo Sartori and Monica Reggiani
+// All rights reserved.
+
+// Redistribution and use in source and binary forms, with or without 
+// modification, are permitted provided that the following conditions are met:
+// - Redistributions of source code must retain the above copyright notice, 
+//   this list of conditions and the following disclaimer.
+// - Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+
+
+
+#ifndef SplineCompressed_h
+#define SplineCompressed_h
+
+
+#include <vector>
+#include <stddef.h>
+
+#include "Spline.h"
+
+// How many bits SplineCompressed keeps for each coefficient
+enum SplineQuantization {
+  QUANTIZATION_16_BITS,
+  QUANTIZATION_8_BITS
+};
+
+// Sum of SplineStencil with the coefficients decoded on the fly: the
+// coefficient at index, in the tile t, is tileScale[2t] + tileScale[2t+1] * q[index].
+// The tile of a coefficient is separable as its index, so tiles[i] gives the
+// tiles of the order coefficients of axis i touched by the point.
+template <int axis, int order, typename Quantized>
+struct SplineQuantizedStencil {
+  static double sum(const Quantized* q, const double* tileScale, const int* const* offsets, const int* const* tiles,
+                    const double (*basis)[order], const int firstIndex, const int firstTile) {
+    double evaluatedValue = 0;
+    for (int j = 0; j < order; ++j)
+      evaluatedValue += basis[axis][j] * SplineQuantizedStencil<axis-1, order, Quantized>::sum(q, tileScale, offsets, tiles, basis,
+                                                                                              firstIndex + offsets[axis][j],
+                                                                                              firstTile + tiles[axis][j]);
+    return evaluatedValue;
+  }
+};
+
+template <int order, typename Quantized>
+struct SplineQuantizedStencil<0, order, Quantized> {
+  static double sum(const Quantized* q, const double* tileScale, const int* const* offsets, const int* const* tiles,
+                    const double (*basis)[order], const int firstIndex, const int firstTile) {
+    double evaluatedValue = 0;
+    for (int j = 0; j < order; ++j) {
+      const double* scale = tileScale + 2*(firstTile + tiles[0][j]);
+      evaluatedValue += basis[0][j] * (scale[0] + scale[1] * q[firstIndex + offsets[0][j]]);
+    }
+    return evaluatedValue;
+  }
+};
+
+
+// Read-only copy of a Spline<dim> with its coefficients quantized, to keep
+// more of a model in cache. They are stored with the TILED_LAYOUT of Spline,
+// and each tile of order^dim coefficients has its own minimum and step, so
+// 16 (8) bits per coefficient instead of 64. The difference with the
+// original spline is bounded: a coefficient moves at most by
+// getMaxCoefficientError, and the basis functions of an axis sum to
+// (order-1)!, their derivatives to at most 2*(order-1)!/h in absolute value.
+template <int dim, int order = 4>
+class SplineCompressed {
+  private:
+    double a_[dim];
+    double b_[dim];
+    int n_[dim];
+    double h_[dim];
+    
+    SplineQuantization quantization_;
+    int firstOffset_[dim];
+    std::vector<int> offset_;
+    std::vector<int> tileOffset_;
+    std::vector<double> tileScale_;
+    std::vector<unsigned short> q16_;
+    std::vector<unsigned char> q8_;
+    double maxCoefficientError_;
+    
+    bool checkValues(const std::vector<double>& x) const;
+    template <typename Quantized>
+    void quantize(const std::vector<double>& c, const std::vector<int>& tileOfC, std::vector<Quantized>& q);
+    double sum(const int* const* offsets, const int* const* tiles, const double (*basis)[order]) const;
+    
+  public:
+    SplineCompressed(const Spline<dim, order>& spline, const SplineQuantization quantization = QUANTIZATION_16_BITS);
+    double getValue(const std::vector<double>& x) const;
+    double getFirstDerivative(const std::vector<double>& x, const int dimDerivative) const;
+    // guaranteed bounds of the difference with the original spline, in any x
+    double getMaxCoefficientError() const { return maxCoefficientError_; }
+    double getMaxValueError() const;
+    double getMaxFirstDerivativeError(const int dimDerivative) const;
+    // bytes of the coefficients and of the tables used to decode them
+    size_t getMemory() const;
+};
+
+
+
+#endif
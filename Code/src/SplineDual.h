@@ -0,0 +1,130 @@
+// Copyright (c) 2011, Massimo Sartori and Monica Reggiani
+// All rights reserved.
+
+// Redistribution and use in source and binary forms, with or without 
+// modification, are permitted provided that the following conditions are met:
+// - Redistributions of source code must retain the above copyright notice, 
+//   this list of conditions and the following disclaimer.
+// - Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+
+
+
+#ifndef SplineDual_h
+#define SplineDual_h
+
+// What the evaluation of a Spline needs from a scalar type other than
+// double: the arithmetic with doubles, and the plain value, which chooses
+// the interval and the piece of the basis.
+template <typename Scalar>
+struct SplineScalar {
+  static double getValue(const Scalar& x) { return x; }
+};
+
+
+// Forward-mode dual number: a value and its derivatives with respect to
+// noVariables independent variables. Spline<dim>::getValue of SplineDual
+// uses the analytic derivatives of the basis, so the whole gradient costs
+// dim+1 stencil sums; any other function of the angles (a chain of joint
+// couplings, say) propagates through the operators below.
+template <int noVariables>
+class SplineDual {
+  private:
+    double value_;
+    double derivative_[noVariables];
+    
+  public:
+    // a constant or, with variable in [0, noVariables), that variable
+    SplineDual(const double value = 0., const int variable = -1)
+    :value_(value) {
+      for (int k = 0; k < noVariables; ++k)
+        derivative_[k] = (k == variable) ? 1. : 0.;
+    }
+    double getValue() const { return value_; }
+    double getDerivative(const int variable) const { return derivative_[variable]; }
+    void setDerivative(const int variable, const double derivative) { derivative_[variable] = derivative; }
+    
+    SplineDual& operator+=(const SplineDual& other) {
+      value_ += other.value_;
+      for (int k = 0; k < noVariables; ++k)
+        derivative_[k] += other.derivative_[k];
+      return *this;
+    }
+    SplineDual& operator-=(const SplineDual& other) {
+      value_ -= other.value_;
+      for (int k = 0; k < noVariables; ++k)
+        derivative_[k] -= other.derivative_[k];
+      return *this;
+    }
+    SplineDual& operator*=(const SplineDual& other) {
+      for (int k = 0; k < noVariables; ++k)
+        derivative_[k] = derivative_[k] * other.value_ + value_ * other.derivative_[k];
+      value_ *= other.value_;
+      return *this;
+    }
+    SplineDual& operator/=(const SplineDual& other) {
+      const double inverse = 1. / other.value_;
+      value_ *= inverse;
+      for (int k = 0; k < noVariables; ++k)
+        derivative_[k] = (derivative_[k] - value_ * other.derivative_[k]) * inverse;
+      return *this;
+    }
+    SplineDual& operator+=(const double other) { value_ += other; return *this; }
+    SplineDual& operator-=(const double other) { value_ -= other; return *this; }
+    SplineDual& operator*=(const double other) {
+      value_ *= other;
+      for (int k = 0; k < noVariables; ++k)
+        derivative_[k] *= other;
+      return *this;
+    }
+    SplineDual& operator/=(const double other) { return *this *= 1. / other; }
+    SplineDual operator-() const { return SplineDual(*this) *= -1.; }
+};
+
+template <int noVariables>
+struct SplineScalar< SplineDual<noVariables> > {
+  static double getValue(const SplineDual<noVariables>& x) { return x.getValue(); }
+};
+
+
+template <int noVariables>
+inline SplineDual<noVariables> operator+(SplineDual<noVariables> x, const SplineDual<noVariables>& y) { return x += y; }
+template <int noVariables>
+inline SplineDual<noVariables> operator-(SplineDual<noVariables> x, const SplineDual<noVariables>& y) { return x -= y; }
+template <int noVariables>
+inline SplineDual<noVariables> operator*(SplineDual<noVariables> x, const SplineDual<noVariables>& y) { return x *= y; }
+template <int noVariables>
+inline SplineDual<noVariables> operator/(SplineDual<noVariables> x, const SplineDual<noVariables>& y) { return x /= y; }
+
+template <int noVariables>
+inline SplineDual<noVariables> operator+(SplineDual<noVariables> x, const double y) { return x += y; }
+template <int noVariables>
+inline SplineDual<noVariables> operator-(SplineDual<noVariables> x, const double y) { return x -= y; }
+template <int noVariables>
+inline SplineDual<noVariables> operator*(SplineDual<noVariables> x, const double y) { return x *= y; }
+template <int noVariables>
+inline SplineDual<noVariables> operator/(SplineDual<noVariables> x, const double y) { return x /= y; }
+
+template <int noVariables>
+inline SplineDual<noVariables> operator+(const double x, SplineDual<noVariables> y) { return y += x; }
+template <int noVariables>
+inline SplineDual<noVariables> operator-(const double x, const SplineDual<noVariables>& y) { return -y += x; }
+template <int noVariables>
+inline SplineDual<noVariables> operator*(const double x, SplineDual<noVariables> y) { return y *= x; }
+template <int noVariables>
+inline SplineDual<noVariables> operator/(const double x, const SplineDual<noVariables>& y) { return SplineDual<noVariables>(x) /= y; }
+
+#endif
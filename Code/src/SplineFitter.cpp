@@ -0,0 +1,145 @@
+// Copyright (c) 2011, Massimo Sartori and Monica Reggiani
+// All rights reserved.
+
+// Redistribution and use in source and binary forms, with or without 
+// modification, are permitted provided that the following conditions are met:
+// - Redistributions of source code must retain the above copyright notice, 
+//   this list of conditions and the following disclaimer.
+// - Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+
+
+
+#include <stdlib.h>
+#include <iostream>
+
+//#define LOG_SPLINE
+
+template< int dim, int order >
+SplineFitter<dim, order>::SplineFitter(const std::vector<double>& a, const std::vector<double>& b, const std::vector<int>& n)
+:a_(a), b_(b), n_(n), fitterFirstPhase_(a, b, n), splineSecondPhase_(a[dim-1], b[dim-1], n[dim-1]) {
+
+  sizeOfY_ = 1;
+  for (int i = dim-1; i >=0; --i)
+    sizeOfY_ *= (n_[i] + 1); 
+
+  int sizeOfC = 1;
+  for (int i = 0; i < dim; ++i)
+    sizeOfC *= SplineOrder<order>::getNumberOfCoefficients(n_[i]);
+  c_.resize(sizeOfC);
+  interpolatedDataFromPreCoeffs_.resize(n_[dim-1]+1);
+}
+
+
+template< int dim, int order >
+void SplineFitter<dim, order>::computeCoefficients(const std::vector<double>& /* y */, std::vector<double>::const_iterator fromWhereInY) {
+  computeCoefficients(&fromWhereInY[0], 1);
+}
+
+
+template< int dim, int order >
+void SplineFitter<dim, order>::computeCoefficients(const double* y, const std::ptrdiff_t stride) {
+
+  // step 1: compute preCoefficients
+  preCoeffs_.clear();
+  preCoeffs_.reserve(getNumberOfPreCoefficients());
+  
+ #ifdef LOG_SPLINE 
+  std::cout << " Step 1: Dim: " << dim << " the number of precoefficients is: " << getNumberOfPreCoefficients() << std::endl;
+ #endif
+    
+  for (int i = 0; i <= n_[dim-1]; ++i)
+     computeSlabCoefficients(y + i * getSizeOfSlab() * stride, stride, preCoeffs_);
+  
+  // step 2: Now solve the spline interpolation problem
+  computeLastAxisCoefficients(preCoeffs_);
+}
+
+
+template< int dim, int order >
+int SplineFitter<dim, order>::getNumberOfPreCoefficients() const {
+  int numberOfPreCoeffs = ( n_[dim-1] + 1 ); 
+  for (int i = dim-2; i >= 0; i--) 
+    numberOfPreCoeffs *= SplineOrder<order>::getNumberOfCoefficients(n_[i]);
+  return numberOfPreCoeffs;
+}
+
+
+template< int dim, int order >
+void SplineFitter<dim, order>::computeSlabCoefficients(const double* y, const std::ptrdiff_t stride, std::vector<double>& preCoeffs) {
+  fitterFirstPhase_.computeCoefficients(y, stride);
+  const std::vector<double>& firstPhaseC = fitterFirstPhase_.getCoefficients();
+  preCoeffs.insert(preCoeffs.end(), firstPhaseC.begin(), firstPhaseC.end()); 
+}
+
+
+template< int dim, int order >
+void SplineFitter<dim, order>::computeLastAxisCoefficients(const std::vector<double>& preCoeffs) {
+  if (static_cast<int>(preCoeffs.size()) != getNumberOfPreCoefficients()) {
+    std::cout << "The preCoefficients of " << preCoeffs.size() / (getNumberOfPreCoefficients() / (n_[dim-1]+1))
+              << " slabs were computed, " << n_[dim-1]+1 << " are needed\n";
+    exit(EXIT_FAILURE);
+  }
+  
+#ifdef LOG_SPLINE
+     std::cout << "Beginning of step 2" << std::endl;
+#endif     
+  int noInterpolatedDataFromPreCoeffs = getNumberOfPreCoefficients()/(n_[dim-1]+1);
+  
+  for (int i = 0; i < noInterpolatedDataFromPreCoeffs; ++i) {
+    for (int j = 0; j < (n_[dim-1]+1); ++j) {
+       interpolatedDataFromPreCoeffs_[j] = preCoeffs[j * noInterpolatedDataFromPreCoeffs+i];
+    }
+    splineSecondPhase_.computeCoefficients(interpolatedDataFromPreCoeffs_, interpolatedDataFromPreCoeffs_.begin());
+    for(int j=0; j< SplineOrder<order>::getNumberOfCoefficients(n_[dim-1]);j++) {
+      c_[j*(noInterpolatedDataFromPreCoeffs)+i] = splineSecondPhase_.c_[j];
+    }
+  }
+
+#ifdef LOG_SPLINE
+  std::cout << "SplineFitter<" << dim << ">'s " << c_.size() <<" coeffs\n";
+    for (unsigned int i = 0; i < c_.size(); ++i)
+     std::cout << c_[i] << std::endl;
+  std::cout << std::endl;
+#endif  
+}
+
+
+/*************************************** SplineFitter<1> ****************************************/
+
+
+template< int order >
+SplineFitter<1, order>::SplineFitter(const std::vector<double>& a, const std::vector<double>& b, const std::vector<int>& n)
+:spline_(a, b, n) {
+}
+
+
+template< int order >
+void SplineFitter<1, order>::computeCoefficients(const std::vector<double>& y, std::vector<double>::const_iterator fromWhereInY) {
+  spline_.computeCoefficients(y, fromWhereInY);
+}
+
+
+template< int order >
+void SplineFitter<1, order>::computeCoefficients(const double* y, const std::ptrdiff_t stride) {
+  spline_.computeCoefficients(y, stride);
+}
+
+
+template< int order >
+const std::vector<double>& SplineFitter<1, order>::getCoefficients() const {
+  return spline_.c_;
+}
@@ -0,0 +1,91 @@
+// Copyright (c) 2011, Massimo Sartori and Monica Reggiani
+// All rights reserved.
+
+// Redistribution and use in source and binary forms, with or without 
+// modification, are permitted provided that the following conditions are met:
+// - Redistributions of source code must retain the above copyright notice, 
+//   this list of conditions and the following disclaimer.
+// - Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+
+
+
+#ifndef SplineFitter_h
+#define SplineFitter_h
+
+
+#include <vector>
+#include <cstddef>
+
+#include "Spline.h"
+
+// Transient object computing the coefficients of a Spline<dim> from the
+// values on the nodes: one axis after the other, a Spline<1> is fitted on
+// each line of data. It holds the buffers of the whole chain of lower
+// dimensional fits, so it is meant to be reused for all the splines on the
+// same grid and then dropped, while the Spline<dim> keeps only the result.
+template <int dim, int order>
+class SplineFitter {
+  private:
+    std::vector<double> a_;
+    std::vector<double> b_;
+    std::vector<int> n_;
+    int sizeOfY_;
+    SplineFitter<dim-1, order> fitterFirstPhase_;
+    Spline<1, order> splineSecondPhase_;
+    std::vector<double> preCoeffs_;
+    std::vector<double> interpolatedDataFromPreCoeffs_;
+    std::vector<double> c_;
+
+  public:
+    SplineFitter(const std::vector<double>& a, const std::vector<double>& b, const std::vector<int>& n);
+    // reads the values from fromWhereInY on; y is unused, kept so that the
+    // calls written for Spline<dim>::computeCoefficients(y, y.begin()) build
+    void computeCoefficients(const std::vector<double>& y, std::vector<double>::const_iterator fromWhereInY);
+    // the value of node k is y[k * stride], see Spline<dim>
+    void computeCoefficients(const double* y, const std::ptrdiff_t stride);
+    // The two steps of computeCoefficients, for the callers which get y one
+    // slab at a time (see SplineStreamingFitter). A slab holds the values
+    // of the nodes with the same index on the last axis; the first step
+    // appends the coefficients of the other axes of each slab to preCoeffs,
+    // the second one fits the last axis once all the slabs are there.
+    int getSizeOfSlab() const { return sizeOfY_ / (n_[dim-1]+1); }
+    int getNumberOfPreCoefficients() const;
+    void computeSlabCoefficients(const double* y, const std::ptrdiff_t stride, std::vector<double>& preCoeffs);
+    void computeLastAxisCoefficients(const std::vector<double>& preCoeffs);
+    // coefficients in row-major order
+    const std::vector<double>& getCoefficients() const { return c_; }
+
+    friend class SplineFitter<dim+1, order>;
+    friend class Spline<dim, order>;
+};
+
+
+template <int order>
+class SplineFitter<1, order> {
+  private:
+    Spline<1, order> spline_;
+    
+  public:
+    SplineFitter(const std::vector<double>& a, const std::vector<double>& b, const std::vector<int>& n);
+    void computeCoefficients(const std::vector<double>& y, std::vector<double>::const_iterator fromWhereInY);
+    void computeCoefficients(const double* y, const std::ptrdiff_t stride);
+    const std::vector<double>& getCoefficients() const;
+};
+
+
+
+#endif
@@ -0,0 +1,228 @@
+// Copyright (c) 2011, Massimo Sartori and Monica Reggiani
+// All rights reserved.
+
+// Redistribution and use in source and binary forms, with or without 
+// modification, are permitted provided that the following conditions are met:
+// - Redistributions of source code must retain the above copyright notice, 
+//   this list of conditions and the following disclaimer.
+// - Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+
+
+
+#include <math.h>
+#include <stdlib.h>
+#include <time.h>
+#include <iostream>
+#include <algorithm>
+#include <random>
+
+//#define LOG_SPLINE
+
+template< int dim >
+SplineTableSampler<dim>::SplineTableSampler(const std::vector<double>& a, const std::vector<double>& b, const std::vector<int>& n,
+                                            const std::vector< std::vector<double> >& y)
+:a_(a), b_(b), h_(dim), n_(n), y_(y) {
+  for (int i = 0; i < dim; ++i)
+    h_[i] = (b_[i] - a_[i]) / n_[i];
+  SplineFitter<dim> fitter(a_, b_, n_);
+  splines_.reserve(y_.size());
+  for (unsigned int m = 0; m < y_.size(); ++m) {
+    fitter.computeCoefficients(y_[m], y_[m].begin());
+    splines_.push_back(Spline<dim>(fitter));
+  }
+}
+
+
+template< int dim >
+void SplineTableSampler<dim>::getValues(const std::vector<double>& x, std::vector<double>& values) {
+  values.resize(y_.size());
+  int node = 0, stride = 1;
+  bool onNode = true;
+  for (int i = 0; (i < dim) && onNode; ++i) {
+    double u = (x[i] - a_[i]) / h_[i];
+    int k = static_cast<int>(floor(u + 0.5));
+    onNode = (fabs(u - k) < 1e-9) && (k >= 0) && (k <= n_[i]);
+    node += k * stride;
+    stride *= n_[i] + 1;
+  }
+  for (unsigned int m = 0; m < y_.size(); ++m)
+    values[m] = onNode ? y_[m][node] : splines_[m].getValue(x);
+}
+
+
+template< int dim >
+SplineGridSelector<dim>::SplineGridSelector(const std::vector<double>& a, const std::vector<double>& b, SplineSampler& sampler)
+:a_(a), b_(b), sampler_(sampler), tolerance_(1e-4), minIntervals_(2), maxIntervals_(dim, 64), maxHeldOutPoints_(10000),
+ n_(dim, 0), error_(0), noFits_(0), fitTime_(0), evaluationTime_(0) {
+}
+
+
+template< int dim >
+bool SplineGridSelector<dim>::selectGrid() {
+  bool validLimits = (minIntervals_ >= 2) && (static_cast<int>(maxIntervals_.size()) == dim);
+  for (int i = 0; validLimits && i < dim; ++i)
+    validLimits = (maxIntervals_[i] >= minIntervals_);
+  if (!validLimits) {
+    std::cout << "The number of intervals must be between 2 and maxIntervals\n";
+    exit(EXIT_FAILURE);
+  }
+  noFits_ = 0;
+  n_.assign(dim, minIntervals_);
+  std::vector<double> errorOfAxis(dim);
+  error_ = computeError(n_, errorOfAxis);
+  
+  // refine the worst axis, by half of its intervals; give up when it
+  // is already at its maxIntervals
+  while (error_ > tolerance_) {
+    int worst = 0;
+    for (int i = 1; i < dim; ++i)
+      if (errorOfAxis[i] > errorOfAxis[worst])
+        worst = i;
+    if (n_[worst] == maxIntervals_[worst]) {
+      measureCosts();
+      return false;
+    }
+    n_[worst] = std::min(maxIntervals_[worst], std::max(n_[worst] + 1, (3 * n_[worst]) / 2));
+    error_ = computeError(n_, errorOfAxis);
+#ifdef LOG_SPLINE
+    std::cout << "Refined axis " << worst << " to " << n_[worst] << " intervals, error " << error_ << std::endl;
+#endif
+  }
+  
+  // the last steps may have overshot: bisect each axis down
+  for (int i = 0; i < dim; ++i) {
+    int low = minIntervals_ - 1, high = n_[i];
+    while (high - low > 1) {
+      std::vector<int> trial(n_);
+      trial[i] = (low + high) / 2;
+      double error = computeError(trial, errorOfAxis);
+      if (error <= tolerance_) {
+        high = trial[i];
+        error_ = error;
+      }
+      else
+        low = trial[i];
+    }
+    n_[i] = high;
+  }
+  
+  measureCosts();
+  return true;
+}
+
+
+template< int dim >
+void SplineGridSelector<dim>::fit(const std::vector<int>& n, std::vector< Spline<dim> >& splines) {
+  int noNodes = 1;
+  for (int i = 0; i < dim; ++i)
+    noNodes *= n[i] + 1;
+  std::vector< std::vector<double> > y(sampler_.getNumberOfValues(), std::vector<double>(noNodes));
+  std::vector<double> x(dim), values;
+  for (int node = 0; node < noNodes; ++node) {
+    int rest = node;
+    for (int i = 0; i < dim; ++i) {
+      x[i] = std::min(b_[i], a_[i] + (rest % (n[i]+1)) * (b_[i] - a_[i]) / n[i]);
+      rest /= n[i] + 1;
+    }
+    sampler_.getValues(x, values);
+    for (unsigned int m = 0; m < y.size(); ++m)
+      y[m][node] = values[m];
+  }
+  
+  clock_t start = clock();
+  SplineFitter<dim> fitter(a_, b_, n);
+  splines.clear();
+  splines.reserve(y.size());
+  for (unsigned int m = 0; m < y.size(); ++m) {
+    fitter.computeCoefficients(y[m], y[m].begin());
+    splines.push_back(Spline<dim>(fitter));
+  }
+  fitTime_ = static_cast<double>(clock() - start) / CLOCKS_PER_SEC;
+  ++noFits_;
+}
+
+
+// axis < dim: midpoints of the intervals of axis; axis == dim: centres of the cells
+template< int dim >
+double SplineGridSelector<dim>::computeHeldOutError(const std::vector< Spline<dim> >& splines, const std::vector<int>& n, const int axis) {
+  std::vector<int> noPoints(dim);
+  long noHeldOut = 1;
+  for (int i = 0; i < dim; ++i) {
+    noPoints[i] = ( (i == axis) || (axis == dim) ) ? n[i] : n[i] + 1;
+    noHeldOut *= noPoints[i];
+  }
+  
+  std::mt19937 generator(axis + 1);
+  std::uniform_int_distribution<long> randomPoint(0, noHeldOut - 1);
+  const long noTested = std::min(noHeldOut, static_cast<long>(maxHeldOutPoints_));
+  std::vector<double> x(dim), values;
+  double maxError = 0;
+  for (long p = 0; p < noTested; ++p) {
+    long rest = (noTested == noHeldOut) ? p : randomPoint(generator);
+    for (int i = 0; i < dim; ++i) {
+      double shift = (noPoints[i] == n[i]) ? 0.5 : 0.;
+      x[i] = std::min(b_[i], a_[i] + (rest % noPoints[i] + shift) * (b_[i] - a_[i]) / n[i]);
+      rest /= noPoints[i];
+    }
+    sampler_.getValues(x, values);
+    for (unsigned int m = 0; m < splines.size(); ++m)
+      maxError = std::max(maxError, fabs(splines[m].getValue(x) - values[m]));
+  }
+  return maxError;
+}
+
+
+template< int dim >
+double SplineGridSelector<dim>::computeError(const std::vector<int>& n, std::vector<double>& errorOfAxis) {
+  std::vector< Spline<dim> > splines;
+  fit(n, splines);
+  double maxError = computeHeldOutError(splines, n, dim);
+  for (int i = 0; i < dim; ++i) {
+    errorOfAxis[i] = computeHeldOutError(splines, n, i);
+    maxError = std::max(maxError, errorOfAxis[i]);
+  }
+  return maxError;
+}
+
+
+template< int dim >
+void SplineGridSelector<dim>::measureCosts() {
+  fit(n_, splines_);
+  
+  const int noPoses = 10000;
+  std::mt19937 generator(1);
+  std::vector< std::vector<double> > poses(noPoses, std::vector<double>(dim));
+  for (int p = 0; p < noPoses; ++p)
+    for (int i = 0; i < dim; ++i)
+      poses[p][i] = std::uniform_real_distribution<double>(a_[i], b_[i])(generator);
+  
+  volatile double sum = 0;
+  clock_t start = clock();
+  for (int p = 0; p < noPoses; ++p)
+    for (unsigned int m = 0; m < splines_.size(); ++m)
+      sum += splines_[m].getValue(poses[p]);
+  evaluationTime_ = static_cast<double>(clock() - start) / CLOCKS_PER_SEC / (noPoses * splines_.size());
+}
+
+
+template< int dim >
+long SplineGridSelector<dim>::getMemory() const {
+  long noCoefficients = 1;
+  for (int i = 0; i < dim; ++i)
+    noCoefficients *= n_[i] + 3;
+  return noCoefficients * sampler_.getNumberOfValues() * sizeof(double);
+}
@@ -0,0 +1,119 @@
+// Copyright (c) 2011, Massimo Sartori and Monica Reggiani
+// All rights reserved.
+
+// Redistribution and use in source and binary forms, with or without 
+// modification, are permitted provided that the following conditions are met:
+// - Redistributions of source code must retain the above copyright notice, 
+//   this list of conditions and the following disclaimer.
+// - Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+
+
+
+#ifndef SplineGridSelector_h
+#define SplineGridSelector_h
+
+
+#include <vector>
+
+#include "Spline.h"
+
+// Source of the values to interpolate, e.g. the muscle-tendon lengths of all
+// the muscles computed by a geometry solver in the pose x.
+class SplineSampler {
+  public:
+    virtual ~SplineSampler() { }
+    virtual int getNumberOfValues() const = 0;
+    virtual void getValues(const std::vector<double>& x, std::vector<double>& values) = 0;
+};
+
+
+// A dense reference table, as the y of lmt.in: exact on its own nodes and
+// interpolated by its cubic spline in between. Between its nodes it only
+// gives back its own interpolant, so it cannot justify a grid finer than
+// its own: limit the selector to its intervals and validate the selected
+// grid on independent values (e.g. BetweenNodesData).
+template <int dim>
+class SplineTableSampler : public SplineSampler {
+  private:
+    std::vector<double> a_, b_, h_;
+    std::vector<int> n_;
+    std::vector< std::vector<double> > y_;
+    std::vector< Spline<dim> > splines_;
+    
+  public:
+    SplineTableSampler(const std::vector<double>& a, const std::vector<double>& b, const std::vector<int>& n,
+                       const std::vector< std::vector<double> >& y);
+    int getNumberOfValues() const { return y_.size(); }
+    void getValues(const std::vector<double>& x, std::vector<double>& values);
+};
+
+
+// Searches the number of intervals of each DOF: the smallest grid whose
+// spline stays within the tolerance on held-out points, never used to fit.
+// These are the midpoints of the intervals of one axis (on the nodes of the
+// others), which tell which axis is too coarse, and the centres of the
+// cells, as in BetweenNodesData. Starting from the minimum, the axis with
+// the largest error is refined until the tolerance is met; then each axis
+// is shrunk back as far as the tolerance allows.
+template <int dim>
+class SplineGridSelector {
+  private:
+    std::vector<double> a_;
+    std::vector<double> b_;
+    SplineSampler& sampler_;
+    double tolerance_;
+    int minIntervals_;
+    std::vector<int> maxIntervals_;
+    int maxHeldOutPoints_;
+    
+    std::vector<int> n_;
+    std::vector< Spline<dim> > splines_;
+    double error_;
+    int noFits_;
+    double fitTime_;
+    double evaluationTime_;
+    
+    double computeError(const std::vector<int>& n, std::vector<double>& errorOfAxis);
+    void fit(const std::vector<int>& n, std::vector< Spline<dim> >& splines);
+    double computeHeldOutError(const std::vector< Spline<dim> >& splines, const std::vector<int>& n, const int axis);
+    void measureCosts();
+    
+  public:
+    SplineGridSelector(const std::vector<double>& a, const std::vector<double>& b, SplineSampler& sampler);
+    // maximum absolute error on the held-out points, for every value
+    void setTolerance(const double tolerance) { tolerance_ = tolerance; }
+    void setMinIntervals(const int minIntervals) { minIntervals_ = minIntervals; }
+    void setMaxIntervals(const int maxIntervals) { maxIntervals_.assign(dim, maxIntervals); }
+    void setMaxIntervals(const std::vector<int>& maxIntervals) { maxIntervals_ = maxIntervals; }
+    // held-out points of each kind are drawn at random beyond this number
+    void setMaxHeldOutPoints(const int maxHeldOutPoints) { maxHeldOutPoints_ = maxHeldOutPoints; }
+    // false if the tolerance is not met even with maxIntervals on every axis
+    bool selectGrid();
+    const std::vector<int>& getIntervals() const { return n_; }
+    // the splines of the selected grid, one for each value of the sampler
+    const std::vector< Spline<dim> >& getSplines() const { return splines_; }
+    double getError() const { return error_; }
+    int getNumberOfFits() const { return noFits_; }
+    // costs of the selected grid, for all the values
+    long getMemory() const;
+    double getFitTime() const { return fitTime_; }
+    double getEvaluationTime() const { return evaluationTime_; }
+};
+
+
+
+#endif
@@ -0,0 +1,242 @@
+// Copyright (c) 2011, Massimo Sartori and Monica Reggiani
+// All rights reserved.
+
+// Redistribution and use in source and binary forms, with or without 
+// modification, are permitted provided that the following conditions are met:
+// - Redistributions of source code must retain the above copyright notice, 
+//   this list of conditions and the following disclaimer.
+// - Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+
+
+
+#include <math.h>
+#include <stdlib.h>
+#include <iostream>
+#include <algorithm>
+
+//#define LOG_SPLINE
+
+template< int dim >
+SplineLeastSquaresFitter<dim>::SplineLeastSquaresFitter(const std::vector<double>& a, const std::vector<double>& b, const std::vector<int>& n)
+:a_(a), b_(b), n_(n), h_(dim), stride_(dim), stencilOffset_(1 << (2*dim)), 
+ lambda_(1e-6), maxIterations_(1000), tolerance_(1e-8), noIterations_(0), residual_(0) {
+  
+  sizeOfC_ = 1;
+  for (int i = 0; i < dim; ++i) {
+    h_[i] = ( b_[i] - a_[i] ) / n_[i];
+    stride_[i] = sizeOfC_;
+    sizeOfC_ *= ( n_[i] + 3 );
+  }
+  
+  for (int soFar = 0; soFar < (1 << (2*dim)); ++soFar) {
+    int rest = soFar;
+    stencilOffset_[soFar] = 0;
+    for (int i = 0; i < dim; ++i) {
+      stencilOffset_[soFar] += (rest & 3) * stride_[i];
+      rest >>= 2;
+    }
+  }
+}
+
+
+template< int dim >
+void SplineLeastSquaresFitter<dim>::addSample(const std::vector<double>& x, const double y) {
+  int firstIndex = 0;
+  for (int i = 0; i < dim; ++i) {
+    if ( (x[i] < a_[i]) || (x[i] > b_[i]) ) {
+      std::cout << "Sample " << y_.size() << " is out of boundaries\n";
+      exit(EXIT_FAILURE);
+    }
+    // on x = b the basis function l is zero, so the cell n-1 gives the same value
+    int l = std::min( static_cast<int>( floor( ( x[i] - a_[i] ) / h_[i] ) ), n_[i] - 1 );
+    for (int j = 0; j < 4; ++j)
+      basis_.push_back(SplineBasisFunction::getValue(x[i], l+j, a_[i], h_[i]));
+    firstIndex += l * stride_[i];
+  }
+  firstIndex_.push_back(firstIndex);
+  y_.push_back(y);
+}
+
+
+// tensor product of the basis values of one sample, first axis running fastest
+template< int dim >
+void SplineLeastSquaresFitter<dim>::computeStencilWeights(const int sample, std::vector<double>& weights) const {
+  const double* basis = &basis_[sample * 4 * dim];
+  weights[0] = 1;
+  int size = 1;
+  for (int i = 0; i < dim; ++i) {
+    for (int j = 3; j >= 0; --j)
+      for (int k = 0; k < size; ++k)
+        weights[j * size + k] = weights[k] * basis[i*4 + j];
+    size *= 4;
+  }
+}
+
+
+template< int dim >
+void SplineLeastSquaresFitter<dim>::multiplyBySamples(const std::vector<double>& c, std::vector<double>& values) const {
+  std::vector<double> weights(1 << (2*dim));
+  for (unsigned int s = 0; s < y_.size(); ++s) {
+    computeStencilWeights(s, weights);
+    const double* cFirst = &c[firstIndex_[s]];
+    double value = 0;
+    for (int k = 0; k < (1 << (2*dim)); ++k)
+      value += cFirst[stencilOffset_[k]] * weights[k];
+    values[s] = value;
+  }
+}
+
+
+template< int dim >
+void SplineLeastSquaresFitter<dim>::multiplyByTransposedSamples(const std::vector<double>& values, std::vector<double>& c) const {
+  std::vector<double> weights(1 << (2*dim));
+  for (unsigned int s = 0; s < y_.size(); ++s) {
+    computeStencilWeights(s, weights);
+    double* cFirst = &c[firstIndex_[s]];
+    for (int k = 0; k < (1 << (2*dim)); ++k)
+      cFirst[stencilOffset_[k]] += values[s] * weights[k];
+  }
+}
+
+
+// result += lambda * sum_i D_i^T D_i c, with D_i scaled by 6^dim so that it
+// measures second differences of the spline rather than of its coefficients
+template< int dim >
+void SplineLeastSquaresFitter<dim>::addRegularization(const std::vector<double>& c, std::vector<double>& result) const {
+  double scale = lambda_ * pow(36.0, dim);
+  for (int i = 0; i < dim; ++i) {
+    int noLines = sizeOfC_ / ( n_[i] + 3 );
+    for (int line = 0; line < noLines; ++line) {
+      int inner = line % stride_[i];
+      int first = inner + ( line - inner ) * ( n_[i] + 3 );
+      for (int j = 1; j <= n_[i]+1; ++j) {
+        int k = first + j * stride_[i];
+        double d = c[k - stride_[i]] - 2 * c[k] + c[k + stride_[i]];
+        result[k - stride_[i]] += scale * d;
+        result[k]              -= 2 * scale * d;
+        result[k + stride_[i]] += scale * d;
+      }
+    }
+  }
+}
+
+
+template< int dim >
+void SplineLeastSquaresFitter<dim>::multiplyByNormalMatrix(const std::vector<double>& c, std::vector<double>& result) const {
+  std::vector<double> values(y_.size());
+  multiplyBySamples(c, values);
+  result.assign(sizeOfC_, 0.);
+  multiplyByTransposedSamples(values, result);
+  addRegularization(c, result);
+}
+
+
+template< int dim >
+void SplineLeastSquaresFitter<dim>::computeDiagonal(std::vector<double>& diagonal) const {
+  diagonal.assign(sizeOfC_, 0.);
+  std::vector<double> weights(1 << (2*dim));
+  for (unsigned int s = 0; s < y_.size(); ++s) {
+    computeStencilWeights(s, weights);
+    double* diagonalFirst = &diagonal[firstIndex_[s]];
+    for (int k = 0; k < (1 << (2*dim)); ++k)
+      diagonalFirst[stencilOffset_[k]] += weights[k] * weights[k];
+  }
+  
+  double scale = lambda_ * pow(36.0, dim);
+  for (int i = 0; i < dim; ++i) {
+    int noLines = sizeOfC_ / ( n_[i] + 3 );
+    for (int line = 0; line < noLines; ++line) {
+      int inner = line % stride_[i];
+      int first = inner + ( line - inner ) * ( n_[i] + 3 );
+      for (int j = 1; j <= n_[i]+1; ++j) {
+        int k = first + j * stride_[i];
+        diagonal[k - stride_[i]] += scale;
+        diagonal[k]              += 4 * scale;
+        diagonal[k + stride_[i]] += scale;
+      }
+    }
+  }
+  
+  // without regularization the coefficients no sample reaches have an empty
+  // row: r stays 0 there, and 1 keeps the preconditioner finite
+  for (int k = 0; k < sizeOfC_; ++k)
+    if (diagonal[k] == 0)
+      diagonal[k] = 1;
+}
+
+
+template< int dim >
+void SplineLeastSquaresFitter<dim>::computeCoefficients(Spline<dim>& spline) {
+  std::vector<double> c(spline.getCoefficients());
+  if (static_cast<int>(c.size()) != sizeOfC_) {
+    std::cout << "The spline has " << c.size() << " coefficients, but the fitter " << sizeOfC_ << std::endl;
+    exit(EXIT_FAILURE);
+  }
+  
+  std::vector<double> rhs(sizeOfC_, 0.);
+  multiplyByTransposedSamples(y_, rhs);
+  double normOfRhs = 0;
+  for (int k = 0; k < sizeOfC_; ++k)
+    normOfRhs += rhs[k] * rhs[k];
+  normOfRhs = sqrt(normOfRhs);
+  
+  std::vector<double> diagonal;
+  computeDiagonal(diagonal);
+  
+  std::vector<double> r(sizeOfC_), z(sizeOfC_), p(sizeOfC_), q(sizeOfC_);
+  multiplyByNormalMatrix(c, q);
+  double rz = 0, normOfR = 0;
+  for (int k = 0; k < sizeOfC_; ++k) {
+    r[k] = rhs[k] - q[k];
+    z[k] = r[k] / diagonal[k];
+    p[k] = z[k];
+    rz += r[k] * z[k];
+    normOfR += r[k] * r[k];
+  }
+  
+  noIterations_ = 0;
+  residual_ = (normOfRhs > 0) ? sqrt(normOfR) / normOfRhs : 0;
+  while ( (residual_ > tolerance_) && (noIterations_ < maxIterations_) ) {
+    multiplyByNormalMatrix(p, q);
+    double pq = 0;
+    for (int k = 0; k < sizeOfC_; ++k)
+      pq += p[k] * q[k];
+    double alpha = rz / pq;
+    double newRz = 0;
+    normOfR = 0;
+    for (int k = 0; k < sizeOfC_; ++k) {
+      c[k] += alpha * p[k];
+      r[k] -= alpha * q[k];
+      z[k] = r[k] / diagonal[k];
+      newRz += r[k] * z[k];
+      normOfR += r[k] * r[k];
+    }
+    double beta = newRz / rz;
+    rz = newRz;
+    for (int k = 0; k < sizeOfC_; ++k)
+      p[k] = z[k] + beta * p[k];
+    ++noIterations_;
+    residual_ = sqrt(normOfR) / normOfRhs;
+  }
+  
+#ifdef LOG_SPLINE
+  std::cout << "Least squares fit of " << y_.size() << " samples: " << noIterations_ 
+            << " iterations, relative residual " << residual_ << std::endl;
+#endif
+  
+  spline.setCoefficients(c);
+}
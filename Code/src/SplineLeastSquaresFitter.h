@@ -0,0 +1,89 @@
+// Copyright (c) 2011, Massimo Sartori and Monica Reggiani
+// All rights reserved.
+
+// Redistribution and use in source and binary forms, with or without 
+// modification, are permitted provided that the following conditions are met:
+// - Redistributions of source code must retain the above copyright notice, 
+//   this list of conditions and the following disclaimer.
+// - Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+
+
+
+#ifndef SplineLeastSquaresFitter_h
+#define SplineLeastSquaresFitter_h
+
+
+#include <vector>
+
+#include "Spline.h"
+
+// Fit the coefficients of a Spline<dim> to samples taken anywhere in
+// [a, b], instead of on all the nodes of the grid, by minimizing
+//   sum_s ( f(x_s) - y_s )^2 + lambda * sum_i || D_i f ||^2
+// where D_i f are the second differences of the coefficients along axis i,
+// scaled to the units of y. The regularization keeps the problem well posed
+// where the samples do not constrain all the coefficients; a larger lambda
+// (default 1e-6) gives a smoother spline and fewer iterations.
+// The normal equations are solved with a Jacobi preconditioned conjugate
+// gradient: each sample touches only the 4^dim coefficients of its cell, so
+// the system is never assembled.
+template <int dim>
+class SplineLeastSquaresFitter {
+  private:
+    std::vector<double> a_;
+    std::vector<double> b_;
+    std::vector<int> n_;
+    std::vector<double> h_;
+    std::vector<int> stride_;
+    int sizeOfC_;
+    std::vector<int> stencilOffset_;
+    
+    // for each sample, the first coefficient of its cell and the 4 values
+    // of the basis functions on each axis
+    std::vector<int> firstIndex_;
+    std::vector<double> basis_;
+    std::vector<double> y_;
+    
+    double lambda_;
+    int maxIterations_;
+    double tolerance_;
+    int noIterations_;
+    double residual_;
+    
+    void computeStencilWeights(const int sample, std::vector<double>& weights) const;
+    void multiplyBySamples(const std::vector<double>& c, std::vector<double>& values) const;
+    void multiplyByTransposedSamples(const std::vector<double>& values, std::vector<double>& c) const;
+    void addRegularization(const std::vector<double>& c, std::vector<double>& result) const;
+    void multiplyByNormalMatrix(const std::vector<double>& c, std::vector<double>& result) const;
+    void computeDiagonal(std::vector<double>& diagonal) const;
+    
+  public:
+    SplineLeastSquaresFitter(const std::vector<double>& a, const std::vector<double>& b, const std::vector<int>& n);
+    void setRegularization(const double lambda) { lambda_ = lambda; }
+    void setMaxIterations(const int maxIterations) { maxIterations_ = maxIterations; }
+    void setTolerance(const double tolerance) { tolerance_ = tolerance; }
+    void addSample(const std::vector<double>& x, const double y);
+    int getNumberOfSamples() const { return y_.size(); }
+    // the coefficients of spline are used as initial guess and replaced by the solution
+    void computeCoefficients(Spline<dim>& spline);
+    int getNumberOfIterations() const { return noIterations_; }
+    double getRelativeResidual() const { return residual_; }
+};
+
+
+
+#endif
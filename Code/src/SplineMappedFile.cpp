@@ -0,0 +1,134 @@
+// Copyright (c) 2011, Massimo Sartori and Monica Reggiani
+// All rights reserved.
+
+// Redistribution and use in source and binary forms, with or without 
+// modification, are permitted provided that the following conditions are met:
+// - Redistributions of source code must retain the above copyright notice, 
+//   this list of conditions and the following disclaimer.
+// - Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+
+
+
+#include "SplineMappedFile.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <iostream>
+#include <vector>
+#include <algorithm>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+//#define LOG_SPLINE
+
+SplineMappedFile::SplineMappedFile()
+:fileDescriptor_(-1), data_(NULL), size_(0) {
+}
+
+
+SplineMappedFile::~SplineMappedFile() {
+  close();
+}
+
+
+void SplineMappedFile::openForReading(const std::string& filename) {
+  close();
+  filename_ = filename;
+  fileDescriptor_ = open(filename.c_str(), O_RDONLY);
+  struct stat status;
+  if ( (fileDescriptor_ < 0) || (fstat(fileDescriptor_, &status) != 0) ) {
+    std::cout << "ERROR: " << filename << " could not be open: " << strerror(errno) << std::endl;
+    exit(EXIT_FAILURE);
+  }
+  size_ = status.st_size;
+  map(false);
+}
+
+
+void SplineMappedFile::create(const std::string& filename, const size_t size) {
+  close();
+  filename_ = filename;
+  fileDescriptor_ = open(filename.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+  if ( (fileDescriptor_ < 0) || (ftruncate(fileDescriptor_, size) != 0) ) {
+    std::cout << "ERROR: " << filename << " could not be created: " << strerror(errno) << std::endl;
+    exit(EXIT_FAILURE);
+  }
+  size_ = size;
+  map(true);
+}
+
+
+void SplineMappedFile::map(const bool writable) {
+  if (size_ == 0)
+    return;
+  void* data = mmap(NULL, size_, writable ? (PROT_READ | PROT_WRITE) : PROT_READ, MAP_SHARED, fileDescriptor_, 0);
+  if (data == MAP_FAILED) {
+    std::cout << "ERROR: " << filename_ << " could not be mapped: " << strerror(errno) << std::endl;
+    exit(EXIT_FAILURE);
+  }
+  data_ = static_cast<char*>(data);
+#ifdef LOG_SPLINE
+  std::cout << "Mapped " << filename_ << ": " << size_ << " bytes\n";
+#endif
+}
+
+
+void SplineMappedFile::close() {
+  if (data_ != NULL)
+    munmap(data_, size_);
+  if (fileDescriptor_ >= 0)
+    ::close(fileDescriptor_);
+  data_ = NULL;
+  fileDescriptor_ = -1;
+  size_ = 0;
+}
+
+
+void SplineMappedFile::remove() {
+  close();
+  if (!filename_.empty())
+    unlink(filename_.c_str());
+}
+
+
+long SplineMappedFile::getNumberOfResidentPages(const size_t begin, const size_t size) const {
+  const size_t pageSize = getPageSize();
+  const size_t firstPage = begin / pageSize;
+  const size_t end = std::min(begin + size, size_);
+  if ( (data_ == NULL) || (end <= begin) )
+    return 0;
+  const size_t noPages = (end + pageSize-1) / pageSize - firstPage;
+#ifdef __linux__
+  std::vector<unsigned char> resident(noPages);
+#else
+  std::vector<char> resident(noPages);
+#endif
+  if (mincore(data_ + firstPage * pageSize, noPages * pageSize, &resident[0]) != 0)
+    return 0;
+  long noResident = 0;
+  for (size_t k = 0; k < noPages; ++k)
+    noResident += resident[k] & 1;
+  return noResident;
+}
+
+
+size_t SplineMappedFile::getPageSize() {
+  return sysconf(_SC_PAGESIZE);
+}
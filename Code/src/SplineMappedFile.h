@@ -0,0 +1,65 @@
+// Copyright (c) 2011, Massimo Sartori and Monica Reggiani
+// All rights reserved.
+
+// Redistribution and use in source and binary forms, with or without 
+// modification, are permitted provided that the following conditions are met:
+// - Redistributions of source code must retain the above copyright notice, 
+//   this list of conditions and the following disclaimer.
+// - Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+
+
+
+#ifndef SplineMappedFile_h
+#define SplineMappedFile_h
+
+
+#include <string>
+#include <stddef.h>
+
+// A whole file mapped in memory with POSIX mmap, either an existing one,
+// read-only, or a new one of a given size, shared with the file so that
+// the kernel writes back the pages that do not fit in memory.
+// Errors stop the program, as in the rest of the library.
+class SplineMappedFile {
+  private:
+    std::string filename_;
+    int fileDescriptor_;
+    char* data_;
+    size_t size_;
+    
+    SplineMappedFile(const SplineMappedFile&);
+    SplineMappedFile& operator=(const SplineMappedFile&);
+    void map(const bool writable);
+    
+  public:
+    SplineMappedFile();
+    ~SplineMappedFile();
+    void openForReading(const std::string& filename);
+    void create(const std::string& filename, const size_t size);
+    // unmaps and closes; remove also deletes the file
+    void close();
+    void remove();
+    char* getData() const { return data_; }
+    size_t getSize() const { return size_; }
+    // pages of [begin, begin+size) of the file currently in memory
+    long getNumberOfResidentPages(const size_t begin, const size_t size) const;
+    static size_t getPageSize();
+};
+
+
+
+#endif
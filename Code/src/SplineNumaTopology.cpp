@@ -0,0 +1,197 @@
+// Copyright (c) 2011, Massimo Sartori and Monica Reggiani
+// All rights reserved.
+
+// Redistribution and use in source and binary forms, with or without 
+// modification, are permitted provided that the following conditions are met:
+// - Redistributions of source code must retain the above copyright notice, 
+//   this list of conditions and the following disclaimer.
+// - Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+
+
+
+#include "SplineNumaTopology.h"
+
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <algorithm>
+#include <thread>
+
+#ifdef __linux__
+#include <sched.h>
+#include <unistd.h>
+#include <sys/syscall.h>
+#endif
+
+//#define LOG_SPLINE
+#ifdef LOG_SPLINE
+#include <iostream>
+#endif
+
+// "0-3,8-11" as in the cpulist of sysfs
+static std::vector<int> parseList(const std::string& list) {
+  std::vector<int> values;
+  std::stringstream stream(list);
+  std::string range;
+  while (std::getline(stream, range, ',')) {
+    int first, last;
+    char dash;
+    std::stringstream rangeStream(range);
+    if (!(rangeStream >> first))
+      continue;
+    if (rangeStream >> dash >> last)
+      for (int value = first; value <= last; ++value)
+        values.push_back(value);
+    else
+      values.push_back(first);
+  }
+  return values;
+}
+
+
+static std::string readLine(const std::string& filename) {
+  std::ifstream file(filename.c_str());
+  std::string line;
+  if (file.is_open())
+    std::getline(file, line);
+  return line;
+}
+
+
+SplineNumaTopology::SplineNumaTopology() {
+  readSysfs();
+  
+  if (cpusOfNode_.empty()) {
+    int noCpus = std::max(1u, std::thread::hardware_concurrency());
+    cpusOfNode_.push_back(std::vector<int>());
+    systemIdOfNode_.push_back(0);
+    for (int cpu = 0; cpu < noCpus; ++cpu)
+      cpusOfNode_[0].push_back(cpu);
+  }
+  
+  for (unsigned int k = 0; k < cpusOfNode_.size(); ++k)
+    for (unsigned int i = 0; i < cpusOfNode_[k].size(); ++i) {
+      int cpu = cpusOfNode_[k][i];
+      if (cpu >= static_cast<int>(nodeOfCpu_.size()))
+        nodeOfCpu_.resize(cpu+1, -1);
+      nodeOfCpu_[cpu] = k;
+    }
+  
+#ifdef LOG_SPLINE
+  for (unsigned int k = 0; k < cpusOfNode_.size(); ++k)
+    std::cout << "NUMA node " << systemIdOfNode_[k] << ": " << cpusOfNode_[k].size() << " cpus\n";
+#endif
+}
+
+
+void SplineNumaTopology::readSysfs() {
+#ifdef __linux__
+  cpu_set_t allowed;
+  CPU_ZERO(&allowed);
+  bool haveAffinity = (sched_getaffinity(0, sizeof(allowed), &allowed) == 0);
+  
+  const std::string nodeDirectory = "/sys/devices/system/node/";
+  std::vector<int> nodes = parseList(readLine(nodeDirectory + "online"));
+  for (unsigned int k = 0; k < nodes.size(); ++k) {
+    std::stringstream cpulistFilename;
+    cpulistFilename << nodeDirectory << "node" << nodes[k] << "/cpulist";
+    std::vector<int> cpus = parseList(readLine(cpulistFilename.str()));
+    std::vector<int> usableCpus;
+    for (unsigned int i = 0; i < cpus.size(); ++i)
+      if (!haveAffinity || ( (cpus[i] < CPU_SETSIZE) && CPU_ISSET(cpus[i], &allowed) ))
+        usableCpus.push_back(cpus[i]);
+    if (!usableCpus.empty()) {
+      cpusOfNode_.push_back(usableCpus);
+      systemIdOfNode_.push_back(nodes[k]);
+    }
+  }
+#endif
+}
+
+
+int SplineNumaTopology::getNumberOfCpus() const {
+  int noCpus = 0;
+  for (unsigned int k = 0; k < cpusOfNode_.size(); ++k)
+    noCpus += cpusOfNode_[k].size();
+  return noCpus;
+}
+
+
+int SplineNumaTopology::getNodeOfCpu(const int cpu) const {
+  if ( (cpu < 0) || (cpu >= static_cast<int>(nodeOfCpu_.size())) )
+    return -1;
+  return nodeOfCpu_[cpu];
+}
+
+
+int SplineNumaTopology::getCurrentNode() const {
+#ifdef __linux__
+  int node = getNodeOfCpu(sched_getcpu());
+  if (node >= 0)
+    return node;
+#endif
+  return 0;
+}
+
+
+bool SplineNumaTopology::pinThread(const int cpu) {
+#ifdef __linux__
+  if ( (cpu < 0) || (cpu >= CPU_SETSIZE) )
+    return false;
+  cpu_set_t cpus;
+  CPU_ZERO(&cpus);
+  CPU_SET(cpu, &cpus);
+  return sched_setaffinity(0, sizeof(cpus), &cpus) == 0;
+#else
+  (void) cpu;
+  return false;
+#endif
+}
+
+
+// move_pages without target nodes only tells where the pages are
+void SplineNumaTopology::getPlacement(const void* begin, const size_t size, std::vector<long>& pagesOfNode) const {
+  const int noNodes = getNumberOfNodes();
+  pagesOfNode.assign(noNodes+1, 0);
+  if (size == 0)
+    return;
+#if defined(__linux__) && defined(SYS_move_pages)
+  const size_t pageSize = sysconf(_SC_PAGESIZE);
+  const char* firstPage = reinterpret_cast<const char*>(reinterpret_cast<size_t>(begin) & ~(pageSize-1));
+  const char* end = reinterpret_cast<const char*>(begin) + size;
+  const int batchSize = 1024;
+  std::vector<void*> pages(batchSize);
+  std::vector<int> status(batchSize);
+  for (const char* page = firstPage; page < end; ) {
+    int noPages = 0;
+    for (; (noPages < batchSize) && (page < end); ++noPages, page += pageSize)
+      pages[noPages] = const_cast<char*>(page);
+    if (syscall(SYS_move_pages, 0, noPages, &pages[0], NULL, &status[0], 0) != 0) {
+      // no NUMA support in the kernel: on one node all the pages are local
+      pagesOfNode[noNodes > 1 ? noNodes : 0] += noPages;
+      continue;
+    }
+    for (int i = 0; i < noPages; ++i) {
+      int node = std::find(systemIdOfNode_.begin(), systemIdOfNode_.end(), status[i]) - systemIdOfNode_.begin();
+      ++pagesOfNode[status[i] < 0 ? noNodes : node];
+    }
+  }
+#else
+  const long pageSize = 4096;
+  pagesOfNode[noNodes > 1 ? noNodes : 0] += (size + pageSize-1) / pageSize;
+#endif
+}
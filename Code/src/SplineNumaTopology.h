@@ -0,0 +1,66 @@
+// Copyright (c) 2011, Massimo Sartori and Monica Reggiani
+// All rights reserved.
+
+// Redistribution and use in source and binary forms, with or without 
+// modification, are permitted provided that the following conditions are met:
+// - Redistributions of source code must retain the above copyright notice, 
+//   this list of conditions and the following disclaimer.
+// - Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+
+
+
+#ifndef SplineNumaTopology_h
+#define SplineNumaTopology_h
+
+
+#include <vector>
+#include <stddef.h>
+
+// The NUMA nodes of the machine with the CPUs this process may run on, read
+// from /sys/devices/system/node on Linux. Elsewhere, or when sysfs does not
+// tell, the machine is a single node with all the CPUs, so the callers work
+// the same way on a single-socket machine.
+// Nodes are numbered from 0 to getNumberOfNodes()-1; the nodes without CPUs
+// are left out, their memory is always remote.
+class SplineNumaTopology {
+  private:
+    std::vector< std::vector<int> > cpusOfNode_;
+    std::vector<int> systemIdOfNode_;
+    std::vector<int> nodeOfCpu_;
+    
+    void readSysfs();
+    
+  public:
+    SplineNumaTopology();
+    int getNumberOfNodes() const { return cpusOfNode_.size(); }
+    int getNumberOfCpus() const;
+    const std::vector<int>& getCpusOfNode(const int node) const { return cpusOfNode_[node]; }
+    // -1 if the cpu is not known
+    int getNodeOfCpu(const int cpu) const;
+    // node of the cpu running the calling thread, 0 if unknown
+    int getCurrentNode() const;
+    // pins the calling thread on cpu; false if it is not supported
+    static bool pinThread(const int cpu);
+    // pagesOfNode[k] is the number of pages of [begin, begin+size) that are
+    // on node k; the last element counts the pages on other nodes or whose
+    // node is unknown (not touched yet, or no support from the kernel)
+    void getPlacement(const void* begin, const size_t size, std::vector<long>& pagesOfNode) const;
+};
+
+
+
+#endif
@@ -0,0 +1,152 @@
+// Copyright (c) 2011, Massimo Sartori and Monica Reggiani
+// All rights reserved.
+
+// Redistribution and use in source and binary forms, with or without 
+// modification, are permitted provided that the following conditions are met:
+// - Redistributions of source code must retain the above copyright notice, 
+//   this list of conditions and the following disclaimer.
+// - Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+
+
+
+#ifndef SplineOrder_h
+#define SplineOrder_h
+
+#include <math.h>
+#include <algorithm>
+
+#include "SplineBasisFunction.h"
+#include "SplineDual.h"
+
+// What depends on the order k of a uniform Bspline (k = 4 for the cubic one).
+// The basis function k of an axis is centred on node k - halfWidth, so an axis
+// with n intervals has n+1 + 2*halfWidth coefficients (n+3 for cubic), and k
+// of them are not null in each point. The basis is scaled by (k-1)!, as the
+// cubic one of SplineBasisFunction (4, 1, 1 on the nodes).
+template <int order>
+struct SplineOrder {
+  static const int halfWidth = (order-1)/2;
+  
+  static int getNumberOfCoefficients(const int n) { return n + 1 + 2*halfWidth; }
+  
+  // first of the order basis functions not null in x; for odd orders the
+  // support of a basis function is centred on a node, so we round
+  static int computeInterval(const double x, const double a, const double h, const int n) {
+    int l = static_cast<int>( floor( ( x - a ) / h + ( (order % 2) ? 0.5 : 0. ) ) );
+    return std::max(0, std::min(l, getNumberOfCoefficients(n) - order));
+  }
+  
+  // derivative of order r of the scaled basis function centred in 0, with unit spacing.
+  // The basis is even: it is computed on -|t| so that only the few truncated
+  // powers not null on the left of the support are summed
+  static double getDerivative(const double t, const int r) {
+    const double u = -fabs(t);
+    double factor = 1;
+    for (int m = 0; m < r; ++m)
+      factor *= (order-1-m);
+    double sum = 0;
+    double binomial = 1;
+    for (int j = 0; j < order; ++j) {
+      double v = u + 0.5*order - j;
+      if (v <= 0)
+        break;
+      sum += ( (j % 2) ? -binomial : binomial ) * pow(v, order-1-r);
+      binomial = binomial * (order-j) / (j+1);
+    }
+    return ( (t > 0) && (r % 2) ) ? -factor * sum : factor * sum;
+  }
+  
+  // integral from -infinity to t of the scaled basis function centred in 0,
+  // with unit spacing: the truncated powers of getDerivative raised by one,
+  // and on the right of 0 the whole integral, (order-1)!, minus the left tail
+  static double getIntegral(const double t) {
+    const double u = -fabs(t);
+    double sum = 0;
+    double binomial = 1;
+    for (int j = 0; j < order; ++j) {
+      double v = u + 0.5*order - j;
+      if (v <= 0)
+        break;
+      sum += ( (j % 2) ? -binomial : binomial ) * pow(v, order);
+      binomial = binomial * (order-j) / (j+1);
+    }
+    sum /= order;
+    if (t <= 0)
+      return sum;
+    double total = 1;
+    for (int m = 2; m < order; ++m)
+      total *= m;
+    return total - sum;
+  }
+  
+  // getDerivative for another scalar type, e.g. float or SplineDual: the
+  // pieces are chosen on the plain value of t and the powers multiplied out
+  template <typename Scalar>
+  static Scalar getGenericDerivative(const Scalar& t, const int r) {
+    const bool positive = SplineScalar<Scalar>::getValue(t) > 0;
+    const Scalar u = positive ? -t : t;
+    double factor = 1;
+    for (int m = 0; m < r; ++m)
+      factor *= (order-1-m);
+    Scalar sum = 0.;
+    double binomial = 1;
+    for (int j = 0; j < order; ++j) {
+      Scalar v = u + (0.5*order - j);
+      if (SplineScalar<Scalar>::getValue(v) <= 0)
+        break;
+      Scalar power = 1.;
+      for (int m = 0; m < order-1-r; ++m)
+        power = power * v;
+      sum += ( (j % 2) ? -binomial : binomial ) * power;
+      binomial = binomial * (order-j) / (j+1);
+    }
+    return ( positive && (r % 2) ) ? -factor * sum : factor * sum;
+  }
+  
+  static double getValue(double x, int k, double a, double h) {
+    if (order == 4)
+      return SplineBasisFunction::getValue(x, k, a, h);
+    return getDerivative( ( (x - a) / h ) - (k - halfWidth), 0 );
+  }
+  
+  static double getFirstDerivative(double x, int k, double a, double h) {
+    if (order == 4)
+      return SplineBasisFunction::getFirstDerivative(x, k, a, h);
+    return getDerivative( ( (x - a) / h ) - (k - halfWidth), 1 ) / h;
+  }
+  
+  // integral of the basis function k from x0 to x1
+  static double getIntegral(double x0, double x1, int k, double a, double h) {
+    return h * ( getIntegral( ( (x1 - a) / h ) - (k - halfWidth) ) - getIntegral( ( (x0 - a) / h ) - (k - halfWidth) ) );
+  }
+  
+  static double getSecondDerivative(double x, int k, double a, double h) {
+    return getDerivative( ( (x - a) / h ) - (k - halfWidth), 2 ) / (h * h);
+  }
+  
+  template <typename Scalar>
+  static Scalar getGenericValue(const Scalar& x, int k, double a, double h) {
+    return getGenericDerivative( ( (x - a) / h ) - (k - halfWidth), 0 );
+  }
+  
+  template <typename Scalar>
+  static Scalar getGenericFirstDerivative(const Scalar& x, int k, double a, double h) {
+    return getGenericDerivative( ( (x - a) / h ) - (k - halfWidth), 1 ) / h;
+  }
+};
+
+#endif
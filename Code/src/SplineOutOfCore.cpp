@@ -0,0 +1,300 @@
+// Copyright (c) 2011, Massimo Sartori and Monica Reggiani
+// All rights reserved.
+
+// Redistribution and use in source and binary forms, with or without 
+// modification, are permitted provided that the following conditions are met:
+// - Redistributions of source code must retain the above copyright notice, 
+//   this list of conditions and the following disclaimer.
+// - Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+
+
+
+#include <string.h>
+#include <stdlib.h>
+#include <iostream>
+#include <algorithm>
+
+//#define LOG_SPLINE
+
+template< int dim, int order >
+void SplineTiledLayout<dim, order>::init(const int* n) {
+  long sizeOfTile = 1;
+  for (int i = 0; i < dim; ++i)
+    sizeOfTile *= order;
+  
+  offset.clear();
+  long stride = 1;
+  long powerOfOrder = 1;
+  noTiles = 1;
+  for (int i = 0; i < dim; ++i) {
+    const int noCoefficients = SplineOrder<order>::getNumberOfCoefficients(n[i]);
+    firstOffset[i] = offset.size();
+    for (int j = 0; j < noCoefficients; ++j)
+      offset.push_back( (j / order) * stride * sizeOfTile + (j % order) * powerOfOrder );
+    tileStride[i] = stride;
+    stride *= (noCoefficients + order-1) / order;
+    powerOfOrder *= order;
+  }
+  noTiles = stride;
+  size = noTiles * sizeOfTile;
+}
+
+
+/*************************************** SplineOutOfCoreFitter ****************************************/
+
+
+template< int dim, int order >
+SplineOutOfCoreFitter<dim, order>::SplineOutOfCoreFitter(const std::vector<double>& a, const std::vector<double>& b,
+                                                         const std::vector<int>& n)
+:a_(a), b_(b), n_(n), linesPerChunk_(512) {
+  if ( (static_cast<int>(a_.size()) != dim) || (static_cast<int>(b_.size()) != dim) || (static_cast<int>(n_.size()) != dim) ) {
+    std::cout << "SplineOutOfCoreFitter<" << dim << "> needs the grid of " << dim << " axes\n";
+    exit(EXIT_FAILURE);
+  }
+  if (dim > SPLINE_MAPPED_MAX_DIM) {
+    std::cout << "The coefficient files have at most " << SPLINE_MAPPED_MAX_DIM << " axes\n";
+    exit(EXIT_FAILURE);
+  }
+}
+
+
+// y has the coefficients of the axes before axis and the nodes of the
+// others, c the same with the coefficients of axis too. The lines of axis
+// are gathered by chunks of consecutive ones, so both the reads and the
+// writes run over (n+1) and (n+3) stretches of the files at a time.
+template< int dim, int order >
+void SplineOutOfCoreFitter<dim, order>::fitAxis(const int axis, const double* y, double* c) const {
+  long inner = 1, outer = 1;
+  for (int i = 0; i < axis; ++i)
+    inner *= SplineOrder<order>::getNumberOfCoefficients(n_[i]);
+  for (int i = axis+1; i < dim; ++i)
+    outer *= n_[i] + 1;
+  const int noNodes = n_[axis] + 1;
+  const int noCoefficients = SplineOrder<order>::getNumberOfCoefficients(n_[axis]);
+  
+  SplineFitter<1, order> fitter(std::vector<double>(1, a_[axis]), std::vector<double>(1, b_[axis]), std::vector<int>(1, n_[axis]));
+  std::vector<double> lines(static_cast<size_t>(linesPerChunk_) * noNodes);
+  std::vector<double> fittedLines(static_cast<size_t>(linesPerChunk_) * noCoefficients);
+  for (long o = 0; o < outer; ++o)
+    for (long firstLine = 0; firstLine < inner; firstLine += linesPerChunk_) {
+      const int noLines = std::min(static_cast<long>(linesPerChunk_), inner - firstLine);
+      const double* source = y + o * noNodes * inner + firstLine;
+      for (int j = 0; j < noNodes; ++j)
+        for (int k = 0; k < noLines; ++k)
+          lines[k * noNodes + j] = source[j * inner + k];
+      
+      for (int k = 0; k < noLines; ++k) {
+        fitter.computeCoefficients(lines, lines.begin() + k * noNodes);
+        const std::vector<double>& lineC = fitter.getCoefficients();
+        for (int j = 0; j < noCoefficients; ++j)
+          fittedLines[j * noLines + k] = lineC[j];
+      }
+      
+      double* destination = c + o * noCoefficients * inner + firstLine;
+      for (int j = 0; j < noCoefficients; ++j)
+        for (int k = 0; k < noLines; ++k)
+          destination[j * inner + k] = fittedLines[j * noLines + k];
+    }
+}
+
+
+template< int dim, int order >
+void SplineOutOfCoreFitter<dim, order>::fit(const std::string& nodesFilename, const std::string& coefficientsFilename) const {
+  long sizeOfY = 1;
+  for (int i = 0; i < dim; ++i)
+    sizeOfY *= n_[i] + 1;
+  SplineMappedFile nodesFile;
+  nodesFile.openForReading(nodesFilename);
+  if (nodesFile.getSize() != sizeOfY * sizeof(double)) {
+    std::cout << "ERROR: " << nodesFilename << " has " << nodesFile.getSize() << " bytes, instead of "
+              << sizeOfY << " doubles\n";
+    exit(EXIT_FAILURE);
+  }
+  
+  SplineMappedFile passFile[2];
+  const double* y = reinterpret_cast<const double*>(nodesFile.getData());
+  long sizeOfC = sizeOfY;
+  for (int axis = 0; axis < dim; ++axis) {
+    sizeOfC = sizeOfC / (n_[axis] + 1) * SplineOrder<order>::getNumberOfCoefficients(n_[axis]);
+    SplineMappedFile& output = passFile[axis % 2];
+    output.create(coefficientsFilename + ((axis % 2) ? ".1" : ".0"), sizeOfC * sizeof(double));
+    fitAxis(axis, y, reinterpret_cast<double*>(output.getData()));
+    if (axis == 0)
+      nodesFile.close();
+    else
+      passFile[(axis-1) % 2].remove();
+    y = reinterpret_cast<const double*>(output.getData());
+#ifdef LOG_SPLINE
+    std::cout << "Fitted axis " << axis << ": " << sizeOfC << " values\n";
+#endif
+  }
+  
+  SplineTiledLayout<dim, order> layout;
+  layout.init(&n_[0]);
+  SplineMappedFile coefficientsFile;
+  coefficientsFile.create(coefficientsFilename, SPLINE_MAPPED_HEADER_SIZE + layout.size * sizeof(double));
+  SplineMappedHeader header;
+  memset(&header, 0, sizeof(header));
+  memcpy(header.magic, SPLINE_MAPPED_MAGIC, sizeof(header.magic));
+  header.dim = dim;
+  header.order = order;
+  for (int i = 0; i < dim; ++i) {
+    header.n[i] = n_[i];
+    header.a[i] = a_[i];
+    header.b[i] = b_[i];
+  }
+  memcpy(coefficientsFile.getData(), &header, sizeof(header));
+  
+  // from row-major to tiled: the reads are sequential, the writes stay in
+  // the tiles of order consecutive coefficients of the last axis
+  double* tiledC = reinterpret_cast<double*>(coefficientsFile.getData() + SPLINE_MAPPED_HEADER_SIZE);
+  std::vector<int> j(dim, 0);
+  for (long k = 0; k < sizeOfC; ++k) {
+    long cIndex = 0;
+    for (int i = 0; i < dim; ++i)
+      cIndex += layout.offset[layout.firstOffset[i] + j[i]];
+    tiledC[cIndex] = y[k];
+    for (int i = 0; (i < dim) && (++j[i] == SplineOrder<order>::getNumberOfCoefficients(n_[i])); ++i)
+      j[i] = 0;
+  }
+  passFile[(dim-1) % 2].remove();
+}
+
+
+/*************************************** SplineMapped ****************************************/
+
+
+template< int dim, int order >
+SplineMapped<dim, order>::SplineMapped(const std::string& coefficientsFilename)
+:c_(NULL), tileStatistics_(false), noEvaluations_(0), noTileAccesses_(0), noTilesTouched_(0) {
+  file_.openForReading(coefficientsFilename);
+  SplineMappedHeader header;
+  if (file_.getSize() < SPLINE_MAPPED_HEADER_SIZE) {
+    std::cout << "ERROR: " << coefficientsFilename << " is not a coefficient file\n";
+    exit(EXIT_FAILURE);
+  }
+  memcpy(&header, file_.getData(), sizeof(header));
+  if ( (memcmp(header.magic, SPLINE_MAPPED_MAGIC, sizeof(header.magic)) != 0) || (header.dim != dim) || (header.order != order) ) {
+    std::cout << "ERROR: " << coefficientsFilename << " is not the coefficient file of a SplineMapped<"
+              << dim << ", " << order << ">\n";
+    exit(EXIT_FAILURE);
+  }
+  for (int i = 0; i < dim; ++i) {
+    a_[i] = header.a[i];
+    b_[i] = header.b[i];
+    n_[i] = header.n[i];
+    h_[i] = (b_[i] - a_[i]) / n_[i];
+  }
+  layout_.init(n_);
+  if (file_.getSize() != SPLINE_MAPPED_HEADER_SIZE + layout_.size * sizeof(double)) {
+    std::cout << "ERROR: " << coefficientsFilename << " is truncated\n";
+    exit(EXIT_FAILURE);
+  }
+  c_ = reinterpret_cast<const double*>(file_.getData() + SPLINE_MAPPED_HEADER_SIZE);
+}
+
+
+template< int dim, int order >
+bool SplineMapped<dim, order>::checkValues(const std::vector<double>& x) const {
+  for (int i = 0; i < dim; ++i )
+    if ( (x[i] < a_[i]) || (x[i] > b_[i]) )
+      return false;
+  return true;
+}
+
+
+template< int dim, int order >
+double SplineMapped<dim, order>::getValue(const std::vector<double>& x) const {
+  return evaluate(x, -1);
+}
+
+
+template< int dim, int order >
+double SplineMapped<dim, order>::getFirstDerivative(const std::vector<double>& x, const int dimDerivative) const {
+  return evaluate(x, dimDerivative);
+}
+
+
+template< int dim, int order >
+double SplineMapped<dim, order>::evaluate(const std::vector<double>& x, const int dimDerivative) const {
+  if (!checkValues(x)) {
+    std::cout << "Values x are out of boundaries\n";
+    exit(EXIT_FAILURE);
+  }
+  
+  double basis[dim][order];
+  const long* offsets[dim];
+  int firstCoefficient[dim];
+  for (int i = 0; i < dim; ++i) {
+    int l = SplineOrder<order>::computeInterval(x[i], a_[i], h_[i], n_[i]);
+    for (int j = 0; j < order; ++j)
+      basis[i][j] = (i == dimDerivative) ? SplineOrder<order>::getFirstDerivative(x[i], l+j, a_[i], h_[i])
+                                         : SplineOrder<order>::getValue(x[i], l+j, a_[i], h_[i]);
+    offsets[i] = &layout_.offset[layout_.firstOffset[i] + l];
+    firstCoefficient[i] = l;
+  }
+  if (tileStatistics_)
+    recordTiles(firstCoefficient);
+  return SplineStencil<dim-1, order, long>::sum(c_, offsets, basis, 0L);
+}
+
+
+// the order coefficients of an axis are in one or two tiles of that axis
+template< int dim, int order >
+void SplineMapped<dim, order>::recordTiles(const int* firstCoefficient) const {
+  ++noEvaluations_;
+  long firstTile = 0;
+  int noAxesOnTwoTiles = 0;
+  int axisOnTwoTiles[dim];
+  for (int i = 0; i < dim; ++i) {
+    firstTile += (firstCoefficient[i] / order) * layout_.tileStride[i];
+    if ( (firstCoefficient[i] + order-1) / order != firstCoefficient[i] / order )
+      axisOnTwoTiles[noAxesOnTwoTiles++] = i;
+  }
+  for (int mask = 0; mask < (1 << noAxesOnTwoTiles); ++mask) {
+    long tile = firstTile;
+    for (int k = 0; k < noAxesOnTwoTiles; ++k)
+      if (mask & (1 << k))
+        tile += layout_.tileStride[axisOnTwoTiles[k]];
+    ++noTileAccesses_;
+    if (!tileTouched_[tile]) {
+      tileTouched_[tile] = true;
+      ++noTilesTouched_;
+    }
+  }
+}
+
+
+template< int dim, int order >
+void SplineMapped<dim, order>::setTileStatistics(const bool tileStatistics) {
+  tileStatistics_ = tileStatistics;
+  noEvaluations_ = noTileAccesses_ = noTilesTouched_ = 0;
+  tileTouched_.assign(tileStatistics ? layout_.noTiles : 0, false);
+}
+
+
+template< int dim, int order >
+long SplineMapped<dim, order>::getNumberOfPages() const {
+  const long pageSize = SplineMappedFile::getPageSize();
+  return (layout_.size * sizeof(double) + pageSize-1) / pageSize;
+}
+
+
+template< int dim, int order >
+long SplineMapped<dim, order>::getNumberOfResidentPages() const {
+  return file_.getNumberOfResidentPages(SPLINE_MAPPED_HEADER_SIZE, layout_.size * sizeof(double));
+}
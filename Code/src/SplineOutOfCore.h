@@ -0,0 +1,138 @@
+// Copyright (c) 2011, Massimo Sartori and Monica Reggiani
+// All rights reserved.
+
+// Redistribution and use in source and binary forms, with or without 
+// modification, are permitted provided that the following conditions are met:
+// - Redistributions of source code must retain the above copyright notice, 
+//   this list of conditions and the following disclaimer.
+// - Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+
+
+
+#ifndef SplineOutOfCore_h
+#define SplineOutOfCore_h
+
+
+#include <vector>
+#include <string>
+
+#include "Spline.h"
+#include "SplineMappedFile.h"
+
+// Splines whose coefficients do not fit in memory. SplineOutOfCoreFitter
+// writes the coefficients to a file, in the TILED_LAYOUT of Spline, and
+// SplineMapped maps it in memory to evaluate the spline: the kernel pages in
+// only the tiles touched by the evaluated poses.
+
+const int SPLINE_MAPPED_MAX_DIM = 8;
+// the tiles start on a page
+const size_t SPLINE_MAPPED_HEADER_SIZE = 4096;
+const char SPLINE_MAPPED_MAGIC[8] = "BSPLTIL";
+
+struct SplineMappedHeader {
+  char magic[8];
+  int dim;
+  int order;
+  int n[SPLINE_MAPPED_MAX_DIM];
+  double a[SPLINE_MAPPED_MAX_DIM];
+  double b[SPLINE_MAPPED_MAX_DIM];
+};
+
+
+// The offsets of TILED_LAYOUT, as in Spline<dim, order>, but 64 bits wide
+// and computed from the grid alone. The tiles are numbered row-major in the
+// grid of tiles, as they are stored.
+template <int dim, int order>
+struct SplineTiledLayout {
+  int firstOffset[dim];
+  std::vector<long> offset;
+  long tileStride[dim];
+  long noTiles;
+  // elements of the tensor, with the padding of the last tiles
+  long size;
+  
+  void init(const int* n);
+};
+
+
+template <int dim, int order = 4>
+class SplineOutOfCoreFitter {
+  private:
+    std::vector<double> a_;
+    std::vector<double> b_;
+    std::vector<int> n_;
+    int linesPerChunk_;
+    
+    void fitAxis(const int axis, const double* y, double* c) const;
+    
+  public:
+    SplineOutOfCoreFitter(const std::vector<double>& a, const std::vector<double>& b, const std::vector<int>& n);
+    // the lines of an axis are gathered and fitted linesPerChunk at a time:
+    // the file pages in use are about (n+3) per chunk, whatever the size
+    void setLinesPerChunk(const int linesPerChunk) { linesPerChunk_ = linesPerChunk; }
+    // nodesFilename holds the values on the nodes as doubles, the first axis
+    // running fastest as the y of Spline<dim>. The axes are fitted one after
+    // the other through coefficientsFilename.0 and .1, removed at the end.
+    void fit(const std::string& nodesFilename, const std::string& coefficientsFilename) const;
+};
+
+
+template <int dim, int order = 4>
+class SplineMapped {
+  private:
+    SplineMappedFile file_;
+    double a_[dim];
+    double b_[dim];
+    int n_[dim];
+    double h_[dim];
+    SplineTiledLayout<dim, order> layout_;
+    const double* c_;
+    
+    bool tileStatistics_;
+    mutable long noEvaluations_;
+    mutable long noTileAccesses_;
+    mutable long noTilesTouched_;
+    mutable std::vector<bool> tileTouched_;
+    
+    SplineMapped(const SplineMapped&);
+    SplineMapped& operator=(const SplineMapped&);
+    bool checkValues(const std::vector<double>& x) const;
+    double evaluate(const std::vector<double>& x, const int dimDerivative) const;
+    void recordTiles(const int* firstCoefficient) const;
+    
+  public:
+    SplineMapped(const std::string& coefficientsFilename);
+    double getValue(const std::vector<double>& x) const;
+    double getFirstDerivative(const std::vector<double>& x, const int dimDerivative) const;
+    
+    // Tile statistics, off by default: while they are on, a SplineMapped
+    // must be used by one thread only
+    void setTileStatistics(const bool tileStatistics);
+    long getNumberOfTiles() const { return layout_.noTiles; }
+    long getNumberOfEvaluations() const { return noEvaluations_; }
+    // tiles read by the evaluations, up to 2^dim each
+    long getNumberOfTileAccesses() const { return noTileAccesses_; }
+    // different tiles read since the statistics are on
+    long getNumberOfTilesTouched() const { return noTilesTouched_; }
+    // pages of the coefficients, and how many are in memory now
+    long getNumberOfPages() const;
+    long getNumberOfResidentPages() const;
+};
+
+
+
+#endif
@@ -0,0 +1,243 @@
+// Copyright (c) 2011, Massimo Sartori and Monica Reggiani
+// All rights reserved.
+
+// Redistribution and use in source and binary forms, with or without 
+// modification, are permitted provided that the following conditions are met:
+// - Redistributions of source code must retain the above copyright notice, 
+//   this list of conditions and the following disclaimer.
+// - Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+
+
+
+#include <math.h>
+#include <string.h>
+#include <stdlib.h>
+#include <iostream>
+#include <algorithm>
+
+//#define LOG_SPLINE
+
+template< int dim >
+bool SplinePoseCache<dim>::Key::operator==(const Key& other) const {
+  for (int i = 0; i < dim; ++i)
+    if (x[i] != other.x[i])
+      return false;
+  return true;
+}
+
+
+template< int dim >
+size_t SplinePoseCache<dim>::KeyHash::operator()(const Key& key) const {
+  unsigned long long hash = 14695981039346656037ULL;
+  for (int i = 0; i < dim; ++i) {
+    hash ^= static_cast<unsigned long long>(key.x[i]);
+    hash *= 1099511628211ULL;
+    hash ^= hash >> 29;
+  }
+  return static_cast<size_t>(hash);
+}
+
+
+template< int dim >
+SplinePoseCache<dim>::SplinePoseCache(const SplineSet<dim>& splineSet, const int capacity, const double quantum,
+                                      const SplineCacheEviction eviction, const int noShards)
+:splineSet_(splineSet), quantum_(quantum), eviction_(eviction) {
+  if ( (capacity < 1) || (noShards < 1) || (quantum < 0.) ) {
+    std::cout << "A SplinePoseCache needs a positive capacity, a positive number of shards and a quantum not negative\n";
+    exit(EXIT_FAILURE);
+  }
+  // the first shards take the remainder, so that the capacities add up to capacity
+  const int noUsedShards = std::min(noShards, capacity);
+  for (int s = 0; s < noUsedShards; ++s) {
+    shards_.push_back(new Shard);
+    shards_.back()->capacity = capacity / noUsedShards + ( (s < capacity % noUsedShards) ? 1 : 0 );
+    shards_.back()->hits = shards_.back()->misses = shards_.back()->evictions = 0;
+  }
+  
+  // the poses accepted are those inside the grids of all the muscles
+  a_.assign(dim, -HUGE_VAL);
+  b_.assign(dim, HUGE_VAL);
+  for (int i = 0; i < splineSet_.getNumberOfMuscles(); ++i) {
+    const Spline<dim>& spline = splineSet_.getSpline(i);
+    for (int k = 0; k < dim; ++k) {
+      a_[k] = std::max(a_[k], spline.a_[k]);
+      b_[k] = std::min(b_[k], spline.b_[k]);
+    }
+  }
+}
+
+
+template< int dim >
+SplinePoseCache<dim>::~SplinePoseCache() {
+  for (unsigned int s = 0; s < shards_.size(); ++s)
+    delete shards_[s];
+}
+
+
+// the exact key is the bits of the pose, so that -0. and 0. differ but
+// a pose always finds itself
+template< int dim >
+void SplinePoseCache<dim>::computeKey(const std::vector<double>& x, Key& key, std::vector<double>& pose) const {
+  pose.resize(dim);
+  for (int i = 0; i < dim; ++i) {
+    if (quantum_ > 0.) {
+      key.x[i] = static_cast<long long>(floor(x[i] / quantum_ + 0.5));
+      pose[i] = key.x[i] * quantum_;
+    }
+    else {
+      memcpy(&key.x[i], &x[i], sizeof(double));
+      pose[i] = x[i];
+    }
+  }
+}
+
+
+template< int dim >
+void SplinePoseCache<dim>::lookUp(const std::vector<double>& x, std::vector<double>& entry) {
+  // written so that NaN is out too, before it reaches the key
+  for (int k = 0; k < dim; ++k)
+    if ( !( (x[k] >= a_[k]) && (x[k] <= b_[k]) ) ) {
+      std::cout << "Values x are out of boundaries\n";
+      exit(EXIT_FAILURE);
+    }
+  
+  Key key;
+  std::vector<double> pose;
+  computeKey(x, key, pose);
+  Shard& shard = *shards_[KeyHash()(key) % shards_.size()];
+  
+  {
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    typename std::unordered_map<Key, typename std::list< std::pair<Key, std::vector<double> > >::iterator, KeyHash>::iterator
+      found = shard.index.find(key);
+    if (found != shard.index.end()) {
+      ++shard.hits;
+      if (eviction_ == LRU_EVICTION)
+        shard.entries.splice(shard.entries.begin(), shard.entries, found->second);
+      entry = found->second->second;
+      return;
+    }
+    ++shard.misses;
+  }
+  
+  // a pose in the grid, once rounded, may fall out of it by quantum/2 at
+  // most: it is brought back on the border. An exact pose is already in.
+  const int noMuscles = splineSet_.getNumberOfMuscles();
+  entry.resize((dim+1) * noMuscles);
+  std::vector<double> poseInGrid(pose);
+  for (int i = 0; i < noMuscles; ++i) {
+    const Spline<dim>& spline = splineSet_.getSpline(i);
+    if (quantum_ > 0.)
+      for (int k = 0; k < dim; ++k)
+        poseInGrid[k] = std::min(spline.b_[k], std::max(spline.a_[k], pose[k]));
+    entry[i] = spline.getValue(poseInGrid);
+    for (int k = 0; k < dim; ++k)
+      entry[(k+1) * noMuscles + i] = spline.getFirstDerivative(poseInGrid, k);
+  }
+  
+  std::lock_guard<std::mutex> lock(shard.mutex);
+  if (shard.index.find(key) != shard.index.end())
+    return;
+  shard.entries.push_front(std::make_pair(key, entry));
+  shard.index[key] = shard.entries.begin();
+  if (static_cast<int>(shard.entries.size()) > shard.capacity) {
+    shard.index.erase(shard.entries.back().first);
+    shard.entries.pop_back();
+    ++shard.evictions;
+  }
+}
+
+
+template< int dim >
+void SplinePoseCache<dim>::getValues(const std::vector<double>& x, std::vector<double>& values) {
+  std::vector<double> entry;
+  lookUp(x, entry);
+  values.assign(entry.begin(), entry.begin() + splineSet_.getNumberOfMuscles());
+}
+
+
+template< int dim >
+void SplinePoseCache<dim>::getValuesAndFirstDerivatives(const std::vector<double>& x, std::vector<double>& values,
+                                                        std::vector<double>& derivatives) {
+  std::vector<double> entry;
+  lookUp(x, entry);
+  const int noMuscles = splineSet_.getNumberOfMuscles();
+  values.assign(entry.begin(), entry.begin() + noMuscles);
+  derivatives.assign(entry.begin() + noMuscles, entry.end());
+}
+
+
+template< int dim >
+void SplinePoseCache<dim>::clear() {
+  for (unsigned int s = 0; s < shards_.size(); ++s) {
+    std::lock_guard<std::mutex> lock(shards_[s]->mutex);
+    shards_[s]->entries.clear();
+    shards_[s]->index.clear();
+  }
+}
+
+
+template< int dim >
+long SplinePoseCache<dim>::getNumberOfHits() const {
+  long hits = 0;
+  for (unsigned int s = 0; s < shards_.size(); ++s) {
+    std::lock_guard<std::mutex> lock(shards_[s]->mutex);
+    hits += shards_[s]->hits;
+  }
+  return hits;
+}
+
+
+template< int dim >
+long SplinePoseCache<dim>::getNumberOfMisses() const {
+  long misses = 0;
+  for (unsigned int s = 0; s < shards_.size(); ++s) {
+    std::lock_guard<std::mutex> lock(shards_[s]->mutex);
+    misses += shards_[s]->misses;
+  }
+  return misses;
+}
+
+
+template< int dim >
+long SplinePoseCache<dim>::getNumberOfEvictions() const {
+  long evictions = 0;
+  for (unsigned int s = 0; s < shards_.size(); ++s) {
+    std::lock_guard<std::mutex> lock(shards_[s]->mutex);
+    evictions += shards_[s]->evictions;
+  }
+  return evictions;
+}
+
+
+template< int dim >
+long SplinePoseCache<dim>::getSize() const {
+  long size = 0;
+  for (unsigned int s = 0; s < shards_.size(); ++s) {
+    std::lock_guard<std::mutex> lock(shards_[s]->mutex);
+    size += shards_[s]->entries.size();
+  }
+  return size;
+}
+
+
+template< int dim >
+double SplinePoseCache<dim>::getHitRate() const {
+  long hits = getNumberOfHits();
+  long lookUps = hits + getNumberOfMisses();
+  return (lookUps > 0) ? static_cast<double>(hits) / lookUps : 0.;
+}
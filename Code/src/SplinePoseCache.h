@@ -0,0 +1,103 @@
+// Copyright (c) 2011, Massimo Sartori and Monica Reggiani
+// All rights reserved.
+
+// Redistribution and use in source and binary forms, with or without 
+// modification, are permitted provided that the following conditions are met:
+// - Redistributions of source code must retain the above copyright notice, 
+//   this list of conditions and the following disclaimer.
+// - Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+
+
+
+#ifndef SplinePoseCache_h
+#define SplinePoseCache_h
+
+
+#include <vector>
+#include <list>
+#include <unordered_map>
+#include <mutex>
+
+#include "SplineSet.h"
+
+enum SplineCacheEviction {
+  LRU_EVICTION,   // the pose used least recently goes first
+  FIFO_EVICTION   // the pose stored first goes first, a hit does not renew it
+};
+
+// A bounded cache in front of a SplineSet, for the loops that evaluate the
+// same poses again and again. An entry holds the values and the first
+// derivatives of all the muscles in one pose, so a repeated pose costs a
+// hash lookup instead of (dim+1) * noMuscles evaluations.
+// The key is the exact pose or, with a quantum, the pose rounded to
+// multiples of quantum: the values are then those of the rounded pose.
+// As for SplineSet, a pose out of the grid (or not a number) is an error.
+// The entries are spread over shards, each with its own lock, so that
+// concurrent threads seldom wait for each other; the splines are
+// evaluated outside the locks.
+template <int dim>
+class SplinePoseCache {
+  private:
+    struct Key {
+      long long x[dim];
+      bool operator==(const Key& other) const;
+    };
+    struct KeyHash {
+      size_t operator()(const Key& key) const;
+    };
+    struct Shard {
+      std::mutex mutex;
+      // the entries in eviction order, the next to go at the back
+      std::list< std::pair<Key, std::vector<double> > > entries;
+      std::unordered_map<Key, typename std::list< std::pair<Key, std::vector<double> > >::iterator, KeyHash> index;
+      int capacity;
+      long hits, misses, evictions;
+    };
+    
+    const SplineSet<dim>& splineSet_;
+    std::vector<double> a_, b_;
+    double quantum_;
+    SplineCacheEviction eviction_;
+    std::vector<Shard*> shards_;
+    
+    SplinePoseCache(const SplinePoseCache&);
+    SplinePoseCache& operator=(const SplinePoseCache&);
+    void computeKey(const std::vector<double>& x, Key& key, std::vector<double>& pose) const;
+    void lookUp(const std::vector<double>& x, std::vector<double>& entry);
+    
+  public:
+    // capacity is the number of poses kept, in all the shards
+    SplinePoseCache(const SplineSet<dim>& splineSet, const int capacity, const double quantum = 0.,
+                    const SplineCacheEviction eviction = LRU_EVICTION, const int noShards = 16);
+    ~SplinePoseCache();
+    // values[i] of the muscle i, as SplineSet::getValues
+    void getValues(const std::vector<double>& x, std::vector<double>& values);
+    // and derivatives[k * noMuscles + i] = d values[i] / dx[k]
+    void getValuesAndFirstDerivatives(const std::vector<double>& x, std::vector<double>& values,
+                                      std::vector<double>& derivatives);
+    void clear();
+    long getNumberOfHits() const;
+    long getNumberOfMisses() const;
+    long getNumberOfEvictions() const;
+    // the number of poses kept, at most capacity
+    long getSize() const;
+    double getHitRate() const;
+};
+
+
+
+#endif
@@ -0,0 +1,116 @@
+// Copyright (c) 2011, Massimo Sartori and Monica Reggiani
+// All rights reserved.
+
+// Redistribution and use in source and binary forms, with or without 
+// modification, are permitted provided that the following conditions are met:
+// - Redistributions of source code must retain the above copyright notice, 
+//   this list of conditions and the following disclaimer.
+// - Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+
+
+
+#include <stdlib.h>
+#include <iostream>
+
+template< int dim >
+SplineSet<dim>::SplineSet(const std::vector<std::string>& muscleNames, const std::vector< Spline<dim> >& splines)
+:muscleNames_(muscleNames), splines_(splines) {
+  if (muscleNames_.size() != splines_.size()) {
+    std::cout << "We have " << muscleNames_.size() << " muscle names, but " << splines_.size() << " splines\n";
+    exit(EXIT_FAILURE);
+  }
+  checkSharedGrid();
+}
+
+
+template< int dim >
+SplineSet<dim>::SplineSet(const std::vector<double>& a, const std::vector<double>& b, const std::vector<int>& n,
+                          const std::vector<std::string>& muscleNames, const std::vector< std::vector<double> >& y)
+:muscleNames_(muscleNames) {
+  if (muscleNames_.size() != y.size()) {
+    std::cout << "We have " << muscleNames_.size() << " muscle names, but data for " << y.size() << " muscles\n";
+    exit(EXIT_FAILURE);
+  }
+  
+  SplineFitter<dim> fitter(a, b, n);
+  splines_.reserve(y.size());
+  for (unsigned int i = 0; i < y.size(); ++i) {
+    fitter.computeCoefficients(y[i], y[i].begin());
+    splines_.push_back(Spline<dim>(fitter));
+  }
+  checkSharedGrid();
+}
+
+
+template< int dim >
+void SplineSet<dim>::checkSharedGrid() {
+  sharedGrid_ = true;
+  for (unsigned int m = 1; m < splines_.size(); ++m) {
+    sharedGrid_ = sharedGrid_ && (splines_[m].layout_ == splines_[0].layout_);
+    for (int i = 0; i < dim; ++i)
+      sharedGrid_ = sharedGrid_ && (splines_[m].a_[i] == splines_[0].a_[i]) && (splines_[m].b_[i] == splines_[0].b_[i])
+                    && (splines_[m].n_[i] == splines_[0].n_[i]);
+  }
+}
+
+
+template< int dim >
+void SplineSet<dim>::getValues(const std::vector<double>& x, std::vector<double>& values) const {
+  values.resize(splines_.size());
+  for (unsigned int i = 0; i < splines_.size(); ++i)
+    values[i] = splines_[i].getValue(x);
+}
+
+
+template< int dim >
+void SplineSet<dim>::getFirstDerivatives(const std::vector<double>& x, const int dimDerivative, std::vector<double>& derivatives) const {
+  derivatives.resize(splines_.size());
+  for (unsigned int i = 0; i < splines_.size(); ++i)
+    derivatives[i] = splines_[i].getFirstDerivative(x, dimDerivative);
+}
+
+
+template< int dim >
+void SplineSet<dim>::getTrajectory(const double* angles, const double* angularVelocities, const long noFrames,
+                                   double* lengths, double* momentArms, double* lengtheningVelocities) const {
+  const int order = 4;
+  const int noMuscles = splines_.size();
+  double basis[dim][order];
+  double derivative[dim][order];
+  const int* offsets[dim];
+  double sums[dim+1];
+  
+  for (long f = 0; f < noFrames; ++f) {
+    const double* x = angles + f*dim;
+    const double* xDot = angularVelocities + f*dim;
+    for (int m = 0; m < noMuscles; ++m) {
+      const Spline<dim>& spline = splines_[m];
+      if (!sharedGrid_ || (m == 0))
+        spline.computeGradientBasis(x, -1, basis, derivative, offsets);
+      SplineGradientStencil<dim-1, order>::sum(&spline.c_[0], offsets, basis, derivative, 0, sums);
+      
+      const long muscle = f*noMuscles + m;
+      lengths[muscle] = sums[0];
+      double velocity = 0;
+      for (int i = 0; i < dim; ++i) {
+        momentArms[muscle*dim + i] = -sums[1+i];
+        velocity += sums[1+i] * xDot[i];
+      }
+      lengtheningVelocities[muscle] = velocity;
+    }
+  }
+}
@@ -0,0 +1,74 @@
+// Copyright (c) 2011, Massimo Sartori and Monica Reggiani
+// All rights reserved.
+
+// Redistribution and use in source and binary forms, with or without 
+// modification, are permitted provided that the following conditions are met:
+// - Redistributions of source code must retain the above copyright notice, 
+//   this list of conditions and the following disclaimer.
+// - Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+
+
+
+#ifndef SplineSet_h
+#define SplineSet_h
+
+
+#include <vector>
+#include <string>
+
+#include "Spline.h"
+
+// The splines of all the muscles crossing the same DOFs, one per muscle.
+// A SplineSet cannot be changed once built: a new model is a new SplineSet,
+// so it can be shared by concurrent readers (see SnapshotHolder).
+template <int dim>
+class SplineSet {
+  private:
+    std::vector<std::string> muscleNames_;
+    std::vector< Spline<dim> > splines_;
+    // all the splines on the grid and the layout of the first: the basis of
+    // a pose is then the same for all the muscles
+    bool sharedGrid_;
+    
+    void checkSharedGrid();
+    
+  public:
+    SplineSet(const std::vector<std::string>& muscleNames, const std::vector< Spline<dim> >& splines);
+    // y[i] are the values of the i-th muscle on the nodes, as in Spline<dim>
+    SplineSet(const std::vector<double>& a, const std::vector<double>& b, const std::vector<int>& n,
+              const std::vector<std::string>& muscleNames, const std::vector< std::vector<double> >& y);
+    int getNumberOfMuscles() const { return splines_.size(); }
+    const std::string& getMuscleName(const int muscle) const { return muscleNames_[muscle]; }
+    const Spline<dim>& getSpline(const int muscle) const { return splines_[muscle]; }
+    void getValues(const std::vector<double>& x, std::vector<double>& values) const;
+    void getFirstDerivatives(const std::vector<double>& x, const int dimDerivative, std::vector<double>& derivatives) const;
+    // Lengths, moment arms and lengthening velocities of all the muscles on
+    // the noFrames frames of a trajectory, in arrays of the caller:
+    //   angles[f*dim + i], angularVelocities[f*dim + i] the DOFs in frame f
+    //   lengths[f*noMuscles + m]
+    //   momentArms[(f*noMuscles + m)*dim + i] = -dlmt/dq_i
+    //   lengtheningVelocities[f*noMuscles + m] = dlmt/dt, the gradient times the angular velocities
+    // With a shared grid the basis of a frame and its derivatives are computed
+    // once for all the muscles, and each muscle reads its coefficients once
+    // for the value and the gradient (SplineGradientStencil).
+    void getTrajectory(const double* angles, const double* angularVelocities, const long noFrames,
+                       double* lengths, double* momentArms, double* lengtheningVelocities) const;
+};
+
+
+
+#endif
@@ -0,0 +1,99 @@
+// Copyright (c) 2011, Massimo Sartori and Monica Reggiani
+// All rights reserved.
+
+// Redistribution and use in source and binary forms, with or without 
+// modification, are permitted provided that the following conditions are met:
+// - Redistributions of source code must retain the above copyright notice, 
+//   this list of conditions and the following disclaimer.
+// - Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+
+
+#ifndef SplineStencil_h
+#define SplineStencil_h
+
+// Sum of the order^dim terms c[index] * basis[0][j_0] * ... * basis[dim-1][j_dim-1]
+// around a point, with index = firstIndex + offsets[0][j_0] + ... + offsets[dim-1][j_dim-1].
+// offsets[i] points to the positions in c of the order coefficients of axis i
+// touched by the point, so the same kernel works for every coefficient layout.
+// The recursion on the axis is resolved at compile time. Index is long for
+// the coefficient tensors with more than 2^31 elements; Scalar is the type
+// of the basis and of the result, e.g. float or SplineDual.
+template <int axis, int order, typename Index = int, typename Scalar = double>
+struct SplineStencil {
+  static Scalar sum(const double* c, const Index* const* offsets, const Scalar (*basis)[order], const Index firstIndex) {
+    Scalar evaluatedValue = 0;
+    for (int j = 0; j < order; ++j)
+      evaluatedValue += basis[axis][j] * SplineStencil<axis-1, order, Index, Scalar>::sum(c, offsets, basis, firstIndex + offsets[axis][j]);
+    return evaluatedValue;
+  }
+};
+
+template <int order, typename Index, typename Scalar>
+struct SplineStencil<0, order, Index, Scalar> {
+  static Scalar sum(const double* c, const Index* const* offsets, const Scalar (*basis)[order], const Index firstIndex) {
+    const double* cFirst = c + firstIndex;
+    Scalar evaluatedValue = 0;
+    for (int j = 0; j < order; ++j)
+      evaluatedValue += basis[0][j] * cFirst[offsets[0][j]];
+    return evaluatedValue;
+  }
+};
+
+template <typename Index, typename Scalar>
+struct SplineStencil<0, 4, Index, Scalar> {
+  static Scalar sum(const double* c, const Index* const* offsets, const Scalar (*basis)[4], const Index firstIndex) {
+    const double* cFirst = c + firstIndex;
+    return basis[0][0] * cFirst[offsets[0][0]] + basis[0][1] * cFirst[offsets[0][1]]
+         + basis[0][2] * cFirst[offsets[0][2]] + basis[0][3] * cFirst[offsets[0][3]];
+  }
+};
+
+
+// The value and its derivatives along the axes 0..axis in one pass:
+// derivative[i] is the derivative of basis[i], sums[0] gets the value and
+// sums[1+i] the derivative along axis i. Each level weighs the sums of the
+// faster axes once, so the whole gradient costs about twice the value.
+template <int axis, int order, typename Index = int>
+struct SplineGradientStencil {
+  static void sum(const double* c, const Index* const* offsets, const double (*basis)[order], const double (*derivative)[order],
+                  const Index firstIndex, double* sums) {
+    double inner[axis+1];
+    for (int k = 0; k <= axis+1; ++k)
+      sums[k] = 0;
+    for (int j = 0; j < order; ++j) {
+      SplineGradientStencil<axis-1, order, Index>::sum(c, offsets, basis, derivative, firstIndex + offsets[axis][j], inner);
+      for (int k = 0; k <= axis; ++k)
+        sums[k] += basis[axis][j] * inner[k];
+      sums[axis+1] += derivative[axis][j] * inner[0];
+    }
+  }
+};
+
+template <int order, typename Index>
+struct SplineGradientStencil<0, order, Index> {
+  static void sum(const double* c, const Index* const* offsets, const double (*basis)[order], const double (*derivative)[order],
+                  const Index firstIndex, double* sums) {
+    const double* cFirst = c + firstIndex;
+    sums[0] = sums[1] = 0;
+    for (int j = 0; j < order; ++j) {
+      sums[0] += basis[0][j] * cFirst[offsets[0][j]];
+      sums[1] += derivative[0][j] * cFirst[offsets[0][j]];
+    }
+  }
+};
+
+#endif
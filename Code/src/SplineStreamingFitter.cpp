@@ -0,0 +1,138 @@
+// Copyright (c) 2011, Massimo Sartori and Monica Reggiani
+// All rights reserved.
+
+// Redistribution and use in source and binary forms, with or without 
+// modification, are permitted provided that the following conditions are met:
+// - Redistributions of source code must retain the above copyright notice, 
+//   this list of conditions and the following disclaimer.
+// - Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+
+
+
+#include <stdlib.h>
+#include <iostream>
+#include <algorithm>
+
+//#define LOG_SPLINE
+
+template< int dim, int order >
+SplineStreamingFitter<dim, order>::SplineStreamingFitter(const std::vector<double>& a, const std::vector<double>& b,
+                                                         const std::vector<int>& n, const int noValues, const int maxQueuedSlabs)
+:fitter_(a, b, n), noValues_(noValues), maxQueuedSlabs_(maxQueuedSlabs), noNodesInSlab_(0), noSlabsAdded_(0),
+ preCoeffs_(noValues), finished_(false) {
+  if ( (noValues < 1) || (maxQueuedSlabs < 1) ) {
+    std::cout << "A SplineStreamingFitter needs at least one value and one queued slab\n";
+    exit(EXIT_FAILURE);
+  }
+  sizeOfSlab_ = fitter_.getSizeOfSlab();
+  noSlabs_ = n[dim-1] + 1;
+  slab_.resize(noValues_ * sizeOfSlab_);
+  for (int i = 0; i < noValues_; ++i)
+    preCoeffs_[i].reserve(fitter_.getNumberOfPreCoefficients());
+  fittingThread_ = std::thread(&SplineStreamingFitter<dim, order>::fitSlabs, this);
+}
+
+
+template< int dim, int order >
+SplineStreamingFitter<dim, order>::~SplineStreamingFitter() {
+  stopFitting();
+}
+
+
+template< int dim, int order >
+void SplineStreamingFitter<dim, order>::stopFitting() {
+  if (!fittingThread_.joinable())
+    return;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    finished_ = true;
+  }
+  slabQueued_.notify_one();
+  fittingThread_.join();
+}
+
+
+// the fitting thread: the only one using fitter_ until it is joined
+template< int dim, int order >
+void SplineStreamingFitter<dim, order>::fitSlabs() {
+  std::vector<double> slab;
+  while (true) {
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      while (queue_.empty() && !finished_)
+        slabQueued_.wait(lock);
+      if (queue_.empty())
+        return;
+      slab.swap(queue_.front());
+      queue_.pop_front();
+    }
+    slabTaken_.notify_one();
+    for (int i = 0; i < noValues_; ++i)
+      fitter_.computeSlabCoefficients(&slab[i], noValues_, preCoeffs_[i]);
+#ifdef LOG_SPLINE
+    std::cout << "Fitted a slab of " << sizeOfSlab_ << " nodes\n";
+#endif
+  }
+}
+
+
+template< int dim, int order >
+void SplineStreamingFitter<dim, order>::addNode(const std::vector<double>& values) {
+  if (noSlabsAdded_ == noSlabs_) {
+    std::cout << "All the " << getNumberOfNodes() << " nodes were already added\n";
+    exit(EXIT_FAILURE);
+  }
+  if (static_cast<int>(values.size()) < noValues_) {
+    std::cout << "A node needs " << noValues_ << " values, not " << values.size() << std::endl;
+    exit(EXIT_FAILURE);
+  }
+  std::copy(values.begin(), values.begin() + noValues_, slab_.begin() + noNodesInSlab_ * noValues_);
+  if (++noNodesInSlab_ < sizeOfSlab_)
+    return;
+  
+  {
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (static_cast<int>(queue_.size()) >= maxQueuedSlabs_)
+      slabTaken_.wait(lock);
+    queue_.push_back(std::vector<double>());
+    queue_.back().swap(slab_);
+  }
+  slabQueued_.notify_one();
+  slab_.resize(noValues_ * sizeOfSlab_);
+  noNodesInSlab_ = 0;
+  ++noSlabsAdded_;
+}
+
+
+template< int dim, int order >
+void SplineStreamingFitter<dim, order>::getSplines(std::vector< Spline<dim, order> >& splines) {
+  if (noSlabsAdded_ < noSlabs_) {
+    std::cout << "Only " << noSlabsAdded_ * sizeOfSlab_ + noNodesInSlab_ << " of the " << getNumberOfNodes()
+              << " nodes were added\n";
+    exit(EXIT_FAILURE);
+  }
+  stopFitting();
+  
+  // each preCoefficients is dropped as soon as its spline is built
+  splines.clear();
+  splines.reserve(noValues_);
+  for (int i = 0; i < noValues_; ++i) {
+    fitter_.computeLastAxisCoefficients(preCoeffs_[i]);
+    std::vector<double>().swap(preCoeffs_[i]);
+    splines.push_back(Spline<dim, order>(fitter_));
+  }
+}
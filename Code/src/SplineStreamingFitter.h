@@ -0,0 +1,95 @@
+// Copyright (c) 2011, Massimo Sartori and Monica Reggiani
+// All rights reserved.
+
+// Redistribution and use in source and binary forms, with or without 
+// modification, are permitted provided that the following conditions are met:
+// - Redistributions of source code must retain the above copyright notice, 
+//   this list of conditions and the following disclaimer.
+// - Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+
+
+
+#ifndef SplineStreamingFitter_h
+#define SplineStreamingFitter_h
+
+
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+#include "Spline.h"
+
+// Fits the splines of several values (e.g. the lmt of all the muscles)
+// while their nodes are still being read. The nodes come one at a time, in
+// the order of y (the first axis running fastest), with all the values of
+// a node together as in the rows of lmt.in. Each time a slab (the nodes
+// with the same index on the last axis) is complete, it is queued to a
+// fitting thread, which runs the first step of SplineFitter on it for every
+// value while the next slabs are parsed; getSplines then fits the last axis.
+// Memory: each value keeps its preCoefficients, (n_0+3)...(n_dim-2+3) *
+// (n_dim-1+1) doubles, plus a few slabs, until getSplines fits its last axis
+// and frees them. That is more than its y ((n+1)^dim): 17280 against 10000
+// doubles for 4 DOFs and n = 9. It is less than its spline ((n+3)^dim,
+// 20736), so the peak is that of the splines alone once they are built,
+// where reading the whole y first held y and the splines together.
+// At most maxQueuedSlabs slabs wait in the queue: beyond, addNode waits
+// for the fitting thread. dim must be at least 2.
+template <int dim, int order = 4>
+class SplineStreamingFitter {
+  private:
+    SplineFitter<dim, order> fitter_;
+    int noValues_;
+    int sizeOfSlab_;
+    int noSlabs_;
+    int maxQueuedSlabs_;
+    
+    // the slab being filled, as the rows of lmt.in: slab_[node * noValues_ + value];
+    // each value is fitted in place with stride noValues_
+    std::vector<double> slab_;
+    int noNodesInSlab_;
+    int noSlabsAdded_;
+    std::vector< std::vector<double> > preCoeffs_;
+    
+    std::deque< std::vector<double> > queue_;
+    bool finished_;
+    std::mutex mutex_;
+    std::condition_variable slabQueued_;
+    std::condition_variable slabTaken_;
+    std::thread fittingThread_;
+    
+    SplineStreamingFitter(const SplineStreamingFitter&);
+    SplineStreamingFitter& operator=(const SplineStreamingFitter&);
+    void fitSlabs();
+    void stopFitting();
+    
+  public:
+    SplineStreamingFitter(const std::vector<double>& a, const std::vector<double>& b, const std::vector<int>& n,
+                          const int noValues, const int maxQueuedSlabs = 4);
+    ~SplineStreamingFitter();
+    int getNumberOfValues() const { return noValues_; }
+    int getNumberOfNodes() const { return sizeOfSlab_ * noSlabs_; }
+    // values[i] of the value i on the next node, at least getNumberOfValues() of them
+    void addNode(const std::vector<double>& values);
+    // once all the nodes are added: the spline of each value, in order
+    void getSplines(std::vector< Spline<dim, order> >& splines);
+};
+
+
+
+#endif